@@ -76,11 +76,35 @@ type FenceRequest struct {
 	// as per "half up" rounding. This is different from openvds logic.
 	Interpolation string `json:"interpolation" example:"linear"`
 
+	// Restrict the traces to a vertical window (optional)
+	//
+	// The window is a bound along the vertical axis. Valid directions are
+	// Depth/Time/Sample in annotation, and k in index. Both lower and upper
+	// are inclusive. Only the samples within the window are read and
+	// returned, which is much faster than fetching full traces when only a
+	// small time or depth range around e.g. a reservoir is of interest.
+	//
+	// Not specifying a window returns the full traces.
+	SampleWindow *core.Bound `json:"sampleWindow"`
+
 	// Providing a FillValue is optional and will be used for the sample points
 	// that lie outside the seismic cube.
 	// Note: In case the FillValue is not set, and any of the provided coordinates
 	// fall outside the seismic cube, the request will be rejected with an error.
 	FillValue *float32 `json:"fillValue"`
+
+	// Format of the returned samples (optional)
+	// Supported options are:
+	// float32 : 4-byte floats. This is the default.
+	// float16 : 2-byte floats.
+	// int16   : 2-byte integers, scaled to the range of the response.
+	// int8    : 1-byte integers, scaled to the range of the response.
+	//
+	// The smaller formats reduce the size of the response at the cost of
+	// precision, which is typically fine for visualization. For the integer
+	// formats the metadata contains the scale and offset needed to decode the
+	// samples.
+	SampleFormat string `json:"sampleFormat" example:"float32"`
 } //@name FenceRequest
 
 func (f FenceRequest) toString() (string, error) {
@@ -103,8 +127,18 @@ func (f FenceRequest) toString() (string, error) {
 		fillValue = fmt.Sprintf("%.2f", *f.FillValue)
 	}
 
+	sampleWindow := "None"
+	if f.SampleWindow != nil {
+		sampleWindow = fmt.Sprintf("%s: [%d, %d]",
+			*f.SampleWindow.Direction,
+			*f.SampleWindow.Lower,
+			*f.SampleWindow.Upper,
+		)
+	}
+
 	msg := "{%s, coordinate system: %s, coordinates: %s, " +
-		"interpolation (optional): %s, fill value (optional): %s}"
+		"interpolation (optional): %s, sample window (optional): %s, " +
+		"fill value (optional): %s, sample format (optional): %s}"
 
 	return fmt.Sprintf(
 		msg,
@@ -112,7 +146,9 @@ func (f FenceRequest) toString() (string, error) {
 		f.CoordinateSystem,
 		coordinates,
 		f.Interpolation,
+		sampleWindow,
 		fillValue,
+		f.SampleFormat,
 	), nil
 }
 
@@ -155,21 +191,34 @@ func (request FenceRequest) execute(
 		return
 	}
 
-	metadata, err = handle.GetFenceMetadata(request.Coordinates)
+	format, err := core.GetSampleFormat(request.SampleFormat)
 	if err != nil {
 		return
 	}
+	encoding := core.SampleEncoding{Format: format}
 
+	/* The data is fetched first, as the metadata describes its encoding */
 	res, err := handle.GetFence(
 		coordinateSystem,
 		request.Coordinates,
 		interpolation,
+		request.SampleWindow,
 		request.FillValue,
+		&encoding,
 	)
 	if err != nil {
 		return
 	}
 	data = [][]byte{res}
 
+	metadata, err = handle.GetFenceMetadata(
+		request.Coordinates,
+		request.SampleWindow,
+		&encoding,
+	)
+	if err != nil {
+		return
+	}
+
 	return data, metadata, nil
 }
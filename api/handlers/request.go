@@ -64,6 +64,7 @@ type RequestedResource struct {
 	// If two pairs are provided the binary_operator-key defines how the two data sets are combined into a new virtual data set.
 	// Provided VDS A, VDS B and the binary_operator-key "subtraction" the request returns data from data set (A - B) in the intersection (A ∩ B).
 	// Valid options are: "addition", "subtraction", "multiplication", "division" and empty string ("").
+	// For "division", samples where B is zero are NaN.
 	//
 	// Note that there are some restrictions when applying a binary operation on two cubes.
 	// The axes must be in the same order and have matching stepsize and units.
@@ -95,6 +95,36 @@ type SliceRequest struct {
 	// Bounds can be set using both annotation and index. You are free to mix
 	// and match as you see fit.
 	Bounds []core.Bound `json:"bounds" binding:"dive"`
+
+	// Level of detail to read the slice at (optional)
+	//
+	// Level n returns every 2^n-th sample in each dimension of the slice,
+	// read from the pre-computed decimated copies stored in the VDS. This is
+	// a cheap way of getting a preview of large slices. The metadata
+	// describes the decimated grid. Defaults to 0, full resolution.
+	//
+	// Requesting a level the VDS does not contain is an error.
+	Lod *int `json:"lod,omitempty" example:"0"`
+
+	// Pick the level of detail automatically (optional)
+	//
+	// Selects the coarsest level of detail where the longest side of the
+	// slice still has at least lodTargetSize samples. Mutually exclusive
+	// with lod.
+	LodTargetSize *int `json:"lodTargetSize,omitempty" example:"512"`
+
+	// Format of the returned samples (optional)
+	// Supported options are:
+	// float32 : 4-byte floats. This is the default.
+	// float16 : 2-byte floats.
+	// int16   : 2-byte integers, scaled to the range of the response.
+	// int8    : 1-byte integers, scaled to the range of the response.
+	//
+	// The smaller formats reduce the size of the response at the cost of
+	// precision, which is typically fine for visualization. For the integer
+	// formats the metadata contains the scale and offset needed to decode the
+	// samples.
+	SampleFormat string `json:"sampleFormat" example:"float32"`
 } //@name SliceRequest
 
 /** Compute a hash of the request that uniquely identifies the requested slice
@@ -119,11 +149,52 @@ func (s SliceRequest) toString() (string, error) {
 		return strings.Join(allBounds, ", ")
 	}()
 
-	return fmt.Sprintf("{%s, direction: %s, lineno: %d, bounds: %s}",
+	lod := func() string {
+		if s.Lod != nil {
+			return fmt.Sprintf(", lod: %d", *s.Lod)
+		}
+		if s.LodTargetSize != nil {
+			return fmt.Sprintf(", lodTargetSize: %d", *s.LodTargetSize)
+		}
+		return ""
+	}()
+
+	return fmt.Sprintf("{%s, direction: %s, lineno: %d, bounds: %s%s, "+
+		"sample format (optional): %s}",
 		s.RequestedResource.toString(),
 		s.Direction,
 		*s.Lineno,
-		bounds), nil
+		bounds,
+		lod,
+		s.SampleFormat), nil
+}
+
+func (s SliceRequest) levelOfDetail() (core.LevelOfDetail, error) {
+	if s.Lod != nil && s.LodTargetSize != nil {
+		return core.LevelOfDetail{}, core.NewInvalidArgument(
+			"lod and lodTargetSize are mutually exclusive",
+		)
+	}
+
+	if s.Lod != nil {
+		if *s.Lod < 0 {
+			return core.LevelOfDetail{}, core.NewInvalidArgument(fmt.Sprintf(
+				"Invalid level of detail: %d, must be non-negative", *s.Lod,
+			))
+		}
+		return core.LevelOfDetail{Level: *s.Lod}, nil
+	}
+
+	if s.LodTargetSize != nil {
+		if *s.LodTargetSize <= 0 {
+			return core.LevelOfDetail{}, core.NewInvalidArgument(fmt.Sprintf(
+				"Invalid lodTargetSize: %d, must be positive", *s.LodTargetSize,
+			))
+		}
+		return core.LevelOfDetail{Level: -1, TargetSize: *s.LodTargetSize}, nil
+	}
+
+	return core.LevelOfDetail{}, nil
 }
 
 func (request SliceRequest) execute(
@@ -134,20 +205,40 @@ func (request SliceRequest) execute(
 		return
 	}
 
-	metadata, err = handle.GetSliceMetadata(
+	lod, err := request.levelOfDetail()
+	if err != nil {
+		return
+	}
+
+	format, err := core.GetSampleFormat(request.SampleFormat)
+	if err != nil {
+		return
+	}
+	encoding := core.SampleEncoding{Format: format}
+
+	/* The data is fetched first, as the metadata describes its encoding */
+	res, err := handle.GetSlice(
 		*request.Lineno,
 		axis,
 		request.Bounds,
+		lod,
+		&encoding,
 	)
 	if err != nil {
 		return
 	}
+	data = [][]byte{res}
 
-	res, err := handle.GetSlice(*request.Lineno, axis, request.Bounds)
+	metadata, err = handle.GetSliceMetadata(
+		*request.Lineno,
+		axis,
+		request.Bounds,
+		lod,
+		&encoding,
+	)
 	if err != nil {
 		return
 	}
-	data = [][]byte{res}
 
 	return data, metadata, nil
 }
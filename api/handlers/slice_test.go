@@ -155,6 +155,19 @@ func TestSliceGivesUniqueHash(t *testing.T) {
 				[]string{"vds", "vds1"},
 				[]string{"sas", "sas"}, "subtraction", "inline", 10),
 		},
+		{
+			name: "Sample format differ",
+			request1: newSliceRequest(
+				[]string{"vds"},
+				[]string{"sas"}, "", "inline", 10),
+			request2: func() SliceRequest {
+				request := newSliceRequest(
+					[]string{"vds"},
+					[]string{"sas"}, "", "inline", 10)
+				request.SampleFormat = "int8"
+				return request
+			}(),
+		},
 	}
 
 	for _, testCase := range testCases {
@@ -5,6 +5,7 @@ import (
 	"os"
 	"strconv"
 	"strings"
+	"time"
 
 	"github.com/gin-contrib/gzip"
 	"github.com/gin-gonic/gin"
@@ -24,6 +25,15 @@ type opts struct {
 	storageAccounts   string
 	port              uint32
 	cacheSize         uint64
+	handlePoolSize    uint64
+	handlePoolTTL     uint32
+	subcubeRequests   uint64
+	chunkCacheSize    uint64
+	fenceSortPoints   uint64
+	fenceEpsilon      float64
+	traceReads        bool
+	attributeMemory   uint64
+	attributePrefetch uint64
 	metrics           bool
 	metricsPort       uint32
 	trustedProxies    []string
@@ -55,6 +65,18 @@ func parseAsUint64(fallback uint64, value string) uint64 {
 	return out
 }
 
+func parseAsFloat64(fallback float64, value string) float64 {
+	if len(value) == 0 {
+		return fallback
+	}
+	out, err := strconv.ParseFloat(value, 64)
+	if err != nil {
+		panic(err)
+	}
+
+	return out
+}
+
 func parseAsString(fallback string, value string) string {
 	if len(value) == 0 {
 		return fallback
@@ -91,6 +113,15 @@ func parseopts() opts {
 		storageAccounts:   parseAsString("", os.Getenv("ONESEISMIC_API_STORAGE_ACCOUNTS")),
 		port:              parseAsUint32(8080, os.Getenv("ONESEISMIC_API_PORT")),
 		cacheSize:         parseAsUint64(0, os.Getenv("ONESEISMIC_API_CACHE_SIZE")),
+		handlePoolSize:    parseAsUint64(0, os.Getenv("ONESEISMIC_API_HANDLE_POOL_SIZE")),
+		handlePoolTTL:     parseAsUint32(300, os.Getenv("ONESEISMIC_API_HANDLE_POOL_TTL")),
+		subcubeRequests:   parseAsUint64(4, os.Getenv("ONESEISMIC_API_SUBCUBE_REQUESTS")),
+		chunkCacheSize:    parseAsUint64(0, os.Getenv("ONESEISMIC_API_CHUNK_CACHE_SIZE")),
+		fenceSortPoints:   parseAsUint64(1024, os.Getenv("ONESEISMIC_API_FENCE_SORT_POINTS")),
+		fenceEpsilon:      parseAsFloat64(0, os.Getenv("ONESEISMIC_API_FENCE_EPSILON")),
+		traceReads:        parseAsBool(false, os.Getenv("ONESEISMIC_API_SUBVOLUME_TRACE_READS")),
+		attributeMemory:   parseAsUint64(0, os.Getenv("ONESEISMIC_API_ATTRIBUTE_MEMORY")),
+		attributePrefetch: parseAsUint64(1, os.Getenv("ONESEISMIC_API_ATTRIBUTE_PREFETCH")),
 		metrics:           parseAsBool(false, os.Getenv("ONESEISMIC_API_METRICS")),
 		metricsPort:       parseAsUint32(8081, os.Getenv("ONESEISMIC_API_METRICS_PORT")),
 		trustedProxies:    parseAsListOfStrings(nil, os.Getenv("ONESEISMIC_API_TRUSTED_PROXIES")),
@@ -127,6 +158,112 @@ func parseopts() opts {
 		"int",
 	)
 
+	getopt.FlagLong(
+		&opts.handlePoolSize,
+		"handle-pool-size",
+		0,
+		"Max number of opened VDS handles kept between requests. Reusing an opened\n"+
+			"handle saves the time spent on opening the VDS and reading its layout.\n"+
+			"A value of zero disables the pool. Defaults to 0.\n"+
+			"Can also be set by environment variable 'ONESEISMIC_API_HANDLE_POOL_SIZE'",
+		"int",
+	)
+
+	getopt.FlagLong(
+		&opts.handlePoolTTL,
+		"handle-pool-ttl",
+		0,
+		"Number of seconds an unused VDS handle is kept in the handle pool.\n"+
+			"Defaults to 300.\n"+
+			"Ignored if the handle pool is disabled. (see --handle-pool-size)\n"+
+			"Can also be set by environment variable 'ONESEISMIC_API_HANDLE_POOL_TTL'",
+		"int",
+	)
+
+	getopt.FlagLong(
+		&opts.subcubeRequests,
+		"subcube-requests",
+		0,
+		"Max number of concurrent requests a single slice is split into.\n"+
+			"Slices spanning several bricks are split along brick boundaries and\n"+
+			"the parts are fetched concurrently. A value of 1 disables splitting.\n"+
+			"Defaults to 4.\n"+
+			"Can also be set by environment variable 'ONESEISMIC_API_SUBCUBE_REQUESTS'",
+		"int",
+	)
+
+	getopt.FlagLong(
+		&opts.chunkCacheSize,
+		"chunk-cache-size",
+		0,
+		"Max size of the cache of decoded chunks (bricks). In megabytes.\n"+
+			"Slices that overlap earlier slices, e.g. neighbouring inlines, reuse\n"+
+			"cached chunks rather than fetching and decoding them again.\n"+
+			"A value of zero disables the cache. Defaults to 0.\n"+
+			"Can also be set by environment variable 'ONESEISMIC_API_CHUNK_CACHE_SIZE'",
+		"int",
+	)
+
+	getopt.FlagLong(
+		&opts.fenceSortPoints,
+		"fence-sort-points",
+		0,
+		"Min number of points for a fence to be read in locality order.\n"+
+			"Traces of large fences are read brick by brick rather than in the\n"+
+			"order of the points, which avoids fetching the same bricks repeatedly.\n"+
+			"A value of zero disables sorting. Defaults to 1024.\n"+
+			"Can also be set by environment variable 'ONESEISMIC_API_FENCE_SORT_POINTS'",
+		"int",
+	)
+
+	getopt.FlagLong(
+		&opts.fenceEpsilon,
+		"fence-epsilon",
+		0,
+		"Distance, in voxels, within which fence points share a trace when\n"+
+			"interpolating. Points that share a trace only read it once. Nearest\n"+
+			"interpolation always shares traces between points in the same voxel.\n"+
+			"Defaults to 0, which only shares traces between identical points.\n"+
+			"Can also be set by environment variable 'ONESEISMIC_API_FENCE_EPSILON'",
+		"float",
+	)
+
+	getopt.FlagLong(
+		&opts.traceReads,
+		"subvolume-trace-reads",
+		0,
+		"Read the samples along surfaces, e.g. for attributes, as windows of\n"+
+			"whole traces rather than sample by sample. Pays off when the windows\n"+
+			"cover a good part of the traces. Off by default.\n"+
+			"Can also be set by environment variable 'ONESEISMIC_API_SUBVOLUME_TRACE_READS'",
+	)
+
+	getopt.FlagLong(
+		&opts.attributeMemory,
+		"attribute-memory",
+		0,
+		"Max memory held by attribute calculations at once, counting the\n"+
+			"seismic data and the buffers it is fetched through.\n"+
+			"In megabytes. Shared by all concurrent requests. Attributes are\n"+
+			"computed tile by tile within this budget, and requests wait for\n"+
+			"memory to be released when it is used up.\n"+
+			"A value of zero is unlimited. Defaults to 0.\n"+
+			"Can also be set by environment variable 'ONESEISMIC_API_ATTRIBUTE_MEMORY'",
+		"int",
+	)
+
+	getopt.FlagLong(
+		&opts.attributePrefetch,
+		"attribute-prefetch",
+		0,
+		"Number of attribute tiles fetched ahead while the current tile is\n"+
+			"computed, so that fetching and computing overlap. Prefetched tiles\n"+
+			"count towards the attribute memory budget.\n"+
+			"A value of zero disables prefetching. Defaults to 1.\n"+
+			"Can also be set by environment variable 'ONESEISMIC_API_ATTRIBUTE_PREFETCH'",
+		"int",
+	)
+
 	getopt.FlagLong(
 		&opts.metrics,
 		"metrics",
@@ -234,6 +371,49 @@ func main() {
 
 	storageAccounts := strings.Split(opts.storageAccounts, ",")
 
+	err := core.ConfigureHandlePool(
+		opts.handlePoolSize,
+		time.Duration(opts.handlePoolTTL)*time.Second,
+	)
+	if err != nil {
+		panic(err)
+	}
+
+	err = core.ConfigureSubcubeRequests(opts.subcubeRequests)
+	if err != nil {
+		panic(err)
+	}
+
+	err = core.ConfigureChunkCache(opts.chunkCacheSize * 1024 * 1024)
+	if err != nil {
+		panic(err)
+	}
+
+	err = core.ConfigureFenceSorting(opts.fenceSortPoints)
+	if err != nil {
+		panic(err)
+	}
+
+	err = core.ConfigureFenceDeduplication(float32(opts.fenceEpsilon))
+	if err != nil {
+		panic(err)
+	}
+
+	err = core.ConfigureSubvolumeTraceReads(opts.traceReads)
+	if err != nil {
+		panic(err)
+	}
+
+	err = core.ConfigureAttributeMemory(opts.attributeMemory * 1024 * 1024)
+	if err != nil {
+		panic(err)
+	}
+
+	err = core.ConfigureAttributePrefetch(opts.attributePrefetch)
+	if err != nil {
+		panic(err)
+	}
+
 	endpoint := handlers.Endpoint{
 		MakeVdsConnection: core.MakeAzureConnection(storageAccounts),
 		Cache:             cache.NewCache(opts.cacheSize),
@@ -241,7 +421,7 @@ func main() {
 
 	app := gin.New()
 
-	err := app.SetTrustedProxies(opts.trustedProxies)
+	err = app.SetTrustedProxies(opts.trustedProxies)
 
 	if err != nil {
 		panic(err)
@@ -250,6 +430,11 @@ func main() {
 	var metric *metrics.Metrics
 	if opts.metrics {
 		metric = metrics.NewMetrics()
+		metric.RegisterChunkCache(func() metrics.ChunkCacheStatistics {
+			/* Can only fail on invalid arguments, report zeros if it does */
+			statistics, _ := core.GetChunkCacheStatistics()
+			return metrics.ChunkCacheStatistics(statistics)
+		})
 		/*
 		 * Host the /metrics endpoint on a different app instance. This is needed
 		 * in order to serve it on a different port, while also giving some benefits
@@ -1,142 +1,588 @@
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstring>
-#include <functional>
-#include <numeric>
-#include <memory>
 #include <stdexcept>
 #include <vector>
 
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define ONESEISMIC_API_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
 #include "attribute.hpp"
+#include "binaryoperator.hpp"
 #include "regularsurface.hpp"
 
-float Value::compute(
-    ResampledSegment const & segment
-) noexcept (false) {
-    auto ptr = segment.begin();
-    std::advance(ptr, segment.reference_index());
-    return *ptr;
+namespace {
+
+using Moments = AttributeReducer::Moments;
+using Extrema = AttributeReducer::Extrema;
+
+/*
+ * The kernels work on blocks of 8 samples. Every lane accumulates one sample
+ * of every block, and the lanes are combined in a fixed order once all the
+ * blocks are done. The samples after the last whole block are then added one
+ * by one. The vectorized kernels have 1 (avx512), 2 (avx2) or 4 (sse2)
+ * registers per statistic for the 8 lanes, and so all instruction sets add
+ * the exact same numbers in the exact same order.
+ *
+ * The attributes must not depend on which instruction set the server happens
+ * to run on, as the same request may be served by different machines and
+ * responses are cached. This also relies on multiplications and additions
+ * not being fused, which is why this file is built with -ffp-contract=off
+ * (see CMakeLists.txt and the cgo flags in core.go).
+ */
+constexpr std::size_t lanes = 8;
+
+/*
+ * Combining the lanes costs about as much as a few blocks of samples, so
+ * shorter segments are reduced one sample at a time instead. The threshold is
+ * the same for all instruction sets, for the same results.
+ */
+constexpr std::size_t min_blocks = 8;
+
+enum Statistic {
+    SUM,
+    SUM_ABS,
+    SUM_SQ,
+    SUM_POS,
+    SUM_NEG,
+    N_POS,
+    N_NEG,
+    SHIFTED_SUM,
+    SHIFTED_SUM_SQ,
+    NSTATISTICS
+};
+
+using MomentLanes = double[NSTATISTICS][lanes];
+
+void accumulate(double* acc, double x, double shift) noexcept (true) {
+    double const shifted = x - shift;
+    acc[SUM]            += x;
+    acc[SUM_ABS]        += std::abs(x);
+    acc[SUM_SQ]         += x * x;
+    acc[SUM_POS]        += x > 0 ? x : 0.0;
+    acc[SUM_NEG]        += x < 0 ? x : 0.0;
+    acc[N_POS]          += x > 0 ? 1.0 : 0.0;
+    acc[N_NEG]          += x < 0 ? 1.0 : 0.0;
+    acc[SHIFTED_SUM]    += shifted;
+    acc[SHIFTED_SUM_SQ] += shifted * shifted;
 }
 
-float Min::compute(
-    ResampledSegment const & segment
-) noexcept (false) {
-    return *std::min_element(segment.begin(), segment.end());
+double combine(double const (&lane)[lanes]) noexcept (true) {
+    return ((lane[0] + lane[4]) + (lane[2] + lane[6]))
+         + ((lane[1] + lane[5]) + (lane[3] + lane[7]));
 }
 
-float MinAt::compute(
-    ResampledSegment const & segment) noexcept(false) {
-    auto min_index = std::distance(
-            segment.begin(),
-            std::min_element(segment.begin(), segment.end())
-        );
-    return segment.sample_position_at(min_index);
+Moments to_moments(double const (&acc)[NSTATISTICS], double shift) noexcept (true) {
+    return Moments {
+        acc[SUM],
+        acc[SUM_ABS],
+        acc[SUM_SQ],
+        acc[SUM_POS],
+        acc[SUM_NEG],
+        static_cast< std::size_t >(acc[N_POS]),
+        static_cast< std::size_t >(acc[N_NEG]),
+        shift,
+        acc[SHIFTED_SUM],
+        acc[SHIFTED_SUM_SQ]
+    };
 }
 
-float Max::compute(
-    ResampledSegment const & segment
-) noexcept (false) {
-    return *std::max_element(segment.begin(), segment.end());
+void scalar_moments(
+    double const* data,
+    std::size_t   nblocks,
+    double        shift,
+    MomentLanes&  l
+) noexcept (true) {
+    MomentLanes acc = {};
+    for (std::size_t b = 0; b < nblocks; ++b) {
+        for (std::size_t j = 0; j < lanes; ++j) {
+            double const x = data[b * lanes + j];
+            double const shifted = x - shift;
+            acc[SUM][j]            += x;
+            acc[SUM_ABS][j]        += std::abs(x);
+            acc[SUM_SQ][j]         += x * x;
+            acc[SUM_POS][j]        += x > 0 ? x : 0.0;
+            acc[SUM_NEG][j]        += x < 0 ? x : 0.0;
+            acc[N_POS][j]          += x > 0 ? 1.0 : 0.0;
+            acc[N_NEG][j]          += x < 0 ? 1.0 : 0.0;
+            acc[SHIFTED_SUM][j]    += shifted;
+            acc[SHIFTED_SUM_SQ][j] += shifted * shifted;
+        }
+    }
+    std::memcpy(l, acc, sizeof(acc));
 }
 
-float MaxAt::compute(
-    ResampledSegment const & segment
-) noexcept (false) {
-    auto max_index = std::distance(
-        segment.begin(),
-        std::max_element(segment.begin(), segment.end())
-    );
-    return segment.sample_position_at(max_index);
+/*
+ * Per-lane extrema, with the sample indices stored as doubles so that they
+ * can be selected with the same masks as the samples
+ */
+struct ExtremaLanes {
+    double min[lanes];
+    double min_index[lanes];
+    double max[lanes];
+    double max_index[lanes];
+    double maxabs[lanes];
+    double maxabs_index[lanes];
+};
+
+/* Continue the search for the first extrema e from sample first to n */
+Extrema sequential_extrema(
+    double const* data,
+    std::size_t   first,
+    std::size_t   n,
+    Extrema       e
+) noexcept (true) {
+    double min    = data[e.min_index];
+    double max    = data[e.max_index];
+    double maxabs = std::abs(data[e.maxabs_index]);
+    for (std::size_t i = first; i < n; ++i) {
+        double const x = data[i];
+        if (x < min) {
+            min = x;
+            e.min_index = i;
+        }
+        if (x > max) {
+            max = x;
+            e.max_index = i;
+        }
+        if (std::abs(x) > maxabs) {
+            maxabs = std::abs(x);
+            e.maxabs_index = i;
+        }
+    }
+    return e;
 }
 
-namespace {
+/*
+ * The first of the lane extrema, i.e. the smallest index among the lanes with
+ * the extreme value, followed by the samples in the tail one by one
+ */
+Extrema finish_extrema(
+    ExtremaLanes const& l,
+    double const*       data,
+    std::size_t         first_tail,
+    std::size_t         n
+) noexcept (true) {
+    std::size_t min = 0;
+    std::size_t max = 0;
+    std::size_t maxabs = 0;
+    for (std::size_t j = 1; j < lanes; ++j) {
+        if (l.min[j] < l.min[min] or
+           (l.min[j] == l.min[min] and l.min_index[j] < l.min_index[min])) {
+            min = j;
+        }
+        if (l.max[j] > l.max[max] or
+           (l.max[j] == l.max[max] and l.max_index[j] < l.max_index[max])) {
+            max = j;
+        }
+        if (l.maxabs[j] > l.maxabs[maxabs] or
+           (l.maxabs[j] == l.maxabs[maxabs] and l.maxabs_index[j] < l.maxabs_index[maxabs])) {
+            maxabs = j;
+        }
+    }
+
+    Extrema const e {
+        static_cast< std::size_t >(l.min_index[min]),
+        static_cast< std::size_t >(l.max_index[max]),
+        static_cast< std::size_t >(l.maxabs_index[maxabs])
+    };
+    return sequential_extrema(data, first_tail, n, e);
+}
 
-double max_abs(
-    ResampledSegment const & segment
-){
-    auto max = *std::max_element(segment.begin(), segment.end(),
-    [](const double& a, const double& b) { 
-            return std::abs(a) < std::abs(b); 
+void scalar_extrema(
+    double const* data,
+    std::size_t   nblocks,
+    ExtremaLanes& l
+) noexcept (true) {
+    for (std::size_t j = 0; j < lanes; ++j) {
+        l.min[j] = l.max[j] = data[j];
+        l.maxabs[j] = std::abs(data[j]);
+        l.min_index[j] = l.max_index[j] = l.maxabs_index[j] = j;
+    }
+    for (std::size_t b = 1; b < nblocks; ++b) {
+        for (std::size_t j = 0; j < lanes; ++j) {
+            std::size_t const i = b * lanes + j;
+            double const x = data[i];
+            if (x < l.min[j]) {
+                l.min[j] = x;
+                l.min_index[j] = i;
+            }
+            if (x > l.max[j]) {
+                l.max[j] = x;
+                l.max_index[j] = i;
+            }
+            if (std::abs(x) > l.maxabs[j]) {
+                l.maxabs[j] = std::abs(x);
+                l.maxabs_index[j] = i;
+            }
         }
-    );
-    return std::abs(max);
+    }
 }
 
-} // namespace
+#ifdef ONESEISMIC_API_X86_KERNELS
 
-float MaxAbs::compute(
-    ResampledSegment const & segment
-) noexcept (false) {
-    return max_abs(segment);
+__attribute__((target("sse2")))
+void sse2_accumulate(__m128d x, __m128d shift, __m128d* acc) noexcept (true) {
+    __m128d const zero = _mm_setzero_pd();
+    __m128d const one  = _mm_set1_pd(1.0);
+    __m128d const abs  = _mm_andnot_pd(_mm_set1_pd(-0.0), x);
+    __m128d const shifted = _mm_sub_pd(x, shift);
+
+    acc[SUM]            = _mm_add_pd(acc[SUM], x);
+    acc[SUM_ABS]        = _mm_add_pd(acc[SUM_ABS], abs);
+    acc[SUM_SQ]         = _mm_add_pd(acc[SUM_SQ], _mm_mul_pd(x, x));
+    acc[SUM_POS]        = _mm_add_pd(acc[SUM_POS], _mm_max_pd(x, zero));
+    acc[SUM_NEG]        = _mm_add_pd(acc[SUM_NEG], _mm_min_pd(x, zero));
+    acc[N_POS]          = _mm_add_pd(acc[N_POS], _mm_and_pd(_mm_cmpgt_pd(x, zero), one));
+    acc[N_NEG]          = _mm_add_pd(acc[N_NEG], _mm_and_pd(_mm_cmplt_pd(x, zero), one));
+    acc[SHIFTED_SUM]    = _mm_add_pd(acc[SHIFTED_SUM], shifted);
+    acc[SHIFTED_SUM_SQ] = _mm_add_pd(acc[SHIFTED_SUM_SQ], _mm_mul_pd(shifted, shifted));
 }
 
-float MaxAbsAt::compute(
-    ResampledSegment const & segment
-) noexcept (false) {
+__attribute__((target("sse2")))
+void sse2_moments(
+    double const* data,
+    std::size_t   nblocks,
+    double        shift,
+    MomentLanes&  l
+) noexcept (true) {
+    __m128d const vshift = _mm_set1_pd(shift);
+    __m128d acc[4][NSTATISTICS];
+    for (int g = 0; g < 4; ++g) {
+        for (int s = 0; s < NSTATISTICS; ++s) acc[g][s] = _mm_setzero_pd();
+    }
 
-    auto max_abs_val = max_abs(segment);
-    auto max_abs_index = std::distance(
-        segment.begin(),
-        std::find_if(segment.begin(), segment.end(),
-        [&](const double& val) {
-                return std::abs(val) == max_abs_val;
-            }
-        )
-    );
+    for (std::size_t b = 0; b < nblocks; ++b) {
+        double const* block = data + b * lanes;
+        for (int g = 0; g < 4; ++g) {
+            sse2_accumulate(_mm_loadu_pd(block + 2 * g), vshift, acc[g]);
+        }
+    }
 
-    return segment.sample_position_at(max_abs_index);
+    for (int g = 0; g < 4; ++g) {
+        for (int s = 0; s < NSTATISTICS; ++s) _mm_storeu_pd(&l[s][2 * g], acc[g][s]);
+    }
 }
 
-float Mean::compute(
-    ResampledSegment const & segment
-) noexcept (false) {
-    double sum = std::accumulate(segment.begin(), segment.end(), 0.0);
-    return sum / segment.size();
+/* sse2 has no blend, so select with and/andnot/or */
+__attribute__((target("sse2")))
+__m128d sse2_select(__m128d mask, __m128d a, __m128d b) noexcept (true) {
+    return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
 }
 
-float MeanAbs::compute(
-    ResampledSegment const & segment
-) noexcept (false) {
-    double sum = std::accumulate(segment.begin(), segment.end(), 0.0,
-        [](double acc, double x) { return acc + std::abs(x); });
-    return sum / segment.size();
+__attribute__((target("sse2")))
+void sse2_extrema(
+    double const* data,
+    std::size_t   nblocks,
+    ExtremaLanes& l
+) noexcept (true) {
+    __m128d const signbit = _mm_set1_pd(-0.0);
+    __m128d const step    = _mm_set1_pd(lanes);
+
+    __m128d min[4], min_index[4], max[4], max_index[4], maxabs[4], maxabs_index[4];
+    __m128d index[4];
+    for (int g = 0; g < 4; ++g) {
+        __m128d const x = _mm_loadu_pd(data + 2 * g);
+        index[g] = _mm_set_pd(2 * g + 1, 2 * g);
+        min[g] = max[g] = x;
+        maxabs[g] = _mm_andnot_pd(signbit, x);
+        min_index[g] = max_index[g] = maxabs_index[g] = index[g];
+    }
+
+    for (std::size_t b = 1; b < nblocks; ++b) {
+        double const* block = data + b * lanes;
+        for (int g = 0; g < 4; ++g) {
+            __m128d const x   = _mm_loadu_pd(block + 2 * g);
+            __m128d const abs = _mm_andnot_pd(signbit, x);
+            index[g] = _mm_add_pd(index[g], step);
+
+            __m128d const lt = _mm_cmplt_pd(x, min[g]);
+            min[g]       = sse2_select(lt, x, min[g]);
+            min_index[g] = sse2_select(lt, index[g], min_index[g]);
+
+            __m128d const gt = _mm_cmpgt_pd(x, max[g]);
+            max[g]       = sse2_select(gt, x, max[g]);
+            max_index[g] = sse2_select(gt, index[g], max_index[g]);
+
+            __m128d const gtabs = _mm_cmpgt_pd(abs, maxabs[g]);
+            maxabs[g]       = sse2_select(gtabs, abs, maxabs[g]);
+            maxabs_index[g] = sse2_select(gtabs, index[g], maxabs_index[g]);
+        }
+    }
+
+    for (int g = 0; g < 4; ++g) {
+        _mm_storeu_pd(l.min          + 2 * g, min[g]);
+        _mm_storeu_pd(l.min_index    + 2 * g, min_index[g]);
+        _mm_storeu_pd(l.max          + 2 * g, max[g]);
+        _mm_storeu_pd(l.max_index    + 2 * g, max_index[g]);
+        _mm_storeu_pd(l.maxabs       + 2 * g, maxabs[g]);
+        _mm_storeu_pd(l.maxabs_index + 2 * g, maxabs_index[g]);
+    }
 }
 
-float MeanPos::compute(
-    ResampledSegment const & segment
-) noexcept (false) {
-    int count = 0;
-    double sum = std::accumulate(segment.begin(), segment.end(), 0.0,
-        [&](double acc, double x) {
-            if (x > 0) {
-                count ++;
-                return acc + x;
-            }
-            return acc;
+__attribute__((target("avx2")))
+void avx2_accumulate(__m256d x, __m256d shift, __m256d* acc) noexcept (true) {
+    __m256d const zero = _mm256_setzero_pd();
+    __m256d const one  = _mm256_set1_pd(1.0);
+    __m256d const abs  = _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+    __m256d const shifted = _mm256_sub_pd(x, shift);
+
+    acc[SUM]            = _mm256_add_pd(acc[SUM], x);
+    acc[SUM_ABS]        = _mm256_add_pd(acc[SUM_ABS], abs);
+    acc[SUM_SQ]         = _mm256_add_pd(acc[SUM_SQ], _mm256_mul_pd(x, x));
+    acc[SUM_POS]        = _mm256_add_pd(acc[SUM_POS], _mm256_max_pd(x, zero));
+    acc[SUM_NEG]        = _mm256_add_pd(acc[SUM_NEG], _mm256_min_pd(x, zero));
+    acc[N_POS]          = _mm256_add_pd(acc[N_POS],
+        _mm256_and_pd(_mm256_cmp_pd(x, zero, _CMP_GT_OQ), one));
+    acc[N_NEG]          = _mm256_add_pd(acc[N_NEG],
+        _mm256_and_pd(_mm256_cmp_pd(x, zero, _CMP_LT_OQ), one));
+    acc[SHIFTED_SUM]    = _mm256_add_pd(acc[SHIFTED_SUM], shifted);
+    acc[SHIFTED_SUM_SQ] = _mm256_add_pd(acc[SHIFTED_SUM_SQ], _mm256_mul_pd(shifted, shifted));
+}
+
+__attribute__((target("avx2")))
+void avx2_moments(
+    double const* data,
+    std::size_t   nblocks,
+    double        shift,
+    MomentLanes&  l
+) noexcept (true) {
+    __m256d const vshift = _mm256_set1_pd(shift);
+    __m256d acc[2][NSTATISTICS];
+    for (int g = 0; g < 2; ++g) {
+        for (int s = 0; s < NSTATISTICS; ++s) acc[g][s] = _mm256_setzero_pd();
+    }
+
+    for (std::size_t b = 0; b < nblocks; ++b) {
+        double const* block = data + b * lanes;
+        avx2_accumulate(_mm256_loadu_pd(block),     vshift, acc[0]);
+        avx2_accumulate(_mm256_loadu_pd(block + 4), vshift, acc[1]);
+    }
+
+    for (int g = 0; g < 2; ++g) {
+        for (int s = 0; s < NSTATISTICS; ++s) _mm256_storeu_pd(&l[s][4 * g], acc[g][s]);
+    }
+}
+
+__attribute__((target("avx2")))
+void avx2_extrema(
+    double const* data,
+    std::size_t   nblocks,
+    ExtremaLanes& l
+) noexcept (true) {
+    __m256d const signbit = _mm256_set1_pd(-0.0);
+    __m256d const step    = _mm256_set1_pd(lanes);
+
+    __m256d min[2], min_index[2], max[2], max_index[2], maxabs[2], maxabs_index[2];
+    __m256d index[2];
+    for (int g = 0; g < 2; ++g) {
+        __m256d const x = _mm256_loadu_pd(data + 4 * g);
+        index[g] = _mm256_set_pd(4 * g + 3, 4 * g + 2, 4 * g + 1, 4 * g);
+        min[g] = max[g] = x;
+        maxabs[g] = _mm256_andnot_pd(signbit, x);
+        min_index[g] = max_index[g] = maxabs_index[g] = index[g];
+    }
+
+    for (std::size_t b = 1; b < nblocks; ++b) {
+        double const* block = data + b * lanes;
+        for (int g = 0; g < 2; ++g) {
+            __m256d const x   = _mm256_loadu_pd(block + 4 * g);
+            __m256d const abs = _mm256_andnot_pd(signbit, x);
+            index[g] = _mm256_add_pd(index[g], step);
+
+            __m256d const lt = _mm256_cmp_pd(x, min[g], _CMP_LT_OQ);
+            min[g]       = _mm256_blendv_pd(min[g], x, lt);
+            min_index[g] = _mm256_blendv_pd(min_index[g], index[g], lt);
+
+            __m256d const gt = _mm256_cmp_pd(x, max[g], _CMP_GT_OQ);
+            max[g]       = _mm256_blendv_pd(max[g], x, gt);
+            max_index[g] = _mm256_blendv_pd(max_index[g], index[g], gt);
+
+            __m256d const gtabs = _mm256_cmp_pd(abs, maxabs[g], _CMP_GT_OQ);
+            maxabs[g]       = _mm256_blendv_pd(maxabs[g], abs, gtabs);
+            maxabs_index[g] = _mm256_blendv_pd(maxabs_index[g], index[g], gtabs);
         }
-    );
-    return count > 0 ? sum / count : 0;
+    }
+
+    for (int g = 0; g < 2; ++g) {
+        _mm256_storeu_pd(l.min          + 4 * g, min[g]);
+        _mm256_storeu_pd(l.min_index    + 4 * g, min_index[g]);
+        _mm256_storeu_pd(l.max          + 4 * g, max[g]);
+        _mm256_storeu_pd(l.max_index    + 4 * g, max_index[g]);
+        _mm256_storeu_pd(l.maxabs       + 4 * g, maxabs[g]);
+        _mm256_storeu_pd(l.maxabs_index + 4 * g, maxabs_index[g]);
+    }
 }
 
-float MeanNeg::compute(
-    ResampledSegment const & segment
-) noexcept (false) {
-    int count = 0;
-    double sum = std::accumulate(segment.begin(), segment.end(), 0.0,
-        [&](double acc, double x) {
-            if (x < 0) {
-                count ++;
-                return acc + x;
-            }
-            return acc;
+__attribute__((target("avx512f")))
+void avx512_moments(
+    double const* data,
+    std::size_t   nblocks,
+    double        shift,
+    MomentLanes&  l
+) noexcept (true) {
+    __m512d const vshift = _mm512_set1_pd(shift);
+    __m512d const zero   = _mm512_setzero_pd();
+    __m512d const one    = _mm512_set1_pd(1.0);
+
+    __m512d acc[NSTATISTICS];
+    for (int s = 0; s < NSTATISTICS; ++s) acc[s] = _mm512_setzero_pd();
+
+    for (std::size_t b = 0; b < nblocks; ++b) {
+        __m512d const x       = _mm512_loadu_pd(data + b * lanes);
+        __m512d const abs     = _mm512_abs_pd(x);
+        __m512d const shifted = _mm512_sub_pd(x, vshift);
+        __mmask8 const pos = _mm512_cmp_pd_mask(x, zero, _CMP_GT_OQ);
+        __mmask8 const neg = _mm512_cmp_pd_mask(x, zero, _CMP_LT_OQ);
+
+        acc[SUM]            = _mm512_add_pd(acc[SUM], x);
+        acc[SUM_ABS]        = _mm512_add_pd(acc[SUM_ABS], abs);
+        acc[SUM_SQ]         = _mm512_add_pd(acc[SUM_SQ], _mm512_mul_pd(x, x));
+        acc[SUM_POS]        = _mm512_add_pd(acc[SUM_POS], _mm512_maskz_mov_pd(pos, x));
+        acc[SUM_NEG]        = _mm512_add_pd(acc[SUM_NEG], _mm512_maskz_mov_pd(neg, x));
+        acc[N_POS]          = _mm512_add_pd(acc[N_POS], _mm512_maskz_mov_pd(pos, one));
+        acc[N_NEG]          = _mm512_add_pd(acc[N_NEG], _mm512_maskz_mov_pd(neg, one));
+        acc[SHIFTED_SUM]    = _mm512_add_pd(acc[SHIFTED_SUM], shifted);
+        acc[SHIFTED_SUM_SQ] = _mm512_add_pd(acc[SHIFTED_SUM_SQ], _mm512_mul_pd(shifted, shifted));
+    }
+
+    for (int s = 0; s < NSTATISTICS; ++s) _mm512_storeu_pd(l[s], acc[s]);
+}
+
+__attribute__((target("avx512f")))
+void avx512_extrema(
+    double const* data,
+    std::size_t   nblocks,
+    ExtremaLanes& l
+) noexcept (true) {
+    __m512d const step = _mm512_set1_pd(lanes);
+
+    __m512d index = _mm512_set_pd(7, 6, 5, 4, 3, 2, 1, 0);
+    __m512d min = _mm512_loadu_pd(data);
+    __m512d max = min;
+    __m512d maxabs = _mm512_abs_pd(min);
+    __m512d min_index = index;
+    __m512d max_index = index;
+    __m512d maxabs_index = index;
+
+    for (std::size_t b = 1; b < nblocks; ++b) {
+        __m512d const x   = _mm512_loadu_pd(data + b * lanes);
+        __m512d const abs = _mm512_abs_pd(x);
+        index = _mm512_add_pd(index, step);
+
+        __mmask8 const lt = _mm512_cmp_pd_mask(x, min, _CMP_LT_OQ);
+        min       = _mm512_mask_blend_pd(lt, min, x);
+        min_index = _mm512_mask_blend_pd(lt, min_index, index);
+
+        __mmask8 const gt = _mm512_cmp_pd_mask(x, max, _CMP_GT_OQ);
+        max       = _mm512_mask_blend_pd(gt, max, x);
+        max_index = _mm512_mask_blend_pd(gt, max_index, index);
+
+        __mmask8 const gtabs = _mm512_cmp_pd_mask(abs, maxabs, _CMP_GT_OQ);
+        maxabs       = _mm512_mask_blend_pd(gtabs, maxabs, abs);
+        maxabs_index = _mm512_mask_blend_pd(gtabs, maxabs_index, index);
+    }
+
+    _mm512_storeu_pd(l.min,          min);
+    _mm512_storeu_pd(l.min_index,    min_index);
+    _mm512_storeu_pd(l.max,          max);
+    _mm512_storeu_pd(l.max_index,    max_index);
+    _mm512_storeu_pd(l.maxabs,       maxabs);
+    _mm512_storeu_pd(l.maxabs_index, maxabs_index);
+}
+
+#endif /* ONESEISMIC_API_X86_KERNELS */
+
+Moments moments(
+    double const* data,
+    std::size_t   n,
+    double        shift,
+    SimdLevel     level
+) noexcept (true) {
+    double acc[NSTATISTICS] = {};
+    std::size_t const nblocks = n / lanes >= min_blocks ? n / lanes : 0;
+    if (nblocks > 0) {
+        MomentLanes l;
+        switch (level) {
+#ifdef ONESEISMIC_API_X86_KERNELS
+            case SimdLevel::AVX512: { avx512_moments(data, nblocks, shift, l); break; }
+            case SimdLevel::AVX2:   { avx2_moments  (data, nblocks, shift, l); break; }
+            case SimdLevel::SSE2:   { sse2_moments  (data, nblocks, shift, l); break; }
+#endif
+            default:                { scalar_moments(data, nblocks, shift, l); break; }
+        }
+        for (int s = 0; s < NSTATISTICS; ++s) {
+            acc[s] = combine(l[s]);
         }
-    );
-    return count > 0 ? sum / count : 0;
+    }
+
+    for (std::size_t i = nblocks * lanes; i < n; ++i) {
+        accumulate(acc, data[i], shift);
+    }
+    return to_moments(acc, shift);
 }
 
-float Median::compute(
-    ResampledSegment const & segment
-) noexcept (false) {
+Extrema extrema(
+    double const* data,
+    std::size_t   n,
+    SimdLevel     level
+) noexcept (true) {
+    std::size_t const nblocks = n / lanes;
+    if (nblocks < min_blocks) return sequential_extrema(data, 1, n, Extrema{ 0, 0, 0 });
+
+    ExtremaLanes l;
+    switch (level) {
+#ifdef ONESEISMIC_API_X86_KERNELS
+        case SimdLevel::AVX512: { avx512_extrema(data, nblocks, l); break; }
+        case SimdLevel::AVX2:   { avx2_extrema  (data, nblocks, l); break; }
+        case SimdLevel::SSE2:   { sse2_extrema  (data, nblocks, l); break; }
+#endif
+        default:                { scalar_extrema(data, nblocks, l); break; }
+    }
+    return finish_extrema(l, data, nblocks * lanes, n);
+}
+
+bool needs_moments(enum attribute attribute) noexcept (true) {
+    switch (attribute) {
+        case MEAN:
+        case MEANABS:
+        case MEANPOS:
+        case MEANNEG:
+        case RMS:
+        case VAR:
+        case SD:
+        case SUMPOS:
+        case SUMNEG:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool needs_extrema(enum attribute attribute) noexcept (true) {
+    switch (attribute) {
+        case MIN:
+        case MINAT:
+        case MAX:
+        case MAXAT:
+        case MAXABS:
+        case MAXABSAT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Population variance, as we are interested in the data of each window only */
+double variance(Moments const& m, std::size_t n) noexcept (true) {
+    double const mean = m.shifted_sum / n;
+    return std::max(0.0, m.shifted_sumsq / n - mean * mean);
+}
+
+double median(std::vector< double >& data) noexcept (true) {
     /*
     The std::nth_element function sets the middle element of a vector in such a
     manner that all values on the right side of the middle element are greater
@@ -146,103 +592,164 @@ float Median::compute(
     std::max_element to obtain the largest element before the middle element to
     compute the average.
     */
-    auto temp = std::vector<double>(segment.begin(), segment.end());
-    const auto middle_right = temp.begin() + segment.size() / 2;
-    std::nth_element(temp.begin(), middle_right, temp.end());
-    if (segment.size() % 2 == 0) {
-        const auto max_left = std::max_element(temp.begin(), middle_right);
+    const auto middle_right = data.begin() + data.size() / 2;
+    std::nth_element(data.begin(), middle_right, data.end());
+    if (data.size() % 2 == 0) {
+        const auto max_left = std::max_element(data.begin(), middle_right);
         return (*max_left + *middle_right) / 2;
     }
-    else {
-        return *middle_right;
-    }
+    return *middle_right;
 }
 
-float Rms::compute(
-    ResampledSegment const & segment
-) noexcept (false) {
-    float sum = std::accumulate(segment.begin(), segment.end(), 0.0,
-        [](double a, double b) {
-            return a + std::pow(b, 2);
+} // namespace
+
+AttributeReducer::AttributeReducer(
+    enum attribute const* attributes,
+    std::size_t nattributes,
+    void** dst,
+    std::size_t size
+) : m_size(size / sizeof(float)) {
+    for (std::size_t i = 0; i < nattributes; ++i) {
+        enum attribute const attribute = attributes[i];
+        if (attribute < VALUE or attribute > SUMNEG) {
+            throw std::runtime_error("Attribute not implemented");
         }
-    );
-    return std::sqrt(sum / segment.size());
+
+        this->m_outputs.push_back({ attribute, static_cast< float* >(dst[i]) });
+        this->m_moments = this->m_moments or needs_moments(attribute);
+        this->m_extrema = this->m_extrema or needs_extrema(attribute);
+        this->m_median  = this->m_median  or attribute == MEDIAN;
+    }
 }
 
-namespace {
+AttributeReducer::Moments AttributeReducer::moments(
+    double const* data,
+    std::size_t n,
+    double shift
+) noexcept (true) {
+    return ::moments(data, n, shift, simd_level());
+}
 
-double variance(
-    ResampledSegment const & segment
-){
-    double sum = std::accumulate(segment.begin(), segment.end(), 0.0);
-    double mean = sum / segment.size();
-    double stdSum = std::accumulate(segment.begin(), segment.end(), 0.0,
-        [&](double a, double b){ return a + std::pow(b - mean, 2); }
-    );
-    return stdSum / segment.size();
+AttributeReducer::Moments AttributeReducer::moments(
+    double const* data,
+    std::size_t n,
+    double shift,
+    SimdLevel level
+) noexcept (false) {
+    if (level > simd_level()) {
+        throw std::invalid_argument("Instruction set not supported by the cpu");
+    }
+    return ::moments(data, n, shift, level);
 }
 
-} // namespace
+AttributeReducer::Extrema AttributeReducer::extrema(
+    double const* data,
+    std::size_t n
+) noexcept (true) {
+    return ::extrema(data, n, simd_level());
+}
 
-float Var::compute(
-    ResampledSegment const & segment
+AttributeReducer::Extrema AttributeReducer::extrema(
+    double const* data,
+    std::size_t n,
+    SimdLevel level
 ) noexcept (false) {
-    return variance(segment);
+    if (level > simd_level()) {
+        throw std::invalid_argument("Instruction set not supported by the cpu");
+    }
+    return ::extrema(data, n, level);
 }
 
-float Sd::compute(
-    ResampledSegment const & segment
-) noexcept (false) {
-    return std::sqrt(variance(segment));
+void AttributeReducer::fill(float value, std::size_t index) noexcept (true) {
+    for (auto const& output : this->m_outputs) {
+        output.dst[index] = value;
+    }
 }
 
-float SumPos::compute(
-    ResampledSegment const & segment
-) noexcept (false) {
-    double sum = 0.0;
-    std::for_each(segment.begin(), segment.end(), [&](double x) {
-         if (x > 0) { sum += x; }
-    });
-    return sum; 
+void AttributeReducer::fill(
+    float value,
+    std::size_t from,
+    std::size_t to
+) noexcept (true) {
+    if (from >= to) return;
+    for (auto const& output : this->m_outputs) {
+        std::fill(output.dst + from, output.dst + to, value);
+    }
 }
 
-float SumNeg::compute(
-    ResampledSegment const & segment
+void AttributeReducer::reduce(
+    ResampledSegment const& segment,
+    std::size_t index
 ) noexcept (false) {
-    double sum = 0.0;
-    std::for_each(segment.begin(), segment.end(), [&](double x) {
-         if (x < 0) { sum += x; }
-    });
-    return sum;
+    double const* data = &*segment.begin();
+    std::size_t const n = segment.size();
+    double const reference = data[segment.reference_index()];
+
+    Moments m{};
+    if (this->m_moments) m = AttributeReducer::moments(data, n, reference);
+
+    Extrema e{};
+    if (this->m_extrema) e = AttributeReducer::extrema(data, n);
+
+    double median = 0;
+    if (this->m_median) {
+        this->m_scratch.assign(segment.begin(), segment.end());
+        median = ::median(this->m_scratch);
+    }
+
+    for (auto const& output : this->m_outputs) {
+        float value = 0;
+        switch (output.attribute) {
+            case VALUE:    { value = reference;                                   break; }
+            case MIN:      { value = data[e.min_index];                           break; }
+            case MINAT:    { value = segment.sample_position_at(e.min_index);     break; }
+            case MAX:      { value = data[e.max_index];                           break; }
+            case MAXAT:    { value = segment.sample_position_at(e.max_index);     break; }
+            case MAXABS:   { value = std::abs(data[e.maxabs_index]);              break; }
+            case MAXABSAT: { value = segment.sample_position_at(e.maxabs_index);  break; }
+            case MEAN:     { value = m.sum / n;                                   break; }
+            case MEANABS:  { value = m.sumabs / n;                                break; }
+            case MEANPOS:  { value = m.npos > 0 ? m.sumpos / m.npos : 0;          break; }
+            case MEANNEG:  { value = m.nneg > 0 ? m.sumneg / m.nneg : 0;          break; }
+            case MEDIAN:   { value = median;                                      break; }
+            case RMS:      { value = std::sqrt(m.sumsq / n);                      break; }
+            case VAR:      { value = variance(m, n);                              break; }
+            case SD:       { value = std::sqrt(variance(m, n));                   break; }
+            case SUMPOS:   { value = m.sumpos;                                    break; }
+            case SUMNEG:   { value = m.sumneg;                                    break; }
+        }
+        output.dst[index] = value;
+    }
 }
 
 void calc_attributes(
     SurfaceBoundedSubVolume const& src_subvolume,
     ResampledSegmentBlueprint const* dst_segment_blueprint,
-    std::vector< std::unique_ptr< AttributeMap > >& attrs,
+    AttributeReducer& reducer,
     std::size_t from,
     std::size_t to
 ) noexcept (false) {
+    if (to > reducer.size()) {
+        throw std::out_of_range("Attempting write outside attribute buffer");
+    }
+
     auto fill = src_subvolume.fillvalue();
 
     RawSegment src_segment = src_subvolume.vertical_segment(from);
     ResampledSegment dst_segment =  ResampledSegment(0, 0, 0, dst_segment_blueprint);
 
-    for (std::size_t i = from; i < to; ++i) {
-        if (src_subvolume.is_empty(i)) {
-            for (auto& attr : attrs) {
-                attr->write(fill, i);
-            }
-            continue;
-        }
-
-        src_subvolume.reinitialize(i, src_segment);
-        src_subvolume.reinitialize(i, dst_segment);
-        resample(src_segment, dst_segment);
+    /* Empty segments between the spans are filled in bulk */
+    std::size_t next = from;
+    for (auto const& span : src_subvolume.spans(from, to)) {
+        reducer.fill(fill, next, span.first);
+        for (std::size_t i = span.first; i < span.last; ++i) {
+            src_subvolume.reinitialize(i, src_segment);
+            src_subvolume.reinitialize(i, dst_segment);
+            resample(src_segment, dst_segment);
 
-        for (auto& attr : attrs) {
-            auto value = attr->compute(dst_segment);
-            attr->write(value, i);
+            reducer.reduce(dst_segment, i);
         }
+        next = span.last;
     }
+    reducer.fill(fill, next, to);
 }
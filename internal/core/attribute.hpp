@@ -1,168 +1,126 @@
 #ifndef ONESEISMIC_API_ATTRIBUTE_HPP
 #define ONESEISMIC_API_ATTRIBUTE_HPP
 
+#include "binaryoperator.hpp"
+#include "ctypes.h"
 #include "regularsurface.hpp"
 #include "subvolume.hpp"
-#include <memory>
+#include <cstddef>
 #include <stdexcept>
+#include <vector>
 
-/* Base class for attribute calculations
+/* Reduction of segments to a set of attributes
  *
- * The base class main role is to centralize buffer writes such that
- * implementations of new attributes, in the form of derived classes, don't
- * have to deal with pointer arithmetic.
+ * The requested attributes are resolved once, into the statistics they need.
+ * The statistics are then collected in a single pass over every segment, no
+ * matter how many attributes are requested, and all the attributes are
+ * derived from them. Statistics are grouped as moments (sums and counts) and
+ * extrema (min, max and max abs, with their positions), and only the groups
+ * needed are collected. The median is the only attribute that needs a
+ * (partial) sort of the segment.
+ *
+ * Every attribute is written to its own buffer, with room for one float per
+ * horizontal position.
  */
-class AttributeMap {
-public:
-    AttributeMap(void* dst, std::size_t size) : dst(dst), size(size) {};
-
-    virtual float compute(ResampledSegment const & segment) noexcept (false) = 0;
-
-    void write(float value, std::size_t index) {
-        std::size_t offset = index * sizeof(float);
-
-        if (offset >= this->size) {
-            throw std::out_of_range("Attempting write outside attribute buffer");
-        }
-
-        memcpy((char*)this->dst + offset, &value, sizeof(float));
+class AttributeReducer {
+public:
+    /*
+     * dst[i] is the output buffer of attributes[i], and every buffer is size
+     * bytes
+     */
+    AttributeReducer(
+        enum attribute const* attributes,
+        std::size_t nattributes,
+        void** dst,
+        std::size_t size
+    ) noexcept (false);
+
+    /* Number of horizontal positions there is room for in the buffers */
+    std::size_t size() const noexcept (true) {
+        return this->m_size;
     }
 
-    virtual ~AttributeMap() {};
-private:
-    void*       dst;
-    std::size_t size;
-};
-
-struct Value final : public AttributeMap {
-    Value(void* dst, std::size_t size) : AttributeMap(dst, size) {}
-
-    float compute(ResampledSegment const & segment) noexcept (false) override;
-};
-
-
-class Min final : public AttributeMap {
-public:
-    Min(void* dst, std::size_t size) : AttributeMap(dst, size) {}
-
-    float compute(ResampledSegment const & segment) noexcept (false) override;
-};
-
-class MinAt final : public AttributeMap {
-public:
-    MinAt(void* dst, std::size_t size) : AttributeMap(dst, size) {}
-
-    float compute(ResampledSegment const & segment) noexcept (false) override;
-};
-
-class Max final : public AttributeMap {
-public:
-    Max(void* dst, std::size_t size) : AttributeMap(dst, size) {}
-
-    float compute(ResampledSegment const & segment) noexcept (false) override;
-};
-
-class MaxAt final : public AttributeMap {
-public:
-    MaxAt(void* dst, std::size_t size) : AttributeMap(dst, size) {}
-
-    float compute(ResampledSegment const & segment) noexcept (false) override;
-};
-
-class MaxAbs final : public AttributeMap {
-public:
-    MaxAbs(void* dst, std::size_t size) : AttributeMap(dst, size) {}
-
-    float compute(ResampledSegment const & segment) noexcept (false) override;
-};
-
-class MaxAbsAt final : public AttributeMap {
-public:
-    MaxAbsAt(void* dst, std::size_t size) : AttributeMap(dst, size) {}
-
-    float compute(ResampledSegment const & segment) noexcept (false) override;
-};
-
-class Mean final : public AttributeMap {
-public:
-    Mean(void* dst, std::size_t size) : AttributeMap(dst, size) {}
-
-    float compute(ResampledSegment const & segment) noexcept (false) override;
-};
-
-class MeanAbs final : public AttributeMap {
-public:
-    MeanAbs(void* dst, std::size_t size) : AttributeMap(dst, size) {}
-
-    float compute(ResampledSegment const & segment) noexcept (false) override;
-};
-
-class MeanPos final : public AttributeMap {
-public:
-    MeanPos(void* dst, std::size_t size) : AttributeMap(dst, size) {}
-
-    float compute(ResampledSegment const & segment) noexcept (false) override;
-};
-
-class MeanNeg final : public AttributeMap {
-public:
-    MeanNeg(void* dst, std::size_t size) : AttributeMap(dst, size) {}
-
-    float compute(ResampledSegment const & segment) noexcept (false) override;
-};
-
-class Median final : public AttributeMap {
-public:
-    Median(void* dst, std::size_t size) : AttributeMap(dst, size) {}
-
-    float compute(ResampledSegment const & segment) noexcept (false) override;
-};
+    /* Reduce segment and write its attributes at horizontal position index */
+    void reduce(ResampledSegment const& segment, std::size_t index) noexcept (false);
+
+    /* Write value to every attribute at horizontal position index */
+    void fill(float value, std::size_t index) noexcept (true);
+
+    /* Write value to every attribute at horizontal positions [from, to) */
+    void fill(float value, std::size_t from, std::size_t to) noexcept (true);
+
+    /* Statistics of a segment, collected in one pass */
+    struct Moments {
+        double sum;
+        double sumabs;
+        double sumsq;
+        double sumpos;
+        double sumneg;
+        std::size_t npos;
+        std::size_t nneg;
+        /*
+         * Sums of the samples, and their squares, shifted by the reference
+         * sample. Variance from shifted sums is numerically stable as long as
+         * the shift is close to the mean, which a sample within the segment
+         * is.
+         */
+        double shift;
+        double shifted_sum;
+        double shifted_sumsq;
+    };
+
+    struct Extrema {
+        std::size_t min_index;
+        std::size_t max_index;
+        std::size_t maxabs_index;
+    };
+
+    /*
+     * Moments and extrema of n samples, shifted by shift. Extrema are the
+     * first min, max and max abs samples, and need n > 0.
+     *
+     * The statistics are collected by vectorized kernels, for the best
+     * instruction set supported by the cpu, see simd_level. All kernels sum
+     * the samples in the same order, so the results do not depend on the
+     * instruction set. Asking for an instruction set above simd_level() is an
+     * error.
+     */
+    static Moments moments(double const* data, std::size_t n, double shift) noexcept (true);
+    static Moments moments(
+        double const* data,
+        std::size_t n,
+        double shift,
+        SimdLevel level
+    ) noexcept (false);
+
+    static Extrema extrema(double const* data, std::size_t n) noexcept (true);
+    static Extrema extrema(
+        double const* data,
+        std::size_t n,
+        SimdLevel level
+    ) noexcept (false);
 
-class Rms final : public AttributeMap {
-public:
-    Rms(void* dst, std::size_t size) : AttributeMap(dst, size) {}
-
-    float compute(ResampledSegment const & segment) noexcept (false) override;
-};
-
-/* Calculated the population variance as we are interested in variance strictly
- * for the data defined by each window.
- */
-class Var final : public AttributeMap {
-public:
-    Var(void* dst, std::size_t size) : AttributeMap(dst, size) {}
-
-    float compute(ResampledSegment const & segment) noexcept (false) override;
-};
-
-/* Calculated the population standard deviation as we are interested in
- * standard deviation strictly for the data defined by each window.
- */
-class Sd final : public AttributeMap {
-public:
-    Sd(void* dst, std::size_t size) : AttributeMap(dst, size) {}
-
-    float compute(ResampledSegment const & segment) noexcept (false) override;
-};
-
-class SumPos final : public AttributeMap {
-public:
-    SumPos(void* dst, std::size_t size) : AttributeMap(dst, size) {}
+private:
+    struct Output {
+        enum attribute attribute;
+        float*         dst;
+    };
 
-    float compute(ResampledSegment const & segment) noexcept (false) override;
-};
+    std::vector< Output > m_outputs;
+    std::size_t m_size;
 
-class SumNeg final : public AttributeMap {
-public:
-    SumNeg(void* dst, std::size_t size) : AttributeMap(dst, size) {}
+    bool m_moments = false;
+    bool m_extrema = false;
+    bool m_median  = false;
 
-    float compute(ResampledSegment const & segment) noexcept (false) override;
+    /* Scratch space for the median, kept between segments */
+    std::vector< double > m_scratch;
 };
 
 void calc_attributes(
     SurfaceBoundedSubVolume const& src_subvolume,
     ResampledSegmentBlueprint const* dst_segment_blueprint,
-    std::vector< std::unique_ptr< AttributeMap > >& attrs,
+    AttributeReducer& reducer,
     std::size_t from,
     std::size_t to
 ) noexcept (false);
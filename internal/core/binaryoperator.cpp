@@ -0,0 +1,243 @@
+#include "binaryoperator.hpp"
+
+#include <cstddef>
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define ONESEISMIC_API_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
+#include "ctypes.h"
+
+namespace {
+
+/*
+ * Each operator provides an apply() overload per vector type. The kernels
+ * below are written once as templates over the operator, and instantiated for
+ * each instruction set through the target attribute. Only kernels matching the
+ * cpu are ever called.
+ */
+
+struct Addition {
+    static float apply(float a, float b) noexcept (true) { return a + b; }
+
+#ifdef ONESEISMIC_API_X86_KERNELS
+    __attribute__((target("sse2")))
+    static __m128 apply(__m128 a, __m128 b) noexcept (true) {
+        return _mm_add_ps(a, b);
+    }
+
+    __attribute__((target("avx2")))
+    static __m256 apply(__m256 a, __m256 b) noexcept (true) {
+        return _mm256_add_ps(a, b);
+    }
+
+    __attribute__((target("avx512f")))
+    static __m512 apply(__m512 a, __m512 b) noexcept (true) {
+        return _mm512_add_ps(a, b);
+    }
+#endif
+};
+
+struct Subtraction {
+    static float apply(float a, float b) noexcept (true) { return a - b; }
+
+#ifdef ONESEISMIC_API_X86_KERNELS
+    __attribute__((target("sse2")))
+    static __m128 apply(__m128 a, __m128 b) noexcept (true) {
+        return _mm_sub_ps(a, b);
+    }
+
+    __attribute__((target("avx2")))
+    static __m256 apply(__m256 a, __m256 b) noexcept (true) {
+        return _mm256_sub_ps(a, b);
+    }
+
+    __attribute__((target("avx512f")))
+    static __m512 apply(__m512 a, __m512 b) noexcept (true) {
+        return _mm512_sub_ps(a, b);
+    }
+#endif
+};
+
+struct Multiplication {
+    static float apply(float a, float b) noexcept (true) { return a * b; }
+
+#ifdef ONESEISMIC_API_X86_KERNELS
+    __attribute__((target("sse2")))
+    static __m128 apply(__m128 a, __m128 b) noexcept (true) {
+        return _mm_mul_ps(a, b);
+    }
+
+    __attribute__((target("avx2")))
+    static __m256 apply(__m256 a, __m256 b) noexcept (true) {
+        return _mm256_mul_ps(a, b);
+    }
+
+    __attribute__((target("avx512f")))
+    static __m512 apply(__m512 a, __m512 b) noexcept (true) {
+        return _mm512_mul_ps(a, b);
+    }
+#endif
+};
+
+/*
+ * Division by zero follows IEEE 754, +-inf, or NaN for 0 / 0, the same as the
+ * scalar a / b, so that every instruction set gives identical results.
+ */
+struct Division {
+    static float apply(float a, float b) noexcept (true) { return a / b; }
+
+#ifdef ONESEISMIC_API_X86_KERNELS
+    __attribute__((target("sse2")))
+    static __m128 apply(__m128 a, __m128 b) noexcept (true) {
+        return _mm_div_ps(a, b);
+    }
+
+    __attribute__((target("avx2")))
+    static __m256 apply(__m256 a, __m256 b) noexcept (true) {
+        return _mm256_div_ps(a, b);
+    }
+
+    __attribute__((target("avx512f")))
+    static __m512 apply(__m512 a, __m512 b) noexcept (true) {
+        return _mm512_div_ps(a, b);
+    }
+#endif
+};
+
+template< typename Operator >
+void scalar_kernel(
+    float*       dst,
+    float const* a,
+    float const* b,
+    std::size_t  n
+) {
+    for (std::size_t i = 0; i < n; ++i) {
+        dst[i] = Operator::apply(a[i], b[i]);
+    }
+}
+
+#ifdef ONESEISMIC_API_X86_KERNELS
+
+template< typename Operator >
+__attribute__((target("sse2")))
+void sse2_kernel(
+    float*       dst,
+    float const* a,
+    float const* b,
+    std::size_t  n
+) {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 const va = _mm_loadu_ps(a + i);
+        __m128 const vb = _mm_loadu_ps(b + i);
+        _mm_storeu_ps(dst + i, Operator::apply(va, vb));
+    }
+    for (; i < n; ++i) {
+        dst[i] = Operator::apply(a[i], b[i]);
+    }
+}
+
+template< typename Operator >
+__attribute__((target("avx2")))
+void avx2_kernel(
+    float*       dst,
+    float const* a,
+    float const* b,
+    std::size_t  n
+) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 const va = _mm256_loadu_ps(a + i);
+        __m256 const vb = _mm256_loadu_ps(b + i);
+        _mm256_storeu_ps(dst + i, Operator::apply(va, vb));
+    }
+    for (; i < n; ++i) {
+        dst[i] = Operator::apply(a[i], b[i]);
+    }
+}
+
+template< typename Operator >
+__attribute__((target("avx512f")))
+void avx512_kernel(
+    float*       dst,
+    float const* a,
+    float const* b,
+    std::size_t  n
+) {
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 const va = _mm512_loadu_ps(a + i);
+        __m512 const vb = _mm512_loadu_ps(b + i);
+        _mm512_storeu_ps(dst + i, Operator::apply(va, vb));
+    }
+
+    /* The tail is handled with a masked load/store rather than scalar code */
+    if (i < n) {
+        __mmask16 const mask = (__mmask16)((1u << (n - i)) - 1);
+        __m512 const va = _mm512_maskz_loadu_ps(mask, a + i);
+        __m512 const vb = _mm512_maskz_loadu_ps(mask, b + i);
+        _mm512_mask_storeu_ps(dst + i, mask, Operator::apply(va, vb));
+    }
+}
+
+#endif /* ONESEISMIC_API_X86_KERNELS */
+
+template< typename Operator >
+binary_kernel kernel(SimdLevel level) noexcept (false) {
+    if (level > simd_level()) {
+        throw std::invalid_argument("Instruction set not supported by the cpu");
+    }
+
+    switch (level) {
+#ifdef ONESEISMIC_API_X86_KERNELS
+        case SimdLevel::AVX512: return &avx512_kernel< Operator >;
+        case SimdLevel::AVX2:   return &avx2_kernel< Operator >;
+        case SimdLevel::SSE2:   return &sse2_kernel< Operator >;
+#endif
+        case SimdLevel::SCALAR: return &scalar_kernel< Operator >;
+        default: {
+            throw std::invalid_argument("Unhandled instruction set");
+        }
+    }
+}
+
+SimdLevel detect_simd_level() noexcept (true) {
+#ifdef ONESEISMIC_API_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2"))    return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse2"))    return SimdLevel::SSE2;
+#endif
+    return SimdLevel::SCALAR;
+}
+
+} /* namespace */
+
+SimdLevel simd_level() noexcept (true) {
+    static SimdLevel const level = detect_simd_level();
+    return level;
+}
+
+binary_kernel make_binary_kernel(
+    enum binary_operator binary_symbol,
+    SimdLevel level
+) noexcept (false) {
+    switch (binary_symbol) {
+        case ADDITION:       return kernel< Addition >(level);
+        case SUBTRACTION:    return kernel< Subtraction >(level);
+        case MULTIPLICATION: return kernel< Multiplication >(level);
+        case DIVISION:       return kernel< Division >(level);
+        default: {
+            throw std::invalid_argument("Unhandled binary operator");
+        }
+    }
+}
+
+binary_kernel make_binary_kernel(
+    enum binary_operator binary_symbol
+) noexcept (false) {
+    return make_binary_kernel(binary_symbol, simd_level());
+}
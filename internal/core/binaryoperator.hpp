@@ -0,0 +1,53 @@
+#ifndef ONESEISMIC_API_BINARYOPERATOR_HPP
+#define ONESEISMIC_API_BINARYOPERATOR_HPP
+
+#include <cstddef>
+
+#include "ctypes.h"
+
+/**
+ * Elementwise kernels for the binary operators applied to data from two cubes.
+ *
+ * Each operator is implemented for several instruction sets. The best
+ * implementation supported by the running cpu is picked at runtime, so that
+ * the binary does not have to be built for a specific target.
+ */
+enum class SimdLevel {
+    SCALAR,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+/**
+ * Computes dst[i] = a[i] <op> b[i] for i in [0, n). dst may alias a or b,
+ * but must not otherwise overlap with them.
+ *
+ * Division by zero follows IEEE 754: +-inf, or NaN for 0 / 0. All instruction
+ * sets give results identical to the scalar kernel.
+ */
+using binary_kernel = void (*)(
+    float*       dst,
+    float const* a,
+    float const* b,
+    std::size_t  n
+);
+
+/** The best instruction set supported by both the build and the running cpu */
+SimdLevel simd_level() noexcept (true);
+
+/**
+ * Kernel for the operator implemented with the given instruction set. Asking
+ * for an instruction set above simd_level() is an error.
+ */
+binary_kernel make_binary_kernel(
+    enum binary_operator binary_symbol,
+    SimdLevel level
+) noexcept (false);
+
+/** Kernel for the operator implemented with the best instruction set */
+binary_kernel make_binary_kernel(
+    enum binary_operator binary_symbol
+) noexcept (false);
+
+#endif /* ONESEISMIC_API_BINARYOPERATOR_HPP */
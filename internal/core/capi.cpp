@@ -3,6 +3,9 @@
 
 #include "cppapi.hpp"
 
+#include "chunkcache.hpp"
+#include "datahandlepool.hpp"
+
 #include "exceptions.hpp"
 #include "subvolume.hpp"
 
@@ -105,6 +108,166 @@ int datahandle_free(Context* ctx, DataHandle* ds) {
     }
 }
 
+int datahandle_pool_configure(
+    Context* ctx,
+    size_t capacity,
+    size_t idle_ttl
+) {
+    try {
+        DataHandlePool::instance().configure(
+            capacity,
+            std::chrono::seconds(idle_ttl)
+        );
+        return STATUS_OK;
+    } catch (...) {
+        return handle_exception(ctx, std::current_exception());
+    }
+}
+
+int subcube_requests_configure(Context* ctx, size_t max_requests) {
+    try {
+        configure_subcube_requests(max_requests);
+        return STATUS_OK;
+    } catch (...) {
+        return handle_exception(ctx, std::current_exception());
+    }
+}
+
+int fence_sorting_configure(Context* ctx, size_t min_points) {
+    try {
+        cppapi::configure_fence_sorting(min_points);
+        return STATUS_OK;
+    } catch (...) {
+        return handle_exception(ctx, std::current_exception());
+    }
+}
+
+int fence_deduplication_configure(Context* ctx, float epsilon) {
+    try {
+        cppapi::configure_fence_deduplication(epsilon);
+        return STATUS_OK;
+    } catch (...) {
+        return handle_exception(ctx, std::current_exception());
+    }
+}
+
+int subvolume_trace_reads_configure(Context* ctx, int enabled) {
+    try {
+        cppapi::configure_subvolume_trace_reads(enabled != 0);
+        return STATUS_OK;
+    } catch (...) {
+        return handle_exception(ctx, std::current_exception());
+    }
+}
+
+int attribute_memory_configure(Context* ctx, size_t budget) {
+    try {
+        cppapi::configure_attribute_memory(budget);
+        return STATUS_OK;
+    } catch (...) {
+        return handle_exception(ctx, std::current_exception());
+    }
+}
+
+int attribute_prefetch_configure(Context* ctx, size_t depth) {
+    try {
+        cppapi::configure_attribute_prefetch(depth);
+        return STATUS_OK;
+    } catch (...) {
+        return handle_exception(ctx, std::current_exception());
+    }
+}
+
+int chunk_cache_configure(Context* ctx, size_t capacity) {
+    try {
+        ChunkCache::instance().configure(capacity);
+        return STATUS_OK;
+    } catch (...) {
+        return handle_exception(ctx, std::current_exception());
+    }
+}
+
+int chunk_cache_statistics(Context* ctx, struct ChunkCacheStatistics* out) {
+    try {
+        if (not out) throw detail::nullptr_error("Invalid out pointer");
+
+        auto const statistics = ChunkCache::instance().statistics();
+        out->hits    = statistics.hits;
+        out->misses  = statistics.misses;
+        out->size    = statistics.size;
+        out->entries = statistics.entries;
+        return STATUS_OK;
+    } catch (...) {
+        return handle_exception(ctx, std::current_exception());
+    }
+}
+
+int single_datahandle_checkout(
+    Context* ctx,
+    const char* url,
+    const char* credentials,
+    DataHandle** ds_out,
+    int* pooled
+) {
+    try {
+        if (not ds_out) throw detail::nullptr_error("Invalid out pointer");
+
+        auto& pool = DataHandlePool::instance();
+        bool hit = false;
+        *ds_out = new SingleDataHandle(pool.checkout(url, credentials, &hit));
+        if (pooled) *pooled = hit;
+        return STATUS_OK;
+    } catch (...) {
+        return handle_exception(ctx, std::current_exception());
+    }
+}
+
+int double_datahandle_checkout(
+    Context* ctx,
+    const char* url_A,
+    const char* credentials_A,
+    const char* url_B,
+    const char* credentials_B,
+    enum binary_operator bin_operator,
+    DataHandle** datahandle,
+    int* pooled_A,
+    int* pooled_B
+) {
+    try {
+        if (not datahandle)
+            throw detail::nullptr_error("Invalid datahandle pointer");
+
+        auto& pool = DataHandlePool::instance();
+        bool hit_A = false;
+        bool hit_B = false;
+        *datahandle = new DoubleDataHandle(
+            pool.checkout(url_A, credentials_A, &hit_A),
+            pool.checkout(url_B, credentials_B, &hit_B),
+            bin_operator
+        );
+        if (pooled_A) *pooled_A = hit_A;
+        if (pooled_B) *pooled_B = hit_B;
+        return STATUS_OK;
+    } catch (...) {
+        return handle_exception(ctx, std::current_exception());
+    }
+}
+
+int datahandle_return(Context* ctx, DataHandle* ds) {
+    try {
+        if (not ds) return STATUS_OK;
+        ds->close();
+
+        delete ds;
+
+        DataHandlePool::instance().evict_expired();
+        return STATUS_OK;
+    } catch (const std::exception& e) {
+        if (ctx) ctx->errmsg = e.what();
+        return STATUS_RUNTIME_ERROR;
+    }
+}
+
 int regular_surface_new(
     Context* ctx,
     float* data,
@@ -165,7 +328,7 @@ int subvolume_new(
         if (not bottom)
             throw detail::nullptr_error("Invalid bottom surface");
 
-        *out = make_subvolume(
+        *out = make_tiled_subvolume(
             datahandle->get_metadata(),
             *reference,
             *top,
@@ -177,6 +340,36 @@ int subvolume_new(
     }
 }
 
+int subvolume_window_new(
+    Context* ctx,
+    DataHandle* datahandle,
+    RegularSurface* reference,
+    float above,
+    float below,
+    SurfaceBoundedSubVolume** out
+) {
+    try {
+        if (not out)
+            throw detail::nullptr_error("Invalid out pointer");
+        if (not datahandle)
+            throw detail::nullptr_error("Invalid datahandle");
+        if (not reference)
+            throw detail::nullptr_error("Invalid reference surface");
+        if (above < 0 or below < 0)
+            throw detail::bad_request("Above and below must be positive");
+
+        *out = make_tiled_subvolume(
+            datahandle->get_metadata(),
+            *reference,
+            above,
+            below
+        );
+        return STATUS_OK;
+    } catch (...) {
+        return handle_exception(ctx, std::current_exception());
+    }
+}
+
 int subvolume_free(Context* ctx, SurfaceBoundedSubVolume* subvolume) {
     try {
         if (not subvolume)
@@ -199,6 +392,8 @@ int slice(
     axis_name ax,
     struct Bound* bounds,
     size_t nbounds,
+    const struct LevelOfDetail* lod,
+    struct SampleEncoding* encoding,
     response* out
 ) {
     try {
@@ -215,7 +410,59 @@ int slice(
             bounds++;
         }
 
-        cppapi::slice(*datahandle, direction, lineno, slice_bounds, out);
+        LevelOfDetail const level_of_detail = lod ? *lod : LevelOfDetail{ 0, 0 };
+
+        cppapi::slice(
+            *datahandle,
+            direction,
+            lineno,
+            slice_bounds,
+            level_of_detail,
+            encoding,
+            out
+        );
+        return STATUS_OK;
+    } catch (...) {
+        return handle_exception(ctx, std::current_exception());
+    }
+}
+
+int slice_batch(
+    Context* ctx,
+    DataHandle* datahandle,
+    const struct SliceLine* slices,
+    size_t nslices,
+    struct Bound* bounds,
+    size_t nbounds,
+    const struct LevelOfDetail* lod,
+    struct SampleEncoding* encodings,
+    size_t* offsets,
+    response* out
+) {
+    try {
+        if (not out)
+            throw detail::nullptr_error("Invalid out pointer");
+        if (not datahandle)
+            throw detail::nullptr_error("Invalid datahandle");
+        if (not offsets)
+            throw detail::nullptr_error("Invalid offsets pointer");
+        if (nslices > 0 and not slices)
+            throw detail::nullptr_error("Invalid slices pointer");
+
+        std::vector< SliceLine > slice_lines(slices, slices + nslices);
+        std::vector< Bound > slice_bounds(bounds, bounds + nbounds);
+
+        LevelOfDetail const level_of_detail = lod ? *lod : LevelOfDetail{ 0, 0 };
+
+        cppapi::slice_batch(
+            *datahandle,
+            slice_lines,
+            slice_bounds,
+            level_of_detail,
+            encodings,
+            offsets,
+            out
+        );
         return STATUS_OK;
     } catch (...) {
         return handle_exception(ctx, std::current_exception());
@@ -229,6 +476,8 @@ int slice_metadata(
     axis_name ax,
     struct Bound* bounds,
     size_t nbounds,
+    const struct LevelOfDetail* lod,
+    const struct SampleEncoding* encoding,
     response* out
 ) {
     try {
@@ -245,7 +494,17 @@ int slice_metadata(
             bounds++;
         }
 
-        cppapi::slice_metadata(*datahandle, direction, lineno, slice_bounds, out);
+        LevelOfDetail const level_of_detail = lod ? *lod : LevelOfDetail{ 0, 0 };
+
+        cppapi::slice_metadata(
+            *datahandle,
+            direction,
+            lineno,
+            slice_bounds,
+            level_of_detail,
+            encoding,
+            out
+        );
         return STATUS_OK;
     } catch (...) {
         return handle_exception(ctx, std::current_exception());
@@ -259,7 +518,9 @@ int fence(
     const float* coordinates,
     size_t npoints,
     enum interpolation_method interpolation_method,
+    const struct Bound* sample_window,
     const float* fillValue,
+    struct SampleEncoding* encoding,
     response* out
 ) {
     try {
@@ -274,7 +535,9 @@ int fence(
             coordinates,
             npoints,
             interpolation_method,
+            sample_window,
             fillValue,
+            encoding,
             out
         );
         return STATUS_OK;
@@ -287,6 +550,8 @@ int fence_metadata(
     Context* ctx,
     DataHandle* datahandle,
     size_t npoints,
+    const struct Bound* sample_window,
+    const struct SampleEncoding* encoding,
     response* out
 ) {
     try {
@@ -295,7 +560,13 @@ int fence_metadata(
         if (not datahandle)
             throw detail::nullptr_error("Invalid datahandle");
 
-        cppapi::fence_metadata(*datahandle, npoints, out);
+        cppapi::fence_metadata(
+            *datahandle,
+            npoints,
+            sample_window,
+            encoding,
+            out
+        );
         return STATUS_OK;
     } catch (...) {
         return handle_exception(ctx, std::current_exception());
@@ -377,16 +648,10 @@ int attribute(
             outs[i] = static_cast< char* >(out) + offset;
         }
 
-        cppapi::fetch_subvolume(
+        cppapi::parallel_attributes(
             *datahandle,
             *src_subvolume,
             interpolation_method,
-            from,
-            to
-        );
-
-        cppapi::attributes(
-            *src_subvolume,
             &dst_segment_blueprint,
             attributes,
             nattributes,
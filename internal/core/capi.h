@@ -1,6 +1,8 @@
 #ifndef ONESEISMIC_API_CAPI_H
 #define ONESEISMIC_API_CAPI_H
 
+#include <stdint.h>
+
 #include "ctypes.h"
 
 #ifdef __cplusplus
@@ -64,6 +66,140 @@ int double_datahandle_new(
 
 int datahandle_free(Context* ctx, DataHandle* f);
 
+/** Configure the process-wide datahandle pool
+ *
+ * The pool keeps opened VDS handles around between requests, keyed by url and
+ * credentials. A capacity of 0 (the default) disables the pool. Entries that
+ * are not checked out are closed once they have been idle for idle_ttl
+ * seconds.
+ *
+ * Note that the pool does not validate credentials when it hands out an
+ * already opened handle. The caller must do so for every request.
+ */
+int datahandle_pool_configure(
+    Context* ctx,
+    size_t capacity,
+    size_t idle_ttl
+);
+
+/** Checkout a datahandle from the pool
+ *
+ * Behaves as single_datahandle_new, except that the VDS is only opened if no
+ * pooled handle exists for the url and credentials. The returned handle must
+ * be given back to the pool by datahandle_return().
+ *
+ * pooled is set to 1 if the handle was taken from the pool, in which case the
+ * credentials have not been validated, and to 0 otherwise. pooled may be NULL.
+ */
+int single_datahandle_checkout(
+    Context* ctx,
+    const char* url,
+    const char* credentials,
+    DataHandle** ds_out,
+    int* pooled
+);
+
+/** Checkout a double datahandle, with both cubes taken from the pool
+ *
+ * The returned handle must be given back to the pool by datahandle_return().
+ * pooled_A and pooled_B are set as pooled of single_datahandle_checkout, for
+ * either cube.
+ */
+int double_datahandle_checkout(
+    Context* ctx,
+    const char* url_A,
+    const char* credentials_A,
+    const char* url_B,
+    const char* credentials_B,
+    enum binary_operator bin_operator,
+    DataHandle** ds_out,
+    int* pooled_A,
+    int* pooled_B
+);
+
+/** Return a checked out datahandle to the pool */
+int datahandle_return(Context* ctx, DataHandle* ds);
+
+/** Configure how many concurrent requests a subcube read is split into
+ *
+ * Large subcubes, e.g. time slices, are split along brick boundaries and read
+ * with up to max_requests concurrent requests. 1 disables splitting. The
+ * library defaults to 1, the server to 4.
+ */
+int subcube_requests_configure(Context* ctx, size_t max_requests);
+
+/** Configure when fences are read in locality order
+ *
+ * Fences with at least min_points points have their traces read brick by
+ * brick, along a Morton curve over inline and crossline, rather than in the
+ * order of the points. The response is in the order of the points either
+ * way. 0 (the default) disables sorting.
+ */
+int fence_sorting_configure(Context* ctx, size_t min_points);
+
+/** Configure when fence points share a trace
+ *
+ * Every distinct trace of a fence is only read once, and copied to all the
+ * points that share it. With nearest interpolation points within the same
+ * voxel share a trace. With the other interpolation methods points share a
+ * trace when their sample positions round to the same multiple of epsilon,
+ * in voxels. 0 (the default) only merges points at exactly the same position.
+ */
+int fence_deduplication_configure(Context* ctx, float epsilon);
+
+/** Configure whether subvolumes are read as trace windows
+ *
+ * When enabled (non-zero), the segments of surface bounded subvolumes that
+ * are aligned with the samples are read as windows of laterally interpolated
+ * traces rather than sample by sample. Trace requests fetch the full traces,
+ * so this pays off when the segments cover a good part of the traces.
+ * Disabled by default.
+ */
+int subvolume_trace_reads_configure(Context* ctx, int enabled);
+
+/** Configure the memory budget of attribute calculations
+ *
+ * Attributes are fetched, resampled and reduced tile by tile, and every tile
+ * is released before the next is fetched. budget is the max bytes of seismic
+ * data, and the buffers it is fetched through, held by all concurrent
+ * attribute calculations at once. 0 (the default)
+ * is unlimited, in which case every call to attribute is a single tile.
+ */
+int attribute_memory_configure(Context* ctx, size_t budget);
+
+/** Configure how many attribute tiles are fetched ahead
+ *
+ * Up to depth tiles are fetched in the background while the current tile is
+ * resampled and reduced, so that I/O and computation overlap. 0 (the default)
+ * fetches and computes one tile at a time.
+ */
+int attribute_prefetch_configure(Context* ctx, size_t depth);
+
+/** Configure the process-wide cache of decoded chunks
+ *
+ * The cache keeps decoded chunks between requests, so that reads that overlap
+ * earlier reads, e.g. neighbouring slices, don't have to fetch and decode the
+ * same chunks again. capacity is the max total size of the cached chunks in
+ * bytes. A capacity of 0 (the default) disables the cache.
+ *
+ * Chunks are only served to reads through a handle to the same VDS, so the
+ * credentials are validated the same way as without the cache.
+ */
+int chunk_cache_configure(Context* ctx, size_t capacity);
+
+struct ChunkCacheStatistics {
+    /* Number of chunks found in the cache */
+    uint64_t hits;
+    /* Number of chunks that had to be read from the VDS */
+    uint64_t misses;
+    /* Total size of the cached chunks in bytes */
+    size_t size;
+    /* Number of cached chunks */
+    size_t entries;
+};
+
+int chunk_cache_statistics(Context* ctx, struct ChunkCacheStatistics* out);
+
 struct RegularSurface;
 typedef struct RegularSurface RegularSurface;
 
@@ -89,6 +225,11 @@ int regular_surface_free(
 struct SurfaceBoundedSubVolume;
 typedef struct SurfaceBoundedSubVolume SurfaceBoundedSubVolume;
 
+/** The layout of the samples between the top and bottom surfaces
+ *
+ * The subvolume has no storage for the samples themselves. They are fetched
+ * tile by tile by attribute, see attribute_memory_configure.
+ */
 int subvolume_new(
     Context* ctx,
     DataHandle* datahandle,
@@ -98,6 +239,21 @@ int subvolume_new(
     SurfaceBoundedSubVolume** out
 );
 
+/** The layout of the samples from above to below the reference surface
+ *
+ * As subvolume_new, with top and bottom at constant distances above and below
+ * the reference. The bounds are derived from the reference, so only the
+ * reference surface has to be created.
+ */
+int subvolume_window_new(
+    Context* ctx,
+    DataHandle* datahandle,
+    RegularSurface* reference,
+    float above,
+    float below,
+    SurfaceBoundedSubVolume** out
+);
+
 int subvolume_free(
     Context* ctx,
     SurfaceBoundedSubVolume* subvolume
@@ -109,6 +265,15 @@ int metadata(
     response* out
 );
 
+/** Fetch a slice
+ *
+ * lod may be NULL, in which case the slice is read at full resolution.
+ *
+ * The samples are encoded in encoding->format. For the scaled integer formats
+ * the scale and offset of the response are written back to encoding, and
+ * should be passed on to slice_metadata. encoding may be NULL, in which case
+ * the samples are returned as 32-bit floats.
+ */
 int slice(
     Context* ctx,
     DataHandle* datahandle,
@@ -116,6 +281,35 @@ int slice(
     enum axis_name direction,
     struct Bound* bounds,
     size_t nbounds,
+    const struct LevelOfDetail* lod,
+    struct SampleEncoding* encoding,
+    response* out
+);
+
+/** Fetch several slices in one call
+ *
+ * All slices share bounds and level of detail (lod may be NULL). Slices along
+ * the same direction that fall within the same brick are read together, so
+ * the chunks they share are only fetched and decoded once.
+ *
+ * The slices are written back to back to out, in the order they are given.
+ * Slice i starts offsets[i] bytes into out->data, and offsets[nslices] is the
+ * total size. offsets must have room for nslices + 1 elements.
+ *
+ * encodings is either NULL, in which case the samples are returned as 32-bit
+ * floats, or points to nslices encodings, one per slice. The scale and offset
+ * of every slice are written back to its encoding.
+ */
+int slice_batch(
+    Context* ctx,
+    DataHandle* datahandle,
+    const struct SliceLine* slices,
+    size_t nslices,
+    struct Bound* bounds,
+    size_t nbounds,
+    const struct LevelOfDetail* lod,
+    struct SampleEncoding* encodings,
+    size_t* offsets,
     response* out
 );
 
@@ -126,9 +320,20 @@ int slice_metadata(
     enum axis_name direction,
     struct Bound* bounds,
     size_t nbounds,
+    const struct LevelOfDetail* lod,
+    const struct SampleEncoding* encoding,
     response* out
 );
 
+/** Fetch a fence
+ *
+ * The samples are encoded like for slice.
+ *
+ * sample_window optionally restricts the traces to a vertical window, given
+ * as an inclusive bound along the sample axis (time, depth, sample or k).
+ * Only the chunks within the window are read. nullptr returns full traces.
+ * The same window should be passed to fence_metadata.
+ */
 int fence(
     Context* ctx,
     DataHandle* datahandle,
@@ -136,7 +341,9 @@ int fence(
     const float* points,
     size_t npoints,
     enum interpolation_method interpolation_method,
+    const struct Bound* sample_window,
     const float* fillValue,
+    struct SampleEncoding* encoding,
     response* out
 );
 
@@ -144,6 +351,8 @@ int fence_metadata(
     Context* ctx,
     DataHandle* datahandle,
     size_t npoints,
+    const struct Bound* sample_window,
+    const struct SampleEncoding* encoding,
     response* out
 );
 
@@ -157,6 +366,10 @@ int attribute_metadata(
 
 /** Attribute calculation
 *
+* The segments [from, to) are computed in parallel on an internal thread pool
+* sized to the cpu quota of the process, so a single call should cover the
+* whole surface.
+*
 * Output buffer
 * -------------
 *
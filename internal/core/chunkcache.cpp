@@ -0,0 +1,131 @@
+#include "chunkcache.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace {
+
+std::size_t chunk_bytes(ChunkCache::Chunk const& chunk) noexcept (true) {
+    return chunk->size() * sizeof(float);
+}
+
+} /* namespace */
+
+bool ChunkCache::Key::operator==(Key const& other) const noexcept (true) {
+    return this->chunk == other.chunk
+        and this->lod == other.lod
+        and this->vds == other.vds;
+}
+
+std::size_t ChunkCache::KeyHash::operator()(Key const& key) const noexcept (true) {
+    std::size_t hash = std::hash< std::string >()(key.vds);
+    hash ^= std::hash< std::int64_t >()(key.chunk) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash< int >()(key.lod) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+ChunkCache& ChunkCache::instance() noexcept (true) {
+    static ChunkCache cache;
+    return cache;
+}
+
+void ChunkCache::configure(std::size_t capacity) noexcept (true) {
+    this->m_capacity.store(capacity);
+
+    std::size_t const per_shard = this->shard_capacity();
+    for (auto& shard : this->m_shards) {
+        std::lock_guard< std::mutex > lock(shard.mutex);
+        shard.evict(per_shard);
+    }
+}
+
+bool ChunkCache::enabled() const noexcept (true) {
+    return this->m_capacity.load() > 0;
+}
+
+std::size_t ChunkCache::capacity() const noexcept (true) {
+    return this->m_capacity.load();
+}
+
+std::size_t ChunkCache::max_chunk_size() const noexcept (true) {
+    return this->shard_capacity();
+}
+
+ChunkCache::Chunk ChunkCache::get(Key const& key) noexcept (false) {
+    Shard& shard = this->shard(key);
+    {
+        std::lock_guard< std::mutex > lock(shard.mutex);
+        auto hit = shard.index.find(key);
+        if (hit != shard.index.end()) {
+            auto entry = hit->second;
+            shard.entries.splice(shard.entries.begin(), shard.entries, entry);
+            ++this->m_hits;
+            return entry->chunk;
+        }
+    }
+
+    ++this->m_misses;
+    return nullptr;
+}
+
+void ChunkCache::put(Key const& key, Chunk chunk) noexcept (false) {
+    std::size_t const capacity = this->shard_capacity();
+    std::size_t const size     = chunk_bytes(chunk);
+    if (size > capacity) return;
+
+    Shard& shard = this->shard(key);
+    std::lock_guard< std::mutex > lock(shard.mutex);
+
+    /*
+     * Concurrent readers that missed on the same chunk all read and insert
+     * it. The chunks are identical, so keep the one already cached.
+     */
+    if (shard.index.count(key) != 0) return;
+
+    shard.evict(capacity - size);
+    shard.entries.push_front(Entry{ key, std::move(chunk) });
+    shard.index.emplace(key, shard.entries.begin());
+    shard.size += size;
+}
+
+void ChunkCache::clear() noexcept (true) {
+    for (auto& shard : this->m_shards) {
+        std::lock_guard< std::mutex > lock(shard.mutex);
+        shard.evict(0);
+    }
+}
+
+ChunkCache::Statistics ChunkCache::statistics() const noexcept (true) {
+    Statistics statistics{ this->m_hits.load(), this->m_misses.load(), 0, 0 };
+    for (auto const& shard : this->m_shards) {
+        std::lock_guard< std::mutex > lock(shard.mutex);
+        statistics.size    += shard.size;
+        statistics.entries += shard.entries.size();
+    }
+    return statistics;
+}
+
+void ChunkCache::reset_statistics() noexcept (true) {
+    this->m_hits.store(0);
+    this->m_misses.store(0);
+}
+
+ChunkCache::Shard& ChunkCache::shard(Key const& key) noexcept (true) {
+    return this->m_shards[KeyHash()(key) % nshards];
+}
+
+std::size_t ChunkCache::shard_capacity() const noexcept (true) {
+    return this->m_capacity.load() / nshards;
+}
+
+void ChunkCache::Shard::evict(std::size_t capacity) noexcept (true) {
+    while (this->size > capacity) {
+        auto& entry = this->entries.back();
+        this->size -= chunk_bytes(entry.chunk);
+        this->index.erase(entry.key);
+        this->entries.pop_back();
+    }
+}
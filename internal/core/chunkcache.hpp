@@ -0,0 +1,123 @@
+#ifndef ONESEISMIC_API_CHUNKCACHE_HPP
+#define ONESEISMIC_API_CHUNKCACHE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Process-wide cache of decoded chunks.
+ *
+ * OpenVDS fetches and decompresses whole chunks (bricks), even when only a
+ * single slice through them is requested. Its own cache lives in the access
+ * manager of a handle, so decoded chunks are thrown away with the handle. The
+ * chunk cache keeps them around between requests, so that e.g. neighbouring
+ * inline slices, which share the same chunks, only fetch and decode them once.
+ *
+ * Chunks are keyed by VDS identity, level of detail and chunk index. The
+ * identity is derived from the url and storage account, and chunks are only
+ * read through handles to that VDS, so they are never served to requests
+ * that could not open the VDS themselves. Chunks are stored as 32-bit floats.
+ *
+ * The cache is bounded by the total size of the chunks in bytes. It is split
+ * into shards, each with its own lock and least recently used list, so that
+ * concurrent requests rarely contend for the same lock. The capacity is split
+ * evenly between the shards.
+ *
+ * The cache is disabled (capacity 0) by default.
+ */
+class ChunkCache {
+public:
+    struct Key {
+        std::string  vds;
+        int          lod;
+        std::int64_t chunk;
+
+        bool operator==(Key const& other) const noexcept (true);
+    };
+
+    using Chunk = std::shared_ptr< std::vector< float > const >;
+
+    struct Statistics {
+        std::uint64_t hits;
+        std::uint64_t misses;
+        /* Total size of the cached chunks in bytes */
+        std::size_t   size;
+        std::size_t   entries;
+    };
+
+    static ChunkCache& instance() noexcept (true);
+
+    /**
+     * @param capacity Max total size of the cached chunks in bytes. 0
+     * disables the cache and drops all cached chunks.
+     */
+    void configure(std::size_t capacity) noexcept (true);
+
+    bool enabled() const noexcept (true);
+
+    /** Max total size of the cached chunks in bytes */
+    std::size_t capacity() const noexcept (true);
+
+    /** Max size in bytes of a single chunk that can be cached */
+    std::size_t max_chunk_size() const noexcept (true);
+
+    /** The cached chunk, or nullptr on a miss */
+    Chunk get(Key const& key) noexcept (false);
+
+    /**
+     * Insert a chunk, evicting the least recently used chunks of its shard to
+     * make room. Chunks larger than the capacity of a shard are not cached.
+     */
+    void put(Key const& key, Chunk chunk) noexcept (false);
+
+    /** Drop all cached chunks. Chunks in use by readers stay valid. */
+    void clear() noexcept (true);
+
+    Statistics statistics() const noexcept (true);
+
+    /** Reset the hit and miss counters */
+    void reset_statistics() noexcept (true);
+
+private:
+    ChunkCache() = default;
+
+    struct KeyHash {
+        std::size_t operator()(Key const& key) const noexcept (true);
+    };
+
+    struct Entry {
+        Key   key;
+        Chunk chunk;
+    };
+
+    struct Shard {
+        /* Entries in most recently used order */
+        std::list< Entry > entries;
+        std::unordered_map< Key, std::list< Entry >::iterator, KeyHash > index;
+        std::size_t size = 0;
+        mutable std::mutex mutex;
+
+        void evict(std::size_t capacity) noexcept (true);
+    };
+
+    static constexpr std::size_t nshards = 16;
+
+    Shard& shard(Key const& key) noexcept (true);
+    std::size_t shard_capacity() const noexcept (true);
+
+    std::array< Shard, nshards > m_shards;
+
+    std::atomic< std::size_t >   m_capacity{ 0 };
+    std::atomic< std::uint64_t > m_hits{ 0 };
+    std::atomic< std::uint64_t > m_misses{ 0 };
+};
+
+#endif /* ONESEISMIC_API_CHUNKCACHE_HPP */
@@ -0,0 +1,316 @@
+#include "coordinate_transformer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define ONESEISMIC_API_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
+#include "axis.hpp"
+#include "binaryoperator.hpp"
+#include "ctypes.h"
+#include "regularsurface.hpp"
+
+namespace {
+
+using Coefficients = HorizontalTransform::Coefficients;
+
+/*
+ * The kernels evaluate the same expression in the same order, with separate
+ * multiplications and additions rather than fused ones, so that all
+ * instruction sets produce the exact same sample positions. Otherwise a point
+ * close to the middle of two traces could snap to different traces depending
+ * on the machine. This file is built with -ffp-contract=off (see
+ * CMakeLists.txt and the cgo flags in core.go) so that the compiler does not
+ * fuse them either.
+ */
+void scalar_kernel(
+    Coefficients const& c,
+    double const*       x,
+    double const*       y,
+    std::size_t         n,
+    double*             iline,
+    double*             xline
+) noexcept (true) {
+    for (std::size_t i = 0; i < n; ++i) {
+        double const dx = x[i] - c.x0;
+        double const dy = y[i] - c.y0;
+        iline[i] = (c.offset[0] + c.dx[0] * dx + c.dy[0] * dy) / c.stepsize[0] + 0.5;
+        xline[i] = (c.offset[1] + c.dx[1] * dx + c.dy[1] * dy) / c.stepsize[1] + 0.5;
+    }
+}
+
+#ifdef ONESEISMIC_API_X86_KERNELS
+
+__attribute__((target("sse2")))
+__m128d sse2_position(
+    Coefficients const& c,
+    int                 d,
+    __m128d             dx,
+    __m128d             dy
+) noexcept (true) {
+    __m128d annotation = _mm_add_pd(
+        _mm_set1_pd(c.offset[d]),
+        _mm_mul_pd(_mm_set1_pd(c.dx[d]), dx)
+    );
+    annotation = _mm_add_pd(annotation, _mm_mul_pd(_mm_set1_pd(c.dy[d]), dy));
+    annotation = _mm_div_pd(annotation, _mm_set1_pd(c.stepsize[d]));
+    return _mm_add_pd(annotation, _mm_set1_pd(0.5));
+}
+
+__attribute__((target("sse2")))
+void sse2_kernel(
+    Coefficients const& c,
+    double const*       x,
+    double const*       y,
+    std::size_t         n,
+    double*             iline,
+    double*             xline
+) noexcept (true) {
+    __m128d const x0 = _mm_set1_pd(c.x0);
+    __m128d const y0 = _mm_set1_pd(c.y0);
+
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d const dx = _mm_sub_pd(_mm_loadu_pd(x + i), x0);
+        __m128d const dy = _mm_sub_pd(_mm_loadu_pd(y + i), y0);
+        _mm_storeu_pd(iline + i, sse2_position(c, 0, dx, dy));
+        _mm_storeu_pd(xline + i, sse2_position(c, 1, dx, dy));
+    }
+    scalar_kernel(c, x + i, y + i, n - i, iline + i, xline + i);
+}
+
+__attribute__((target("avx2")))
+__m256d avx2_position(
+    Coefficients const& c,
+    int                 d,
+    __m256d             dx,
+    __m256d             dy
+) noexcept (true) {
+    __m256d annotation = _mm256_add_pd(
+        _mm256_set1_pd(c.offset[d]),
+        _mm256_mul_pd(_mm256_set1_pd(c.dx[d]), dx)
+    );
+    annotation = _mm256_add_pd(annotation, _mm256_mul_pd(_mm256_set1_pd(c.dy[d]), dy));
+    annotation = _mm256_div_pd(annotation, _mm256_set1_pd(c.stepsize[d]));
+    return _mm256_add_pd(annotation, _mm256_set1_pd(0.5));
+}
+
+__attribute__((target("avx2")))
+void avx2_kernel(
+    Coefficients const& c,
+    double const*       x,
+    double const*       y,
+    std::size_t         n,
+    double*             iline,
+    double*             xline
+) noexcept (true) {
+    __m256d const x0 = _mm256_set1_pd(c.x0);
+    __m256d const y0 = _mm256_set1_pd(c.y0);
+
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d const dx = _mm256_sub_pd(_mm256_loadu_pd(x + i), x0);
+        __m256d const dy = _mm256_sub_pd(_mm256_loadu_pd(y + i), y0);
+        _mm256_storeu_pd(iline + i, avx2_position(c, 0, dx, dy));
+        _mm256_storeu_pd(xline + i, avx2_position(c, 1, dx, dy));
+    }
+    scalar_kernel(c, x + i, y + i, n - i, iline + i, xline + i);
+}
+
+__attribute__((target("avx512f")))
+__m512d avx512_position(
+    Coefficients const& c,
+    int                 d,
+    __m512d             dx,
+    __m512d             dy
+) noexcept (true) {
+    __m512d annotation = _mm512_add_pd(
+        _mm512_set1_pd(c.offset[d]),
+        _mm512_mul_pd(_mm512_set1_pd(c.dx[d]), dx)
+    );
+    annotation = _mm512_add_pd(annotation, _mm512_mul_pd(_mm512_set1_pd(c.dy[d]), dy));
+    annotation = _mm512_div_pd(annotation, _mm512_set1_pd(c.stepsize[d]));
+    return _mm512_add_pd(annotation, _mm512_set1_pd(0.5));
+}
+
+__attribute__((target("avx512f")))
+void avx512_kernel(
+    Coefficients const& c,
+    double const*       x,
+    double const*       y,
+    std::size_t         n,
+    double*             iline,
+    double*             xline
+) noexcept (true) {
+    __m512d const x0 = _mm512_set1_pd(c.x0);
+    __m512d const y0 = _mm512_set1_pd(c.y0);
+
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d const dx = _mm512_sub_pd(_mm512_loadu_pd(x + i), x0);
+        __m512d const dy = _mm512_sub_pd(_mm512_loadu_pd(y + i), y0);
+        _mm512_storeu_pd(iline + i, avx512_position(c, 0, dx, dy));
+        _mm512_storeu_pd(xline + i, avx512_position(c, 1, dx, dy));
+    }
+    scalar_kernel(c, x + i, y + i, n - i, iline + i, xline + i);
+}
+
+#endif /* ONESEISMIC_API_X86_KERNELS */
+
+/* Annotation of the horizontal position (x, y) in the coordinate system */
+OpenVDS::DoubleVector3 to_annotation(
+    CoordinateTransformer const& transformer,
+    enum coordinate_system system,
+    double x,
+    double y
+) noexcept (false) {
+    switch (system) {
+        case INDEX:
+            return transformer.IJKPositionToAnnotation({x, y, 0});
+        case ANNOTATION:
+            return OpenVDS::DoubleVector3 {x, y, 0};
+        case CDP:
+            return transformer.WorldToAnnotation({x, y, 0});
+        default: {
+            throw std::runtime_error("Unhandled coordinate system");
+        }
+    }
+}
+
+} /* namespace */
+
+HorizontalTransform CoordinateTransformer::horizontal_transform(
+    enum coordinate_system system,
+    Axis const& iline,
+    Axis const& xline
+) const noexcept (false) {
+    return HorizontalTransform(*this, system, iline, xline);
+}
+
+HorizontalTransform::HorizontalTransform(
+    CoordinateTransformer const& transformer,
+    enum coordinate_system system,
+    Axis const& iline,
+    Axis const& xline
+) : m_nsamples{ iline.nsamples(), xline.nsamples() } {
+    Coefficients& c = this->m_coefficients;
+
+    /*
+     * World coordinates are typically far from the origin, so the transform
+     * is sampled around the origin of the survey instead
+     */
+    c.x0 = 0;
+    c.y0 = 0;
+    if (system == CDP) {
+        auto const origin = transformer.IJKIndexToWorld({0, 0, 0});
+        c.x0 = origin[0];
+        c.y0 = origin[1];
+    }
+
+    auto const reference = ::to_annotation(transformer, system, c.x0,     c.y0);
+    auto const along_x   = ::to_annotation(transformer, system, c.x0 + 1, c.y0);
+    auto const along_y   = ::to_annotation(transformer, system, c.x0,     c.y0 + 1);
+
+    Axis const* axes[] = { &iline, &xline };
+    for (int d = 0; d < 2; ++d) {
+        c.offset[d]   = reference[d] - axes[d]->min();
+        c.dx[d]       = along_x[d] - reference[d];
+        c.dy[d]       = along_y[d] - reference[d];
+        c.stepsize[d] = axes[d]->stepsize();
+    }
+}
+
+void HorizontalTransform::to_sample_positions(
+    double const* x,
+    double const* y,
+    std::size_t n,
+    double* iline,
+    double* xline
+) const noexcept (true) {
+    switch (simd_level()) {
+#ifdef ONESEISMIC_API_X86_KERNELS
+        case SimdLevel::AVX512:
+            return avx512_kernel(this->m_coefficients, x, y, n, iline, xline);
+        case SimdLevel::AVX2:
+            return avx2_kernel(this->m_coefficients, x, y, n, iline, xline);
+        case SimdLevel::SSE2:
+            return sse2_kernel(this->m_coefficients, x, y, n, iline, xline);
+#endif
+        default:
+            return scalar_kernel(this->m_coefficients, x, y, n, iline, xline);
+    }
+}
+
+void HorizontalTransform::to_sample_positions(
+    double const* x,
+    double const* y,
+    std::size_t n,
+    double* iline,
+    double* xline,
+    SimdLevel level
+) const noexcept (false) {
+    if (level > simd_level()) {
+        throw std::invalid_argument("Instruction set not supported by the cpu");
+    }
+
+    switch (level) {
+#ifdef ONESEISMIC_API_X86_KERNELS
+        case SimdLevel::AVX512:
+            return avx512_kernel(this->m_coefficients, x, y, n, iline, xline);
+        case SimdLevel::AVX2:
+            return avx2_kernel(this->m_coefficients, x, y, n, iline, xline);
+        case SimdLevel::SSE2:
+            return sse2_kernel(this->m_coefficients, x, y, n, iline, xline);
+#endif
+        case SimdLevel::SCALAR:
+            return scalar_kernel(this->m_coefficients, x, y, n, iline, xline);
+        default: {
+            throw std::invalid_argument("Unhandled instruction set");
+        }
+    }
+}
+
+bool HorizontalTransform::inrange_with_margin(
+    int axis,
+    double position
+) const noexcept (true) {
+    return 0 <= position and position < this->m_nsamples[axis];
+}
+
+GridSamplePositions::GridSamplePositions(
+    HorizontalTransform const& transform,
+    BoundedGrid const& grid
+) : m_transform(transform),
+    m_grid(grid),
+    m_x(block_size),
+    m_y(block_size),
+    m_iline(block_size),
+    m_xline(block_size)
+{}
+
+std::pair< double, double > GridSamplePositions::at(std::size_t i) noexcept (false) {
+    if (i < this->m_first or i >= this->m_first + this->m_size) {
+        this->m_first = i;
+        this->m_size  = std::min(block_size, this->m_grid.size() - i);
+        for (std::size_t j = 0; j < this->m_size; ++j) {
+            auto const cdp = this->m_grid.to_cdp(i + j);
+            this->m_x[j] = cdp.x;
+            this->m_y[j] = cdp.y;
+        }
+        this->m_transform.to_sample_positions(
+            this->m_x.data(),
+            this->m_y.data(),
+            this->m_size,
+            this->m_iline.data(),
+            this->m_xline.data()
+        );
+    }
+
+    std::size_t const j = i - this->m_first;
+    return { this->m_iline[j], this->m_xline[j] };
+}
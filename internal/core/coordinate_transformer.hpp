@@ -1,12 +1,33 @@
 #ifndef ONESEISMIC_API_COORDINATE_TRANSFORMER_HPP
 #define ONESEISMIC_API_COORDINATE_TRANSFORMER_HPP
 
+#include <cstddef>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 #include <OpenVDS/IJKCoordinateTransformer.h>
 
+#include "axis.hpp"
+#include "binaryoperator.hpp"
+#include "ctypes.h"
+#include "regularsurface.hpp"
+
+class HorizontalTransform;
+
 class CoordinateTransformer {
 public:
+    /**
+     * Batched transform from horizontal positions in the given coordinate
+     * system to sample positions along iline and xline. See
+     * HorizontalTransform.
+     */
+    HorizontalTransform horizontal_transform(
+        enum coordinate_system system,
+        Axis const& iline,
+        Axis const& xline
+    ) const noexcept (false);
+
     virtual OpenVDS::IntVector3 VoxelIndexToIJKIndex(const OpenVDS::IntVector3& voxelIndex) const = 0;
 
     virtual OpenVDS::DoubleVector3 IJKIndexToWorld(const OpenVDS::IntVector3& ijkIndex) const = 0;
@@ -172,4 +193,109 @@ private:
     OpenVDS::IntVector3 m_intersection_zero_as_cube_b_index;
 };
 
+/**
+ * Transform from horizontal (x, y) positions to voxel sample positions along
+ * the inline and crossline axes, for many points at a time.
+ *
+ * Going through the coordinate transformer and Axis::to_sample_position costs
+ * several virtual calls per point, which adds up for fences and surfaces with
+ * millions of points. Both steps are affine, so the transform is sampled once
+ * from the coordinate transformer on construction, and then applied to arrays
+ * of x and y with vectorized kernels.
+ *
+ * The annotation is computed relative to a reference point close to the
+ * survey, so that large world coordinates don't lose precision, and the
+ * sample position as (annotation - min) / stepsize + 0.5. For index and
+ * annotation input the transform is exact for positions on the grid and
+ * halfway between lines, so that nearest interpolation rounds half up.
+ */
+class HorizontalTransform {
+public:
+    HorizontalTransform(
+        CoordinateTransformer const& transformer,
+        enum coordinate_system system,
+        Axis const& iline,
+        Axis const& xline
+    ) noexcept (false);
+
+    /**
+     * Transform n points, given as separate arrays of x and y, to sample
+     * positions. iline and xline must have room for n values.
+     */
+    void to_sample_positions(
+        double const* x,
+        double const* y,
+        std::size_t n,
+        double* iline,
+        double* xline
+    ) const noexcept (true);
+
+    /** As above, with the kernel for the given instruction set */
+    void to_sample_positions(
+        double const* x,
+        double const* y,
+        std::size_t n,
+        double* iline,
+        double* xline,
+        SimdLevel level
+    ) const noexcept (false);
+
+    /**
+     * Whether the sample position along iline (axis 0) or xline (axis 1) is
+     * inside the survey, allowing for half a sample outside the first and
+     * last line. Matches Axis::inrange_with_margin for the corresponding
+     * annotation.
+     */
+    bool inrange_with_margin(
+        int axis,
+        double position
+    ) const noexcept (true);
+
+    struct Coefficients {
+        /* Reference point */
+        double x0;
+        double y0;
+        /* Annotation - min at the reference point */
+        double offset[2];
+        /* Annotation per unit of x and y */
+        double dx[2];
+        double dy[2];
+        double stepsize[2];
+    };
+
+private:
+    Coefficients m_coefficients;
+    int m_nsamples[2];
+};
+
+/**
+ * Sample positions of the cells of a grid, computed a block of cells at a
+ * time. Cells are meant to be visited in increasing order, as a new block is
+ * computed whenever a cell outside the current one is asked for.
+ */
+class GridSamplePositions {
+public:
+    GridSamplePositions(
+        HorizontalTransform const& transform,
+        BoundedGrid const& grid
+    ) noexcept (false);
+
+    /** Sample positions {iline, xline} of cell i */
+    std::pair< double, double > at(std::size_t i) noexcept (false);
+
+private:
+    static constexpr std::size_t block_size = 1024;
+
+    HorizontalTransform const& m_transform;
+    BoundedGrid const& m_grid;
+
+    /* The block starts at cell m_first and holds m_size cells */
+    std::size_t m_first = 0;
+    std::size_t m_size  = 0;
+    std::vector< double > m_x;
+    std::vector< double > m_y;
+    std::vector< double > m_iline;
+    std::vector< double > m_xline;
+};
+
 #endif /* ONESEISMIC_API_COORDINATE_TRANSFORMER */
@@ -2,7 +2,7 @@ package core
 
 /*
 #cgo LDFLAGS: -lopenvds
-#cgo CXXFLAGS: -std=c++17
+#cgo CXXFLAGS: -std=c++17 -ffp-contract=off
 #include <capi.h>
 #include <ctypes.h>
 #include <stdlib.h>
@@ -12,6 +12,7 @@ import (
 	"errors"
 	"fmt"
 	"strings"
+	"time"
 	"unsafe"
 )
 
@@ -41,6 +42,13 @@ const (
 	BinaryOperatorDivision        = C.DIVISION
 )
 
+const (
+	SampleFormatFloat32 = C.FLOAT32
+	SampleFormatFloat16 = C.FLOAT16
+	SampleFormatInt16   = C.INT16
+	SampleFormatInt8    = C.INT8
+)
+
 // @Description Axis description
 type Axis struct {
 	// Name/Annotation of axis
@@ -102,10 +110,20 @@ type BoundingBox struct {
 } //@name BoundingBox
 
 type Array struct {
-	// Data format is represented by numpy-style format codes. Currently the
-	// format is always 4-byte floats, little endian (<f4).
+	// Data format is represented by numpy-style format codes. By default the
+	// format is 4-byte floats, little endian (<f4). Depending on the
+	// requested sampleFormat the data may instead be 2-byte floats (<f2), or
+	// scaled 2-byte (<i2) or 1-byte (|i1) integers.
 	Format string `json:"format" example:"<f4"`
 
+	// Scale of the integer formats. Samples decode as
+	// offset + scale * sample, except for the lowest value of the type
+	// (-32768 or -128) which marks samples without a value.
+	Scale *float32 `json:"scale,omitempty" example:"0.015"`
+
+	// Offset of the integer formats, see Scale
+	Offset *float32 `json:"offset,omitempty" example:"-1.5"`
+
 	// Shape of the returned data
 	Shape []int `json:"shape" swaggertype:"array,integer" example:"10,50"`
 }
@@ -123,6 +141,49 @@ type Bound struct {
 	Upper *int `json:"upper" binding:"required" example:"200"`
 } // @name SliceBound
 
+/** Level of detail (LOD) of a slice
+ *
+ * Level 0 is full resolution and every following level halves the
+ * resolution in all dimensions. A negative Level picks the level
+ * automatically, as the coarsest one at which the longest side of the slice
+ * still has at least TargetSize samples.
+ */
+type LevelOfDetail struct {
+	Level      int
+	TargetSize int
+}
+
+/** Encoding of the samples in a response
+ *
+ * Format is one of the SampleFormat constants. For the scaled integer
+ * formats Scale and Offset are computed when the data is fetched, and must
+ * be passed on when fetching the metadata of the same response.
+ */
+type SampleEncoding struct {
+	Format int
+	Scale  float32
+	Offset float32
+}
+
+func newCSampleEncoding(encoding *SampleEncoding) *C.struct_SampleEncoding {
+	if encoding == nil {
+		return nil
+	}
+	return &C.struct_SampleEncoding{
+		C.enum_sample_format(encoding.Format),
+		C.float(encoding.Scale),
+		C.float(encoding.Offset),
+	}
+}
+
+func (encoding *SampleEncoding) update(cEncoding *C.struct_SampleEncoding) {
+	if encoding == nil {
+		return
+	}
+	encoding.Scale = float32(cEncoding.scale)
+	encoding.Offset = float32(cEncoding.offset)
+}
+
 // @Description Slice metadata
 type SliceMetadata struct {
 	Array
@@ -138,6 +199,12 @@ type SliceMetadata struct {
 	// Shape of the returned slice. Equals to [Y.Samples, X.Samples]
 	Shape []int `json:"shape" swaggertype:"array,integer" example:"10,50"`
 
+	// Line number of the returned slice, in the coordinate system of the
+	// request. With a level of detail above 0 only every 2^lod line is
+	// stored, and the slice is the stored line at or before the requested
+	// line.
+	Lineno float64 `json:"lineno" example:"1234"`
+
 	// Horizontal bounding box of the slice. For inline/crossline slices this
 	// is a linestring, while for time/depth slices this is a polygon. If the
 	// slice is not cropped, the polygon is the bounding box of the cube.
@@ -254,6 +321,25 @@ func GetInterpolationMethod(interpolation string) (int, error) {
 	}
 }
 
+func GetSampleFormat(format string) (int, error) {
+	switch strings.ToLower(format) {
+	case "":
+		fallthrough
+	case "float32":
+		return SampleFormatFloat32, nil
+	case "float16":
+		return SampleFormatFloat16, nil
+	case "int16":
+		return SampleFormatInt16, nil
+	case "int8":
+		return SampleFormatInt8, nil
+	default:
+		options := "float32, float16, int16 or int8"
+		msg := "invalid sample format '%s', valid options are: %s"
+		return -1, NewInvalidArgument(fmt.Sprintf(msg, format, options))
+	}
+}
+
 func GetAttributeType(attribute string) (int, error) {
 	switch strings.ToLower(attribute) {
 	case "samplevalue":
@@ -443,10 +529,189 @@ func (v DSHandle) Error(status C.int) error {
 func (v DSHandle) Close() error {
 	defer C.context_free(v.ctx)
 
-	cerr := C.datahandle_free(v.ctx, v.dataHandle)
+	cerr := C.datahandle_return(v.ctx, v.dataHandle)
 	return toError(cerr, v.ctx)
 }
 
+/** Configure the process-wide pool of opened VDS handles
+ *
+ * With a non-zero capacity, handles are kept open between requests and
+ * reused by requests to the same VDS with the same credentials. Handles that
+ * have not been in use for idleTTL are closed.
+ */
+func ConfigureHandlePool(capacity uint64, idleTTL time.Duration) error {
+	var cctx = C.context_new()
+	defer C.context_free(cctx)
+
+	cerr := C.datahandle_pool_configure(
+		cctx,
+		C.size_t(capacity),
+		C.size_t(idleTTL.Seconds()),
+	)
+	return toError(cerr, cctx)
+}
+
+/** Configure max number of concurrent requests per subcube read
+ *
+ * Large subcubes, such as time slices, are split along brick boundaries and
+ * read with up to maxRequests concurrent requests. 1 disables splitting.
+ */
+func ConfigureSubcubeRequests(maxRequests uint64) error {
+	var cctx = C.context_new()
+	defer C.context_free(cctx)
+
+	cerr := C.subcube_requests_configure(cctx, C.size_t(maxRequests))
+	return toError(cerr, cctx)
+}
+
+/** Configure when fences are read in locality order
+ *
+ * Fences with at least minPoints points have their traces read brick by
+ * brick rather than in the order of the points, which makes better use of
+ * the chunks cached by OpenVDS. 0 disables sorting.
+ */
+func ConfigureFenceSorting(minPoints uint64) error {
+	var cctx = C.context_new()
+	defer C.context_free(cctx)
+
+	cerr := C.fence_sorting_configure(cctx, C.size_t(minPoints))
+	return toError(cerr, cctx)
+}
+
+/** Configure when fence points share a trace
+ *
+ * Every distinct trace of a fence is only read once. With nearest
+ * interpolation points in the same voxel share a trace. With the other
+ * interpolation methods points share a trace when their positions round to
+ * the same multiple of epsilon, in voxels. 0 only merges identical points.
+ */
+func ConfigureFenceDeduplication(epsilon float32) error {
+	var cctx = C.context_new()
+	defer C.context_free(cctx)
+
+	cerr := C.fence_deduplication_configure(cctx, C.float(epsilon))
+	return toError(cerr, cctx)
+}
+
+/** Configure whether subvolumes are read as trace windows
+ *
+ * Segments of subvolumes, e.g. for attributes along surfaces, that are aligned
+ * with the samples are read as windows of laterally interpolated traces rather
+ * than sample by sample. Trace requests fetch the full traces, so this pays
+ * off when the segments cover a good part of the traces.
+ */
+func ConfigureSubvolumeTraceReads(enabled bool) error {
+	var cctx = C.context_new()
+	defer C.context_free(cctx)
+
+	var cenabled C.int
+	if enabled {
+		cenabled = 1
+	}
+
+	cerr := C.subvolume_trace_reads_configure(cctx, cenabled)
+	return toError(cerr, cctx)
+}
+
+/** Configure the memory budget of attribute calculations
+ *
+ * Attributes are fetched, resampled and reduced tile by tile, and every tile
+ * is released before the next is fetched. budget is the max total size, in
+ * bytes, of the seismic data held by all concurrent attribute calculations.
+ * 0 is unlimited.
+ */
+func ConfigureAttributeMemory(budget uint64) error {
+	var cctx = C.context_new()
+	defer C.context_free(cctx)
+
+	cerr := C.attribute_memory_configure(cctx, C.size_t(budget))
+	return toError(cerr, cctx)
+}
+
+/** Configure how many attribute tiles are fetched ahead
+ *
+ * Up to depth tiles are fetched in the background while the current tile is
+ * resampled and reduced, so that I/O and computation overlap. 0 fetches and
+ * computes one tile at a time.
+ */
+func ConfigureAttributePrefetch(depth uint64) error {
+	var cctx = C.context_new()
+	defer C.context_free(cctx)
+
+	cerr := C.attribute_prefetch_configure(cctx, C.size_t(depth))
+	return toError(cerr, cctx)
+}
+
+/** Configure the process-wide cache of decoded chunks
+ *
+ * Decoded chunks are kept between requests, so that reads overlapping earlier
+ * reads, e.g. neighbouring slices, don't fetch and decode the same chunks
+ * again. capacity is the max total size of the cached chunks in bytes. 0
+ * disables the cache.
+ */
+func ConfigureChunkCache(capacity uint64) error {
+	var cctx = C.context_new()
+	defer C.context_free(cctx)
+
+	cerr := C.chunk_cache_configure(cctx, C.size_t(capacity))
+	return toError(cerr, cctx)
+}
+
+type ChunkCacheStatistics struct {
+	// Number of chunks found in the cache
+	Hits uint64
+	// Number of chunks that had to be read from the VDS
+	Misses uint64
+	// Total size of the cached chunks in bytes
+	Size uint64
+	// Number of cached chunks
+	Entries uint64
+}
+
+func GetChunkCacheStatistics() (ChunkCacheStatistics, error) {
+	var cctx = C.context_new()
+	defer C.context_free(cctx)
+
+	var statistics C.struct_ChunkCacheStatistics
+	cerr := C.chunk_cache_statistics(cctx, &statistics)
+	if err := toError(cerr, cctx); err != nil {
+		return ChunkCacheStatistics{}, err
+	}
+
+	return ChunkCacheStatistics{
+		Hits:    uint64(statistics.hits),
+		Misses:  uint64(statistics.misses),
+		Size:    uint64(statistics.size),
+		Entries: uint64(statistics.entries),
+	}, nil
+}
+
+/** Validate credentials of the handles taken from the pool
+ *
+ * Opening a VDS validates the credentials as a side effect. A pooled handle
+ * is already opened, so without this check an expired or revoked token would
+ * still be able to read data through a handle opened by an earlier request.
+ * Handles that were opened by this request are not checked again.
+ *
+ * A failed check is reported as a failed open would be.
+ */
+func validatePooledConnections(connections []Connection, pooled []C.int) error {
+	for i, connection := range connections {
+		if pooled[i] == 0 {
+			continue
+		}
+		if !connection.IsAuthorizedToRead() {
+			msg := fmt.Sprintf(
+				"Could not open VDS: not authorized to read '%s' "+
+					"with the provided credentials",
+				connection.Url(),
+			)
+			return NewInternalError(msg)
+		}
+	}
+	return nil
+}
+
 func NewDSHandle(connection Connection) (DSHandle, error) {
 	return CreateDSHandle([]Connection{connection}, BinaryOperatorNoOperator)
 }
@@ -469,6 +734,7 @@ func CreateDSHandle(connections []Connection, operator uint32) (DSHandle, error)
 	var cctx = C.context_new()
 	var dataHandle *C.struct_DataHandle
 	var cerr C.int
+	pooled := make([]C.int, len(connections))
 
 	curlA := C.CString(connections[0].Url())
 	defer C.free(unsafe.Pointer(curlA))
@@ -477,7 +743,7 @@ func CreateDSHandle(connections []Connection, operator uint32) (DSHandle, error)
 	defer C.free(unsafe.Pointer(ccredA))
 
 	if len(connections) == 1 {
-		cerr = C.single_datahandle_new(cctx, curlA, ccredA, &dataHandle)
+		cerr = C.single_datahandle_checkout(cctx, curlA, ccredA, &dataHandle, &pooled[0])
 	} else if len(connections) == 2 {
 		curlB := C.CString(connections[1].Url())
 		defer C.free(unsafe.Pointer(curlB))
@@ -485,7 +751,17 @@ func CreateDSHandle(connections []Connection, operator uint32) (DSHandle, error)
 		ccredB := C.CString(connections[1].ConnectionString())
 		defer C.free(unsafe.Pointer(ccredB))
 
-		cerr = C.double_datahandle_new(cctx, curlA, ccredA, curlB, ccredB, operator, &dataHandle)
+		cerr = C.double_datahandle_checkout(
+			cctx,
+			curlA,
+			ccredA,
+			curlB,
+			ccredB,
+			operator,
+			&dataHandle,
+			&pooled[0],
+			&pooled[1],
+		)
 	}
 
 	if err := toError(cerr, cctx); err != nil {
@@ -493,7 +769,13 @@ func CreateDSHandle(connections []Connection, operator uint32) (DSHandle, error)
 		return DSHandle{}, err
 	}
 
-	return DSHandle{dataHandle: dataHandle, ctx: cctx}, nil
+	handle := DSHandle{dataHandle: dataHandle, ctx: cctx}
+	if err := validatePooledConnections(connections, pooled); err != nil {
+		handle.Close()
+		return DSHandle{}, err
+	}
+
+	return handle, nil
 }
 
 func (v DSHandle) GetMetadata() ([]byte, error) {
@@ -67,31 +67,24 @@ func (v DSHandle) GetAttributesAlongSurface(
 	}
 	defer cReferenceSurface.Close()
 
-	cTopSurfaceData, err := referenceSurface.toCdata(-above)
-	if err != nil {
-		return nil, err
-	}
-
-	cTopSurface, err := referenceSurface.toCRegularSurface(cTopSurfaceData)
-	if err != nil {
-		return nil, err
-	}
-	defer cTopSurface.Close()
-
-	cBottomSurfaceData, err := referenceSurface.toCdata(below)
-	if err != nil {
-		return nil, err
-	}
-	cBottomSurface, err := referenceSurface.toCRegularSurface(cBottomSurfaceData)
-	if err != nil {
-		return nil, err
+	// Top and bottom are derived from the reference by the subvolume, rather
+	// than being copies of the reference surface
+	newSubVolume := func(
+		cCtx *C.struct_Context,
+		out **C.struct_SurfaceBoundedSubVolume,
+	) C.int {
+		return C.subvolume_window_new(
+			cCtx,
+			v.DataHandle(),
+			cReferenceSurface.get(),
+			C.float(above),
+			C.float(below),
+			out,
+		)
 	}
-	defer cBottomSurface.Close()
 
 	return v.getAttributes(
-		cReferenceSurface,
-		cTopSurface,
-		cBottomSurface,
+		newSubVolume,
 		nrows,
 		ncols,
 		targetAttributes,
@@ -168,10 +161,22 @@ func (v DSHandle) GetAttributesBetweenSurfaces(
 		cBottomSurface = cPrimarySurface
 	}
 
+	newSubVolume := func(
+		cCtx *C.struct_Context,
+		out **C.struct_SurfaceBoundedSubVolume,
+	) C.int {
+		return C.subvolume_new(
+			cCtx,
+			v.DataHandle(),
+			cPrimarySurface.get(),
+			cTopSurface.get(),
+			cBottomSurface.get(),
+			out,
+		)
+	}
+
 	return v.getAttributes(
-		cPrimarySurface,
-		cTopSurface,
-		cBottomSurface,
+		newSubVolume,
 		nrows,
 		ncols,
 		targetAttributes,
@@ -194,24 +199,8 @@ func (v DSHandle) normalizeAttributes(
 	return targetAttributes, nil
 }
 
-func min(a, b int) int {
-	if a < b {
-		return a
-	}
-	return b
-}
-
-func max(a, b int) int {
-	if a > b {
-		return a
-	}
-	return b
-}
-
 func (v DSHandle) getAttributes(
-	cReferenceSurface cRegularSurface,
-	cTopSurface cRegularSurface,
-	cBottomSurface cRegularSurface,
+	newSubVolume func(*C.struct_Context, **C.struct_SurfaceBoundedSubVolume) C.int,
 	nrows int,
 	ncols int,
 	targetAttributes []int,
@@ -223,14 +212,7 @@ func (v DSHandle) getAttributes(
 	var cSubVolume *C.struct_SurfaceBoundedSubVolume
 	var cCtx = C.context_new()
 	defer C.context_free(cCtx)
-	cerr := C.subvolume_new(
-		cCtx,
-		v.DataHandle(),
-		cReferenceSurface.get(),
-		cTopSurface.get(),
-		cBottomSurface.get(),
-		&cSubVolume,
-	)
+	cerr := newSubVolume(cCtx, &cSubVolume)
 
 	if err := toError(cerr, cCtx); err != nil {
 		return nil, err
@@ -251,67 +233,22 @@ func (v DSHandle) getAttributes(
 	var mapsize = hsize * 4
 	buffer := make([]byte, mapsize*nAttributes)
 
-	// note that it is possible to hit go's own goroutines limit
-	// but we do not deal with it here
-
-	// max number of goroutines running at the same time
-	// too low number doesn't utilize all CPU, too high overuses it
-	// value should be experimented with
-	maxConcurrentGoroutines := max(nrows/2, 1)
-	guard := make(chan struct{}, maxConcurrentGoroutines)
-
-	// the size of the data processed in one goroutine
-	// decides how many parts data is split into
-	// value should be experimented with
-	chunkSize := max(nrows, 1)
-
-	from := 0
-	to := from + chunkSize
-
-	errs := make(chan error, hsize/chunkSize+1)
-	nRoutines := 0
-
-	for from < hsize {
-		guard <- struct{}{} // block if guard channel is filled
-		go func(from, to int) {
-			var cCtx = C.context_new()
-			defer C.context_free(cCtx)
-
-			cerr_attributes := C.attribute(
-				cCtx,
-				v.DataHandle(),
-				cSubVolume,
-				C.enum_interpolation_method(interpolation),
-				&cAttributes[0],
-				C.size_t(nAttributes),
-				C.float(stepsize),
-				C.size_t(from),
-				C.size_t(to),
-				unsafe.Pointer(&buffer[0]),
-			)
-
-			errs <- toError(cerr_attributes, cCtx)
-			<-guard
-
-		}(from, to)
-
-		nRoutines += 1
-
-		from += chunkSize
-		to = min(to+chunkSize, hsize)
-	}
-
-	// Wait for all gorutines to finish and collect any errors
-	var computeErrors []error
-	for i := 0; i < nRoutines; i++ {
-		err := <-errs
-		if err != nil {
-			computeErrors = append(computeErrors, err)
-		}
-	}
-
-	if len(computeErrors) > 0 {
-		return nil, computeErrors[0]
+	// The segments are computed in parallel by the native thread pool, which
+	// balances the work by sample count rather than by rows
+	cerr = C.attribute(
+		cCtx,
+		v.DataHandle(),
+		cSubVolume,
+		C.enum_interpolation_method(interpolation),
+		&cAttributes[0],
+		C.size_t(nAttributes),
+		C.float(stepsize),
+		C.size_t(0),
+		C.size_t(hsize),
+		unsafe.Pointer(&buffer[0]),
+	)
+	if err := toError(cerr, cCtx); err != nil {
+		return nil, err
 	}
 
 	out := make([][]byte, nAttributes)
@@ -11,11 +11,26 @@ import (
 	"unsafe"
 )
 
+/** The sample window of a fence as a C bound, or nil for full traces */
+func newCSampleWindow(sampleWindow *Bound) (*C.struct_Bound, error) {
+	if sampleWindow == nil {
+		return nil, nil
+	}
+
+	cBounds, err := newCSliceBounds([]Bound{*sampleWindow})
+	if err != nil {
+		return nil, err
+	}
+	return &cBounds[0], nil
+}
+
 func (v DSHandle) GetFence(
 	coordinateSystem int,
 	coordinates [][]float32,
 	interpolation int,
+	sampleWindow *Bound,
 	fillValue *float32,
+	encoding *SampleEncoding,
 ) ([]byte, error) {
 
 	if len(coordinates) == 0 {
@@ -41,6 +56,13 @@ func (v DSHandle) GetFence(
 		}
 	}
 
+	cSampleWindow, err := newCSampleWindow(sampleWindow)
+	if err != nil {
+		return nil, err
+	}
+
+	cEncoding := newCSampleEncoding(encoding)
+
 	var result C.struct_response = C.response_create()
 	cerr := C.fence(
 		v.context(),
@@ -49,7 +71,9 @@ func (v DSHandle) GetFence(
 		&ccoordinates[0],
 		C.size_t(len(coordinates)),
 		C.enum_interpolation_method(interpolation),
+		cSampleWindow,
 		(*C.float)(fillValue),
+		cEncoding,
 		&result,
 	)
 
@@ -58,17 +82,29 @@ func (v DSHandle) GetFence(
 	if err := v.Error(cerr); err != nil {
 		return nil, err
 	}
+	encoding.update(cEncoding)
 
 	buf := C.GoBytes(unsafe.Pointer(result.data), C.int(result.size))
 	return buf, nil
 }
 
-func (v DSHandle) GetFenceMetadata(coordinates [][]float32) ([]byte, error) {
+func (v DSHandle) GetFenceMetadata(
+	coordinates [][]float32,
+	sampleWindow *Bound,
+	encoding *SampleEncoding,
+) ([]byte, error) {
+	cSampleWindow, err := newCSampleWindow(sampleWindow)
+	if err != nil {
+		return nil, err
+	}
+
 	var result C.struct_response = C.response_create()
 	cerr := C.fence_metadata(
 		v.context(),
 		v.DataHandle(),
 		C.size_t(len(coordinates)),
+		cSampleWindow,
+		newCSampleEncoding(encoding),
 		&result,
 	)
 
@@ -45,7 +45,9 @@ func TestFence(t *testing.T) {
 			testcase.coordinate_system,
 			testcase.coordinates,
 			interpolationMethod,
+			nil,
 			&fillValue,
+			nil,
 		)
 		require.NoErrorf(t, err,
 			"[coordinate_system: %v] Failed to fetch fence, err: %v",
@@ -61,6 +63,131 @@ func TestFence(t *testing.T) {
 	}
 }
 
+func TestFenceSorted(t *testing.T) {
+	expected := []float32{
+		108, 109, 110, 111, // il: 3, xl: 10, samples: all
+		112, 113, 114, 115, // il: 3, xl: 11, samples: all
+		100, 101, 102, 103, // il: 1, xl: 10, samples: all
+		108, 109, 110, 111, // il: 3, xl: 10, samples: all
+		116, 117, 118, 119, // il: 5, xl: 10, samples: all
+	}
+	coordinates := [][]float32{{1, 0}, {1, 1}, {0, 0}, {1, 0}, {2, 0}}
+
+	err := ConfigureFenceSorting(1)
+	require.NoError(t, err)
+	defer ConfigureFenceSorting(0)
+
+	handle, _ := NewDSHandle(well_known)
+	defer handle.Close()
+
+	interpolationMethod, _ := GetInterpolationMethod("nearest")
+	buf, err := handle.GetFence(
+		CoordinateSystemIndex,
+		coordinates,
+		interpolationMethod,
+		nil,
+		nil,
+		nil,
+	)
+	require.NoErrorf(t, err, "Failed to fetch fence, err: %v", err)
+
+	fence, err := toFloat32(buf)
+	require.NoErrorf(t, err, "Err: %v", err)
+	require.Equalf(t, expected, *fence, "Incorrect fence")
+}
+
+func TestFenceSampleWindow(t *testing.T) {
+	expected := []float32{
+		109, 110, // il: 3, xl: 10, samples: [8, 12]
+		113, 114, // il: 3, xl: 11, samples: [8, 12]
+		101, 102, // il: 1, xl: 10, samples: [8, 12]
+	}
+	coordinates := [][]float32{{1, 0}, {1, 1}, {0, 0}}
+
+	direction := "time"
+	lower, upper := 8, 12
+	window := Bound{Direction: &direction, Lower: &lower, Upper: &upper}
+
+	handle, _ := NewDSHandle(well_known)
+	defer handle.Close()
+
+	interpolationMethod, _ := GetInterpolationMethod("nearest")
+	buf, err := handle.GetFence(
+		CoordinateSystemIndex,
+		coordinates,
+		interpolationMethod,
+		&window,
+		nil,
+		nil,
+	)
+	require.NoErrorf(t, err, "Failed to fetch fence, err: %v", err)
+
+	fence, err := toFloat32(buf)
+	require.NoErrorf(t, err, "Err: %v", err)
+	require.Equalf(t, expected, *fence, "Incorrect fence")
+
+	buf, err = handle.GetFenceMetadata(coordinates, &window, nil)
+	require.NoErrorf(t, err, "Failed to retrieve fence metadata, err %v", err)
+
+	var meta FenceMetadata
+	err = json.Unmarshal(buf, &meta)
+	require.NoErrorf(t, err, "Failed to unmarshall response, err: %v", err)
+	require.Equal(t, []int{3, 2}, meta.Shape)
+}
+
+func TestFenceInvalidSampleWindow(t *testing.T) {
+	testcases := []struct {
+		name      string
+		direction string
+		lower     int
+		upper     int
+		err       string
+	}{
+		{
+			name:      "Horizontal direction",
+			direction: "inline",
+			lower:     1,
+			upper:     3,
+			err:       "Invalid sample window direction",
+		},
+		{
+			name:      "Upper below lower",
+			direction: "k",
+			lower:     2,
+			upper:     1,
+			err:       "Upper bound must be >= than lower bound",
+		},
+		{
+			name:      "Outside the cube",
+			direction: "time",
+			lower:     4,
+			upper:     20,
+			err:       "Invalid lineno: 20",
+		},
+	}
+
+	handle, _ := NewDSHandle(well_known)
+	defer handle.Close()
+	interpolationMethod, _ := GetInterpolationMethod("nearest")
+
+	for _, testcase := range testcases {
+		window := Bound{
+			Direction: &testcase.direction,
+			Lower:     &testcase.lower,
+			Upper:     &testcase.upper,
+		}
+		_, err := handle.GetFence(
+			CoordinateSystemIndex,
+			[][]float32{{0, 0}},
+			interpolationMethod,
+			&window,
+			nil,
+			nil,
+		)
+		require.ErrorContainsf(t, err, testcase.err, "[case: %v]", testcase.name)
+	}
+}
+
 func TestFenceBorders(t *testing.T) {
 	testcases := []struct {
 		name              string
@@ -105,7 +232,7 @@ func TestFenceBorders(t *testing.T) {
 		interpolationMethod, _ := GetInterpolationMethod("linear")
 		handle, _ := NewDSHandle(well_known)
 		defer handle.Close()
-		_, err := handle.GetFence(testcase.coordinate_system, testcase.coordinates, interpolationMethod, nil)
+		_, err := handle.GetFence(testcase.coordinate_system, testcase.coordinates, interpolationMethod, nil, nil, nil)
 
 		require.ErrorContainsf(t, err, testcase.err, "[case: %v]", testcase.name)
 	}
@@ -160,7 +287,9 @@ func TestFenceBordersWithFillValue(t *testing.T) {
 			testcase.crd_system,
 			testcase.coordinates,
 			interpolationMethod,
+			nil,
 			&fillValue,
+			nil,
 		)
 		require.NoError(t, err)
 
@@ -239,7 +368,9 @@ func TestFenceNearestInterpolationSnap(t *testing.T) {
 			testcase.coordinate_system,
 			testcase.coordinates,
 			interpolationMethod,
+			nil,
 			&fillValue,
+			nil,
 		)
 		require.NoErrorf(t, err,
 			"[coordinate_system: %v] Failed to fetch fence, err: %v",
@@ -263,7 +394,7 @@ func TestInvalidFence(t *testing.T) {
 	interpolationMethod, _ := GetInterpolationMethod("nearest")
 	handle, _ := NewDSHandle(well_known)
 	defer handle.Close()
-	_, err := handle.GetFence(CoordinateSystemIndex, fence, interpolationMethod, &fillValue)
+	_, err := handle.GetFence(CoordinateSystemIndex, fence, interpolationMethod, nil, &fillValue, nil)
 
 	require.ErrorContains(t, err,
 		"invalid coordinate [1 1 0] at position 1, expected [x y] pair",
@@ -299,7 +430,9 @@ func TestFenceInterpolationSameAtDataPoints(t *testing.T) {
 			CoordinateSystemIndex,
 			coordinates,
 			interpolationMethod,
+			nil,
 			&fillValue,
+			nil,
 		)
 		require.NoErrorf(t, err, "Failed to fetch fence in [interpolation: %v]", interpolation)
 		result, err := toFloat32(buf)
@@ -318,10 +451,10 @@ func TestFenceInterpolationDifferentBeyondDatapoints(t *testing.T) {
 		interpolationMethod, _ := GetInterpolationMethod(v1)
 		handle, _ := NewDSHandle(well_known)
 		defer handle.Close()
-		buf1, _ := handle.GetFence(CoordinateSystemCdp, fence, interpolationMethod, &fillValue)
+		buf1, _ := handle.GetFence(CoordinateSystemCdp, fence, interpolationMethod, nil, &fillValue, nil)
 		for _, v2 := range interpolationMethods[i+1:] {
 			interpolationMethod, _ := GetInterpolationMethod(v2)
-			buf2, _ := handle.GetFence(CoordinateSystemCdp, fence, interpolationMethod, &fillValue)
+			buf2, _ := handle.GetFence(CoordinateSystemCdp, fence, interpolationMethod, nil, &fillValue, nil)
 
 			require.NotEqual(t, buf1, buf2)
 		}
@@ -366,7 +499,7 @@ func TestFenceMetadata(t *testing.T) {
 
 	handle, _ := NewDSHandle(well_known)
 	defer handle.Close()
-	buf, err := handle.GetFenceMetadata(coordinates)
+	buf, err := handle.GetFenceMetadata(coordinates, nil, nil)
 	require.NoErrorf(t, err, "Failed to retrieve fence metadata, err %v", err)
 
 	var meta FenceMetadata
@@ -385,7 +518,7 @@ func TestFenceEmptyArrayParams(t *testing.T) {
 	interpolationMethod, _ := GetInterpolationMethod("nearest")
 	handle, _ := NewDSHandle(well_known)
 	defer handle.Close()
-	_, err := handle.GetFence(CoordinateSystemIndex, fence, interpolationMethod, &fillValue)
+	_, err := handle.GetFence(CoordinateSystemIndex, fence, interpolationMethod, nil, &fillValue, nil)
 
 	require.Errorf(t, err,
 		"Empty coordinates didn't throw, err: %v",
@@ -6,6 +6,7 @@ import (
 	"fmt"
 	"math"
 	"testing"
+	"time"
 
 	"github.com/stretchr/testify/require"
 )
@@ -86,3 +87,31 @@ func TestOnly3DSupported(t *testing.T) {
 
 	require.ErrorContains(t, err, "3 dimensions, got 4")
 }
+
+func TestHandlePoolReusesHandles(t *testing.T) {
+	err := ConfigureHandlePool(2, time.Minute)
+	require.NoError(t, err)
+	defer ConfigureHandlePool(0, 0)
+
+	for i := 0; i < 3; i++ {
+		handle, err := NewDSHandle(samples10)
+		require.NoErrorf(t, err, "[attempt: %d] Failed to checkout handle", i)
+
+		_, err = handle.GetMetadata()
+		require.NoErrorf(t, err, "[attempt: %d] Failed to read metadata", i)
+
+		err = handle.Close()
+		require.NoErrorf(t, err, "[attempt: %d] Failed to return handle", i)
+	}
+}
+
+func TestHandlePoolDoesNotCacheErrors(t *testing.T) {
+	err := ConfigureHandlePool(2, time.Minute)
+	require.NoError(t, err)
+	defer ConfigureHandlePool(0, 0)
+
+	for i := 0; i < 2; i++ {
+		_, err := NewDSHandle(prestack)
+		require.ErrorContainsf(t, err, "3 dimensions, got 4", "[attempt: %d]", i)
+	}
+}
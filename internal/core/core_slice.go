@@ -36,7 +36,20 @@ func newCSliceBounds(bounds []Bound) ([]C.struct_Bound, error) {
 	return cBounds, nil
 }
 
-func (v DSHandle) GetSlice(lineno, direction int, bounds []Bound) ([]byte, error) {
+func newCLevelOfDetail(lod LevelOfDetail) C.struct_LevelOfDetail {
+	return C.struct_LevelOfDetail{
+		C.int(lod.Level),
+		C.size_t(lod.TargetSize),
+	}
+}
+
+func (v DSHandle) GetSlice(
+	lineno int,
+	direction int,
+	bounds []Bound,
+	lod LevelOfDetail,
+	encoding *SampleEncoding,
+) ([]byte, error) {
 	var result C.struct_response = C.response_create()
 
 	cBounds, err := newCSliceBounds(bounds)
@@ -49,6 +62,9 @@ func (v DSHandle) GetSlice(lineno, direction int, bounds []Bound) ([]byte, error
 		bound = &cBounds[0]
 	}
 
+	cLod := newCLevelOfDetail(lod)
+	cEncoding := newCSampleEncoding(encoding)
+
 	cerr := C.slice(
 		v.context(),
 		v.DataHandle(),
@@ -56,6 +72,8 @@ func (v DSHandle) GetSlice(lineno, direction int, bounds []Bound) ([]byte, error
 		C.enum_axis_name(direction),
 		bound,
 		C.size_t(len(cBounds)),
+		&cLod,
+		cEncoding,
 		&result,
 	)
 
@@ -63,15 +81,116 @@ func (v DSHandle) GetSlice(lineno, direction int, bounds []Bound) ([]byte, error
 	if err := v.Error(cerr); err != nil {
 		return nil, err
 	}
+	encoding.update(cEncoding)
 
 	buf := C.GoBytes(unsafe.Pointer(result.data), C.int(result.size))
 	return buf, nil
 }
 
+/** A single slice of a batch */
+type SliceLine struct {
+	Lineno    int
+	Direction int
+}
+
+/** Fetch several slices with a single call into the core
+ *
+ * All slices share bounds and level of detail. Slices along the same
+ * direction that fall within the same brick are read together, so the chunks
+ * they share are only fetched and decoded once.
+ *
+ * encodings is either nil, in which case the samples are returned as 32-bit
+ * floats, or holds one encoding per slice. The scale and offset of every
+ * slice are written back to its encoding.
+ *
+ * The slices are returned in the order they are given, as parts of one
+ * contiguous buffer.
+ */
+func (v DSHandle) GetSliceBatch(
+	slices []SliceLine,
+	bounds []Bound,
+	lod LevelOfDetail,
+	encodings []SampleEncoding,
+) ([][]byte, error) {
+	if encodings != nil && len(encodings) != len(slices) {
+		msg := "Expected one sample encoding per slice"
+		return nil, NewInvalidArgument(msg)
+	}
+
+	var result C.struct_response = C.response_create()
+
+	cBounds, err := newCSliceBounds(bounds)
+	if err != nil {
+		return nil, err
+	}
+
+	var bound *C.struct_Bound
+	if len(cBounds) > 0 {
+		bound = &cBounds[0]
+	}
+
+	cSlices := make([]C.struct_SliceLine, len(slices))
+	for i, slice := range slices {
+		cSlices[i] = C.struct_SliceLine{
+			C.enum_axis_name(slice.Direction),
+			C.int(slice.Lineno),
+		}
+	}
+
+	var cSlice *C.struct_SliceLine
+	if len(cSlices) > 0 {
+		cSlice = &cSlices[0]
+	}
+
+	var cEncoding *C.struct_SampleEncoding
+	var cEncodings []C.struct_SampleEncoding
+	if len(encodings) > 0 {
+		cEncodings = make([]C.struct_SampleEncoding, len(encodings))
+		for i := range encodings {
+			cEncodings[i] = *newCSampleEncoding(&encodings[i])
+		}
+		cEncoding = &cEncodings[0]
+	}
+
+	cLod := newCLevelOfDetail(lod)
+	offsets := make([]C.size_t, len(slices)+1)
+
+	cerr := C.slice_batch(
+		v.context(),
+		v.DataHandle(),
+		cSlice,
+		C.size_t(len(cSlices)),
+		bound,
+		C.size_t(len(cBounds)),
+		&cLod,
+		cEncoding,
+		&offsets[0],
+		&result,
+	)
+
+	defer C.response_delete(&result)
+	if err := v.Error(cerr); err != nil {
+		return nil, err
+	}
+
+	for i := range cEncodings {
+		encodings[i].update(&cEncodings[i])
+	}
+
+	buf := C.GoBytes(unsafe.Pointer(result.data), C.int(result.size))
+	parts := make([][]byte, len(slices))
+	for i := range parts {
+		parts[i] = buf[offsets[i]:offsets[i+1]:offsets[i+1]]
+	}
+	return parts, nil
+}
+
 func (v DSHandle) GetSliceMetadata(
 	lineno int,
 	direction int,
 	bounds []Bound,
+	lod LevelOfDetail,
+	encoding *SampleEncoding,
 ) ([]byte, error) {
 	var result C.struct_response = C.response_create()
 
@@ -85,6 +204,8 @@ func (v DSHandle) GetSliceMetadata(
 		bound = &cBounds[0]
 	}
 
+	cLod := newCLevelOfDetail(lod)
+
 	cerr := C.slice_metadata(
 		v.context(),
 		v.DataHandle(),
@@ -92,6 +213,8 @@ func (v DSHandle) GetSliceMetadata(
 		C.enum_axis_name(direction),
 		bound,
 		C.size_t(len(cBounds)),
+		&cLod,
+		newCSampleEncoding(encoding),
 		&result,
 	)
 
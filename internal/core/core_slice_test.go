@@ -2,6 +2,7 @@ package core
 
 import (
 	"bytes"
+	"encoding/binary"
 	"encoding/json"
 	"strings"
 	"testing"
@@ -48,6 +49,8 @@ func TestSliceData(t *testing.T) {
 			testcase.lineno,
 			testcase.direction,
 			[]Bound{},
+			LevelOfDetail{},
+			nil,
 		)
 		require.NoErrorf(t, err,
 			"[case: %v] Failed to fetch slice, err: %v",
@@ -62,6 +65,120 @@ func TestSliceData(t *testing.T) {
 	}
 }
 
+func TestSliceSampleFormatInt16(t *testing.T) {
+	expected := []float32{
+		108, 109, 110, 111, // il: 3, xl: 10, samples: all
+		112, 113, 114, 115, // il: 3, xl: 11, samples: all
+	}
+
+	handle, _ := NewDSHandle(well_known)
+	defer handle.Close()
+
+	encoding := SampleEncoding{Format: SampleFormatInt16}
+	buf, err := handle.GetSlice(3, AxisInline, []Bound{}, LevelOfDetail{}, &encoding)
+	require.NoErrorf(t, err, "Failed to fetch slice, err: %v", err)
+	require.Len(t, buf, len(expected)*2)
+
+	require.InDelta(t, 111.5, encoding.Offset, 1e-4)
+	require.InDelta(t, 3.5/32767, encoding.Scale, 1e-9)
+
+	for i := range expected {
+		sample := int16(binary.LittleEndian.Uint16(buf[i*2:]))
+		value := encoding.Offset + encoding.Scale*float32(sample)
+		require.InDeltaf(t, expected[i], value, float64(encoding.Scale),
+			"Unexpected value at index %d", i,
+		)
+	}
+
+	buf, err = handle.GetSliceMetadata(3, AxisInline, []Bound{}, LevelOfDetail{}, &encoding)
+	require.NoErrorf(t, err, "Failed to retrieve slice metadata, err %v", err)
+
+	var meta SliceMetadata
+	err = json.Unmarshal(buf, &meta)
+	require.NoErrorf(t, err, "Failed to unmarshall response, err: %v", err)
+
+	require.Equal(t, "<i2", meta.Format)
+	require.Equal(t, encoding.Scale, *meta.Scale)
+	require.Equal(t, encoding.Offset, *meta.Offset)
+}
+
+func TestSliceBatch(t *testing.T) {
+	slices := []SliceLine{
+		{Lineno: 3, Direction: AxisInline},
+		{Lineno: 1, Direction: AxisInline},
+		{Lineno: 10, Direction: AxisCrossline},
+		{Lineno: 5, Direction: AxisInline},
+		{Lineno: 8, Direction: AxisTime},
+		{Lineno: 3, Direction: AxisInline},
+	}
+
+	handle, _ := NewDSHandle(well_known)
+	defer handle.Close()
+
+	batch, err := handle.GetSliceBatch(slices, []Bound{}, LevelOfDetail{}, nil)
+	require.NoErrorf(t, err, "Failed to fetch slice batch, err: %v", err)
+	require.Len(t, batch, len(slices))
+
+	for i, slice := range slices {
+		expected, err := handle.GetSlice(
+			slice.Lineno,
+			slice.Direction,
+			[]Bound{},
+			LevelOfDetail{},
+			nil,
+		)
+		require.NoErrorf(t, err, "Failed to fetch slice, err: %v", err)
+		require.Equalf(t, expected, batch[i], "[slice: %v]", i)
+	}
+}
+
+func TestSliceBatchSampleFormat(t *testing.T) {
+	slices := []SliceLine{
+		{Lineno: 3, Direction: AxisInline},
+		{Lineno: 5, Direction: AxisInline},
+	}
+
+	handle, _ := NewDSHandle(well_known)
+	defer handle.Close()
+
+	encodings := []SampleEncoding{
+		{Format: SampleFormatInt16},
+		{Format: SampleFormatInt16},
+	}
+	batch, err := handle.GetSliceBatch(slices, []Bound{}, LevelOfDetail{}, encodings)
+	require.NoErrorf(t, err, "Failed to fetch slice batch, err: %v", err)
+
+	for i, slice := range slices {
+		encoding := SampleEncoding{Format: SampleFormatInt16}
+		expected, err := handle.GetSlice(
+			slice.Lineno,
+			slice.Direction,
+			[]Bound{},
+			LevelOfDetail{},
+			&encoding,
+		)
+		require.NoErrorf(t, err, "Failed to fetch slice, err: %v", err)
+		require.Equalf(t, expected, batch[i], "[slice: %v]", i)
+		require.Equalf(t, encoding, encodings[i], "[slice: %v]", i)
+	}
+}
+
+func TestSliceBatchErrorHandling(t *testing.T) {
+	handle, _ := NewDSHandle(well_known)
+	defer handle.Close()
+
+	slices := []SliceLine{
+		{Lineno: 3, Direction: AxisInline},
+		{Lineno: 4, Direction: AxisInline},
+	}
+	_, err := handle.GetSliceBatch(slices, []Bound{}, LevelOfDetail{}, nil)
+	require.ErrorContains(t, err, "Invalid lineno: 4")
+
+	encodings := []SampleEncoding{{Format: SampleFormatInt16}}
+	_, err = handle.GetSliceBatch(slices, []Bound{}, LevelOfDetail{}, encodings)
+	require.ErrorContains(t, err, "Expected one sample encoding per slice")
+}
+
 func TestSliceOutOfBounds(t *testing.T) {
 	testcases := []struct {
 		name      string
@@ -89,6 +206,8 @@ func TestSliceOutOfBounds(t *testing.T) {
 			testcase.lineno,
 			testcase.direction,
 			[]Bound{},
+			LevelOfDetail{},
+			nil,
 		)
 
 		require.ErrorContains(t, err, "Invalid lineno")
@@ -113,6 +232,8 @@ func TestSliceStepSizedLineno(t *testing.T) {
 			testcase.lineno,
 			testcase.direction,
 			[]Bound{},
+			LevelOfDetail{},
+			nil,
 		)
 
 		require.ErrorContains(t, err, "Invalid lineno")
@@ -131,7 +252,7 @@ func TestSliceInvalidAxis(t *testing.T) {
 	for _, testcase := range testcases {
 		handle, _ := NewDSHandle(well_known)
 		defer handle.Close()
-		_, err := handle.GetSlice(0, testcase.direction, []Bound{})
+		_, err := handle.GetSlice(0, testcase.direction, []Bound{}, LevelOfDetail{}, nil)
 
 		require.ErrorContains(t, err, "Unhandled axis")
 	}
@@ -375,6 +496,8 @@ func TestSliceBounds(t *testing.T) {
 			testCase.lineno,
 			direction,
 			testCase.bounds,
+			LevelOfDetail{},
+			nil,
 		)
 
 		require.IsTypef(t, testCase.expectedErr, err,
@@ -395,6 +518,8 @@ func TestSliceBounds(t *testing.T) {
 			testCase.lineno,
 			direction,
 			testCase.bounds,
+			LevelOfDetail{},
+			nil,
 		)
 		require.NoError(t, err,
 			"[case: %v] Failed to get slice metadata, err: %v",
@@ -450,7 +575,7 @@ func TestDepthAxis(t *testing.T) {
 	for _, testcase := range testcases {
 		handle, _ := NewDSHandle(well_known)
 		defer handle.Close()
-		_, err := handle.GetSlice(0, testcase.direction, []Bound{})
+		_, err := handle.GetSlice(0, testcase.direction, []Bound{}, LevelOfDetail{}, nil)
 
 		require.Equal(t, err, testcase.err)
 	}
@@ -467,10 +592,11 @@ func TestSliceMetadata(t *testing.T) {
 		Y:          Axis{Annotation: "Inline", Min: 1, Max: 5, Samples: 3, StepSize: 2, Unit: "unitless"},
 		Geospatial: [][]float64{{0, 3}, {12, 11}},
 		Shape:      []int{3, 4},
+		Lineno:     1,
 	}
 	handle, _ := NewDSHandle(well_known)
 	defer handle.Close()
-	buf, err := handle.GetSliceMetadata(lineno, direction, []Bound{})
+	buf, err := handle.GetSliceMetadata(lineno, direction, []Bound{}, LevelOfDetail{}, nil)
 	require.NoErrorf(t, err, "Failed to retrieve slice metadata, err %v", err)
 
 	var meta SliceMetadata
@@ -535,6 +661,8 @@ func TestSliceMetadataAxisOrdering(t *testing.T) {
 			testcase.lineno,
 			testcase.direction,
 			[]Bound{},
+			LevelOfDetail{},
+			nil,
 		)
 		require.NoErrorf(t, err,
 			"[case: %v] Failed to get slice metadata, err: %v",
@@ -608,6 +736,8 @@ func TestSliceGeospatial(t *testing.T) {
 			testcase.lineno,
 			testcase.direction,
 			[]Bound{},
+			LevelOfDetail{},
+			nil,
 		)
 		require.NoError(t, err,
 			"[case: %v] Failed to get slice metadata, err: %v",
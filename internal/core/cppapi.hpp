@@ -13,24 +13,107 @@
 
 namespace cppapi {
 
+/**
+ * The data functions encode the samples in encoding->format, and write the
+ * scale and offset of the scaled integer formats back to encoding. The same
+ * encoding should be passed to the corresponding metadata function.
+ *
+ * encoding may be nullptr, in which case the samples are 32-bit floats.
+ */
 void slice(
     DataHandle& datahandle,
     Direction const direction,
     int lineno,
     std::vector< Bound > const& bounds,
+    LevelOfDetail const& lod,
+    SampleEncoding* encoding,
+    response* out
+) noexcept (false);
+
+/**
+ * Fetch several slices in one call. All slices share bounds and level of
+ * detail.
+ *
+ * Slices along the same dimension that fall within the same brick are read
+ * with a single request, so that the chunks they share are only fetched and
+ * decoded once.
+ *
+ * The slices are written back to back to out, in the order they are given.
+ * Slice i starts offsets[i] bytes into out->data, and offsets[nslices] is the
+ * total size. offsets must have room for slices.size() + 1 elements.
+ *
+ * encodings is either nullptr or points to one encoding per slice. Every
+ * slice is encoded on its own, so the scaled integer formats get a scale and
+ * offset per slice.
+ */
+void slice_batch(
+    DataHandle& datahandle,
+    std::vector< SliceLine > const& slices,
+    std::vector< Bound > const& bounds,
+    LevelOfDetail const& lod,
+    SampleEncoding* encodings,
+    std::size_t* offsets,
     response* out
 ) noexcept (false);
 
+/**
+ * Min number of points for a fence to be read in locality order.
+ *
+ * The traces of a fence are read in the order of its points. For long,
+ * meandering fences and random point sets that order jumps between bricks,
+ * and chunks are evicted from the OpenVDS cache before all traces through
+ * them have been read. Fences with at least min_points points are instead
+ * read along a Morton (z-order) curve over inline and crossline, which visits
+ * the traces brick by brick, and the traces are then put back in the order of
+ * the points. 0 (the default) never sorts.
+ */
+void configure_fence_sorting(std::size_t min_points) noexcept (true);
+
+/**
+ * Tolerance for fence points to be considered the same trace.
+ *
+ * Every distinct trace of a fence is only read once, and copied to all the
+ * points that share it. With nearest interpolation points within the same
+ * voxel share a trace. With the other interpolation methods points share a
+ * trace when their sample positions round to the same multiple of epsilon,
+ * in voxels. 0 (the default) only merges points at exactly the same position.
+ */
+void configure_fence_deduplication(float epsilon) noexcept (false);
+
+/**
+ * sample_window optionally restricts the fence to a vertical window. It is a
+ * bound along the sample axis, in annotation (time, depth, sample) or index
+ * (k), with both ends inclusive. Only the samples in the window are read, so
+ * the response and the chunks fetched scale with the window rather than the
+ * full trace. nullptr reads the full traces.
+ */
 void fence(
     DataHandle& datahandle,
     enum coordinate_system coordinate_system,
     const float* coordinates,
     size_t npoints,
     enum interpolation_method interpolation_method,
+    Bound const* sample_window,
     const float* fillValue,
+    SampleEncoding* encoding,
     response* out
 ) noexcept (false);
 
+/**
+ * Read the segments of subvolumes as trace windows.
+ *
+ * By default every sample of a subvolume is read with a sample request of its
+ * own, which materialises a position for every sample and has OpenVDS
+ * interpolate every sample laterally. When enabled, segments that are aligned
+ * with the samples are instead read as windows (first sample, number of
+ * samples) of laterally interpolated traces, in batches of traces. Only the
+ * positions of the traces are materialised.
+ *
+ * Trace requests fetch the full traces, so this pays off when the segments
+ * cover a good part of the traces. Disabled by default.
+ */
+void configure_subvolume_trace_reads(bool enabled) noexcept (true);
+
 void fetch_subvolume(
     DataHandle& datahandle,
     SurfaceBoundedSubVolume& subvolume,
@@ -49,6 +132,86 @@ void attributes(
     void** out
 ) noexcept (false);
 
+/**
+ * Max bytes of memory held by attribute calculations at once.
+ *
+ * tiled_attributes fetches, resamples and reduces the segments of a subvolume
+ * tile by tile, and releases every tile before the next is fetched. A tile
+ * counts the samples of its segments and the buffers used to fetch them. The
+ * budget is shared by all concurrent calculations, which wait for tiles to be
+ * released when it is used up. Tiles are sized so that every core can work on
+ * a tile of its own within the budget. 0 (the default) is unlimited, in which
+ * case every call is a single tile.
+ */
+void configure_attribute_memory(std::size_t budget) noexcept (true);
+
+/**
+ * Number of tiles tiled_attributes fetches ahead.
+ *
+ * Up to depth tiles are fetched in the background while the current tile is
+ * resampled and reduced, so that I/O and computation overlap. Tiles ahead
+ * hold their part of the memory budget, and are only fetched when the budget
+ * has room for them. 0 (the default) fetches and computes one tile at a time.
+ */
+void configure_attribute_prefetch(std::size_t depth) noexcept (true);
+
+/**
+ * Fetch the segments [from, to) of subvolume and calculate their attributes,
+ * tile by tile. Only the tiles being processed and prefetched are held in
+ * memory, so subvolume need not have storage for its data, see
+ * make_tiled_subvolume.
+ */
+void tiled_attributes(
+    DataHandle& datahandle,
+    SurfaceBoundedSubVolume const& subvolume,
+    enum interpolation_method interpolation,
+    ResampledSegmentBlueprint const* dst_segment_blueprint,
+    enum attribute* attributes,
+    std::size_t nattributes,
+    std::size_t from,
+    std::size_t to,
+    void** out
+) noexcept (false);
+
+/**
+ * The VALUE attribute of the segments [from, to) of subvolume, written to
+ * out, without fetching the segments.
+ *
+ * The result is the same as that of attributes with dst_segment_blueprint,
+ * for any window. Makima is local, so only the samples of a segment that the
+ * spline at the reference depends on are read, at most 6 per segment. Only
+ * the segment layout of subvolume is used, see make_tiled_subvolume.
+ */
+void horizon_values(
+    DataHandle& datahandle,
+    SurfaceBoundedSubVolume const& subvolume,
+    enum interpolation_method interpolation,
+    ResampledSegmentBlueprint const* dst_segment_blueprint,
+    std::size_t from,
+    std::size_t to,
+    float* out
+) noexcept (false);
+
+/**
+ * tiled_attributes in parallel on the process-wide thread pool. [from, to) is
+ * split into tasks with about the same number of samples each, so that tasks
+ * take about the same time no matter how the segment lengths vary. Threads
+ * that run out of tasks steal tasks from the others.
+ *
+ * When VALUE is the only attribute requested, horizon_values is used instead.
+ */
+void parallel_attributes(
+    DataHandle& datahandle,
+    SurfaceBoundedSubVolume const& subvolume,
+    enum interpolation_method interpolation,
+    ResampledSegmentBlueprint const* dst_segment_blueprint,
+    enum attribute* attributes,
+    std::size_t nattributes,
+    std::size_t from,
+    std::size_t to,
+    void** out
+) noexcept (false);
+
 /**
  * Given two input surfaces, primary and secondary, updates third surface,
  * aligned, which is expected to be shaped as primary surface, with data
@@ -81,6 +244,8 @@ void slice_metadata(
     Direction const direction,
     int lineno,
     std::vector< Bound > const& bounds,
+    LevelOfDetail const& lod,
+    SampleEncoding const* encoding,
     response* out
 ) noexcept (false);
 
@@ -88,6 +253,8 @@ void slice_metadata(
 void fence_metadata(
     DataHandle& datahandle,
     size_t npoints,
+    Bound const* sample_window,
+    SampleEncoding const* encoding,
     response* out
 ) noexcept (false);
 
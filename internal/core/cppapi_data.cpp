@@ -1,8 +1,21 @@
 #include "ctypes.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <iterator>
+#include <numeric>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
 
 #include <OpenVDS/OpenVDS.h>
 #include <OpenVDS/KnownMetadata.h>
@@ -13,10 +26,13 @@
 #include "datahandle.hpp"
 #include "direction.hpp"
 #include "exceptions.hpp"
+#include "makima.hpp"
 #include "metadatahandle.hpp"
 #include "regularsurface.hpp"
+#include "sampleformat.hpp"
 #include "subcube.hpp"
 #include "subvolume.hpp"
+#include "threadpool.hpp"
 #include "utils.hpp"
 
 namespace {
@@ -31,6 +47,29 @@ void to_response(
     response->size = static_cast<unsigned long>(size);
 }
 
+/**
+ * Encode the float samples in data in the requested format. The conversion is
+ * done in place, and only the first part of the buffer is returned.
+ */
+void to_response(
+    std::unique_ptr< char[] > data,
+    std::int64_t const size,
+    SampleEncoding* encoding,
+    response* response
+) {
+    if (not encoding) return to_response(std::move(data), size, response);
+
+    std::size_t const nsamples = size / sizeof(float);
+    encode_samples(
+        reinterpret_cast< float const* >(data.get()),
+        nsamples,
+        encoding,
+        data.get()
+    );
+    std::int64_t const encoded_size = nsamples * sample_size(encoding->format);
+    return to_response(std::move(data), encoded_size, response);
+}
+
 bool equal(const char* lhs, const char* rhs) {
     return std::strcmp(lhs, rhs) == 0;
 }
@@ -120,11 +159,725 @@ void write_fillvalue(
     });
 }
 
-template< typename T >
-void append(std::vector< std::unique_ptr< AttributeMap > >& vec, T obj) {
-    vec.push_back( std::unique_ptr< T >( new T( std::move(obj) ) ) );
+/*
+ * Copy the plane at index 'plane' along dimension out of a subcube buffer.
+ * Dimension 0 is the fastest, so the plane is made up of nplanes-strided runs
+ * of the samples of all faster dimensions.
+ */
+void copy_plane(
+    float const*   src,
+    SubCube const& subcube,
+    int            dimension,
+    int            plane,
+    float*         dst
+) noexcept (true) {
+    std::size_t inner = 1;
+    for (int d = 0; d < dimension; ++d) inner *= subcube.nsamples(d);
+
+    std::size_t outer = 1;
+    for (int d = dimension + 1; d < OpenVDS::Dimensionality_Max; ++d) {
+        outer *= subcube.nsamples(d);
+    }
+
+    std::size_t const nplanes = subcube.nsamples(dimension);
+    for (std::size_t i = 0; i < outer; ++i) {
+        std::memcpy(
+            dst + i * inner,
+            src + (i * nplanes + plane) * inner,
+            inner * sizeof(float)
+        );
+    }
+}
+
+/*
+ * Slices in the same brick are only read together as one slab when the slab
+ * is no more than max_slab_overread times the size of the requested slices,
+ * and no larger than max_slab_size bytes.
+ */
+constexpr std::int64_t max_slab_overread = 2;
+constexpr std::int64_t max_slab_size = 64 * 1024 * 1024;
+
+std::atomic< std::size_t > fence_sort_min_points(0);
+std::atomic< float > fence_dedup_epsilon(0);
+
+/* Spread the bits of x to the even bits of the result */
+std::uint64_t spread_bits(std::uint32_t x) noexcept (true) {
+    std::uint64_t v = x;
+    v = (v | (v << 16)) & 0x0000FFFF0000FFFF;
+    v = (v | (v <<  8)) & 0x00FF00FF00FF00FF;
+    v = (v | (v <<  4)) & 0x0F0F0F0F0F0F0F0F;
+    v = (v | (v <<  2)) & 0x3333333333333333;
+    v = (v | (v <<  1)) & 0x5555555555555555;
+    return v;
+}
+
+/*
+ * Position of the trace along a Morton curve over dimension a and b. Bricks
+ * are power-of-two sized and aligned, so all traces within a brick are
+ * visited before moving on to the next brick.
+ */
+std::uint64_t morton_code(
+    voxel const& coordinate,
+    int a,
+    int b
+) noexcept (true) {
+    /* Points outside the cube are read as well, and clamped to its edge */
+    auto const index = [](float position) {
+        return std::uint32_t(std::max(position, 0.0f));
+    };
+    return spread_bits(index(coordinate[a]))
+        | (spread_bits(index(coordinate[b])) << 1);
+}
+
+/*
+ * Read the traces in Morton order, and permute them back to the order of the
+ * coordinates. The traces are read straight into buffer and permuted in
+ * place, one cycle of the permutation at a time, so that only a single trace
+ * is held on the side.
+ */
+void read_traces_sorted(
+    DataHandle& datahandle,
+    char* const buffer,
+    std::int64_t const size,
+    voxel const* coordinates,
+    std::size_t const ntraces,
+    int const inline_dimension,
+    int const crossline_dimension,
+    enum interpolation_method const interpolation_method
+) noexcept (false) {
+    std::vector< std::pair< std::uint64_t, std::size_t > > order(ntraces);
+    for (std::size_t i = 0; i < ntraces; ++i) {
+        order[i] = std::make_pair(
+            morton_code(coordinates[i], inline_dimension, crossline_dimension),
+            i
+        );
+    }
+    std::sort(order.begin(), order.end());
+
+    /* The position in the sorted read of the trace of every coordinate */
+    std::vector< std::size_t > source(ntraces);
+    std::unique_ptr< voxel[] > sorted(new voxel[ntraces]);
+    for (std::size_t i = 0; i < ntraces; ++i) {
+        source[order[i].second] = i;
+        std::copy(
+            std::begin(coordinates[order[i].second]),
+            std::end(coordinates[order[i].second]),
+            std::begin(sorted[i])
+        );
+    }
+    order = {};
+
+    datahandle.read_traces(
+        buffer,
+        size,
+        sorted.get(),
+        ntraces,
+        interpolation_method
+    );
+    sorted.reset();
+
+    std::size_t const trace_size = datahandle.traces_buffer_size(ntraces) / ntraces;
+    std::unique_ptr< char[] > trace(new char[trace_size]);
+    for (std::size_t first = 0; first < ntraces; ++first) {
+        if (source[first] == first) continue;
+
+        /*
+         * Every position of the cycle takes the trace of the next one, and
+         * the last one takes the trace that was at first. Positions are
+         * marked as done by pointing them to themselves.
+         */
+        std::memcpy(trace.get(), buffer + first * trace_size, trace_size);
+        std::size_t i = first;
+        while (source[i] != first) {
+            std::size_t const next = source[i];
+            std::memcpy(
+                buffer + i    * trace_size,
+                buffer + next * trace_size,
+                trace_size
+            );
+            source[i] = i;
+            i = next;
+        }
+        std::memcpy(buffer + i * trace_size, trace.get(), trace_size);
+        source[i] = i;
+    }
+}
+
+/*
+ * Read the traces, in Morton order if there are enough of them for that to
+ * pay off.
+ */
+void read_traces_in_order(
+    DataHandle& datahandle,
+    char* const buffer,
+    std::int64_t const size,
+    voxel const* coordinates,
+    std::size_t const ntraces,
+    int const inline_dimension,
+    int const crossline_dimension,
+    enum interpolation_method const interpolation_method
+) noexcept (false) {
+    std::size_t const sort_min_points = ::fence_sort_min_points.load();
+    if (sort_min_points > 0 and ntraces >= sort_min_points) {
+        return read_traces_sorted(
+            datahandle,
+            buffer,
+            size,
+            coordinates,
+            ntraces,
+            inline_dimension,
+            crossline_dimension,
+            interpolation_method
+        );
+    }
+
+    datahandle.read_traces(
+        buffer,
+        size,
+        coordinates,
+        ntraces,
+        interpolation_method
+    );
+}
+
+using TraceKey = std::pair< std::int64_t, std::int64_t >;
+
+struct TraceKeyHash {
+    std::size_t operator()(TraceKey const& key) const noexcept (true) {
+        std::size_t const a = std::hash< std::int64_t >()(key.first);
+        std::size_t const b = std::hash< std::int64_t >()(key.second);
+        return a ^ (b + 0x9e3779b9 + (a << 6) + (a >> 2));
+    }
+};
+
+/*
+ * Points with the same key read the same trace. With nearest interpolation
+ * that is every point within the same voxel, OpenVDS picks the voxel a sample
+ * position falls in. Otherwise points are only considered the same if their
+ * positions round to the same multiple of epsilon, or with epsilon 0, if
+ * they are exactly the same.
+ */
+TraceKey trace_key(
+    voxel const& coordinate,
+    int const inline_dimension,
+    int const crossline_dimension,
+    enum interpolation_method const interpolation_method,
+    float const epsilon
+) noexcept (true) {
+    auto const key = [&](float position) -> std::int64_t {
+        if (interpolation_method == NEAREST) {
+            return std::int64_t(std::floor(position));
+        }
+        if (epsilon > 0) {
+            return std::llround(double(position) / epsilon);
+        }
+        std::uint32_t bits;
+        std::memcpy(&bits, &position, sizeof(bits));
+        return bits;
+    };
+    return TraceKey(
+        key(coordinate[inline_dimension]),
+        key(coordinate[crossline_dimension])
+    );
+}
+
+/* The vertical window of a fence, voxels [lower, upper) along dimension */
+struct SampleWindow {
+    int dimension;
+    int lower;
+    int upper;
+    /* The window covers the full traces */
+    bool full;
+
+    int nsamples() const noexcept (true) { return this->upper - this->lower; }
+};
+
+SampleWindow fence_window(
+    MetadataHandle const& metadata,
+    Bound const* sample_window
+) noexcept (false) {
+    Axis const& sample = metadata.sample();
+
+    SubCube window(metadata);
+    if (sample_window) {
+        Direction const direction(sample_window->name);
+        if (not direction.is_sample()) {
+            throw detail::bad_request(
+                "Invalid sample window direction: " + direction.to_string() +
+                ", expected a vertical direction"
+            );
+        }
+        validate_vertical_axis(sample, direction);
+
+        if (sample_window->upper < sample_window->lower) {
+            throw detail::bad_request(
+                "Invalid sample window: [" +
+                std::to_string(sample_window->lower) + ", " +
+                std::to_string(sample_window->upper) +
+                "], upper must be greater or equal to lower"
+            );
+        }
+        window.constrain(metadata, { *sample_window });
+    }
+
+    int const dimension = sample.dimension();
+    int const lower = window.bounds.lower[dimension];
+    int const upper = window.bounds.upper[dimension];
+    return SampleWindow{
+        dimension,
+        lower,
+        upper,
+        lower == 0 and upper == sample.nsamples()
+    };
 }
 
+/*
+ * Max size of the traces, or sample positions, read at once by
+ * read_trace_windows and read_subvolume_windows
+ */
+constexpr std::int64_t trace_window_batch_size = 16 * 1024 * 1024;
+
+/*
+ * Windows that cover more than this fraction of the trace are read as whole
+ * traces, which is cheaper than requesting every sample of the window.
+ */
+constexpr double max_sampled_window_fraction = 0.5;
+
+/*
+ * Read the traces of a fence, restricted to the vertical window.
+ *
+ * Full traces are read with trace requests. Narrow windows are read with
+ * sample requests at the voxel centres of the window, so that only the chunks
+ * the window passes through are fetched. At voxel centres the vertical
+ * interpolation is exact, and the samples are the same as those of the full
+ * traces. Windows that cover most of the trace are read as whole traces and
+ * cropped. Both are read in batches of up to trace_window_batch_size bytes of
+ * sample positions or traces.
+ */
+void read_trace_windows(
+    DataHandle& datahandle,
+    char* const buffer,
+    std::int64_t const size,
+    voxel const* coordinates,
+    std::size_t const ntraces,
+    int const inline_dimension,
+    int const crossline_dimension,
+    enum interpolation_method const interpolation_method,
+    SampleWindow const& window
+) noexcept (false) {
+    if (window.full) {
+        return read_traces_in_order(
+            datahandle,
+            buffer,
+            size,
+            coordinates,
+            ntraces,
+            inline_dimension,
+            crossline_dimension,
+            interpolation_method
+        );
+    }
+
+    std::size_t const nwindow = window.nsamples();
+    if (size < datahandle.samples_buffer_size(ntraces * nwindow)) {
+        throw std::invalid_argument("Buffer too small for trace windows");
+    }
+    std::int64_t const window_size = datahandle.samples_buffer_size(nwindow);
+
+    std::int64_t const trace_size = datahandle.traces_buffer_size(1);
+    std::size_t const trace_length = trace_size / sizeof(float);
+    if (nwindow > max_sampled_window_fraction * trace_length) {
+        std::size_t const batch = std::max< std::int64_t >(
+            1, trace_window_batch_size / trace_size
+        );
+        std::size_t const buffer_traces = std::min(batch, ntraces);
+        std::unique_ptr< char[] > traces(new char[buffer_traces * trace_size]);
+        for (std::size_t from = 0; from < ntraces; from += batch) {
+            std::size_t const n = std::min(batch, ntraces - from);
+            read_traces_in_order(
+                datahandle,
+                traces.get(),
+                n * trace_size,
+                coordinates + from,
+                n,
+                inline_dimension,
+                crossline_dimension,
+                interpolation_method
+            );
+
+            for (std::size_t i = 0; i < n; ++i) {
+                std::memcpy(
+                    buffer + (from + i) * window_size,
+                    traces.get() + i * trace_size + window.lower * sizeof(float),
+                    window_size
+                );
+            }
+        }
+        return;
+    }
+
+    std::size_t const batch = std::max< std::size_t >(
+        1, trace_window_batch_size / (nwindow * sizeof(voxel))
+    );
+    std::size_t const buffer_samples = std::min(batch, ntraces) * nwindow;
+    std::unique_ptr< voxel[] > samples(new voxel[buffer_samples]);
+    for (std::size_t from = 0; from < ntraces; from += batch) {
+        std::size_t const n = std::min(batch, ntraces - from);
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t k = 0; k < nwindow; ++k) {
+                voxel& sample = samples[i * nwindow + k];
+                std::copy(
+                    std::begin(coordinates[from + i]),
+                    std::end(coordinates[from + i]),
+                    std::begin(sample)
+                );
+                sample[window.dimension] = window.lower + k + 0.5;
+            }
+        }
+
+        datahandle.read_samples(
+            buffer + from * window_size,
+            n * window_size,
+            samples.get(),
+            n * nwindow,
+            interpolation_method
+        );
+    }
+}
+
+/*
+ * Read the traces of a fence. Dense fences, e.g. along well paths, often have
+ * many points that read the same trace. Every distinct trace is only read
+ * once, and copied to all the points that share it.
+ */
+void read_fence_traces(
+    DataHandle& datahandle,
+    char* const buffer,
+    std::int64_t const size,
+    voxel const* coordinates,
+    std::size_t const ntraces,
+    int const inline_dimension,
+    int const crossline_dimension,
+    enum interpolation_method const interpolation_method,
+    SampleWindow const& window
+) noexcept (false) {
+    float const epsilon = ::fence_dedup_epsilon.load();
+
+    /* The distinct trace every point reads, and the first point of each */
+    std::vector< std::size_t > source(ntraces);
+    std::vector< std::size_t > distinct;
+    std::unordered_map< TraceKey, std::size_t, TraceKeyHash > seen;
+    seen.reserve(ntraces);
+    for (std::size_t i = 0; i < ntraces; ++i) {
+        auto const key = trace_key(
+            coordinates[i],
+            inline_dimension,
+            crossline_dimension,
+            interpolation_method,
+            epsilon
+        );
+        auto const inserted = seen.emplace(key, distinct.size());
+        if (inserted.second) distinct.push_back(i);
+        source[i] = inserted.first->second;
+    }
+
+    if (distinct.size() == ntraces) {
+        return read_trace_windows(
+            datahandle,
+            buffer,
+            size,
+            coordinates,
+            ntraces,
+            inline_dimension,
+            crossline_dimension,
+            interpolation_method,
+            window
+        );
+    }
+
+    std::size_t const ndistinct = distinct.size();
+    std::unique_ptr< voxel[] > distinct_coordinates(new voxel[ndistinct]);
+    for (std::size_t i = 0; i < ndistinct; ++i) {
+        std::copy(
+            std::begin(coordinates[distinct[i]]),
+            std::end(coordinates[distinct[i]]),
+            std::begin(distinct_coordinates[i])
+        );
+    }
+
+    std::size_t const trace_size = size / ntraces;
+    std::int64_t const distinct_size = trace_size * ndistinct;
+    std::unique_ptr< char[] > traces(new char[distinct_size]);
+    read_trace_windows(
+        datahandle,
+        traces.get(),
+        distinct_size,
+        distinct_coordinates.get(),
+        ndistinct,
+        inline_dimension,
+        crossline_dimension,
+        interpolation_method,
+        window
+    );
+
+    for (std::size_t i = 0; i < ntraces; ++i) {
+        std::memcpy(
+            buffer + i * trace_size,
+            traces.get() + source[i] * trace_size,
+            trace_size
+        );
+    }
+}
+
+std::atomic< bool > subvolume_trace_reads(false);
+
+/*
+ * The vertical window of a subvolume segment as the index of its first sample
+ * and its number of samples. Segments are normally aligned with the samples,
+ * in which case their sample positions are voxel centres (k + 0.5).
+ */
+struct TraceWindow {
+    std::size_t segment;
+    int         first;
+    int         count;
+};
+
+/*
+ * The window of a segment with sample position k, or false if the segment is
+ * not aligned with the samples or not fully within a trace of length
+ * trace_length.
+ */
+bool to_trace_window(
+    double const k,
+    int const count,
+    int const trace_length,
+    TraceWindow& window
+) noexcept (true) {
+    double const first = std::round(k - 0.5);
+    if (std::abs(k - 0.5 - first) >= 1e-3) return false;
+    if (first < 0 or first + count > trace_length) return false;
+
+    window.first = static_cast< int >(first);
+    window.count = count;
+    return true;
+}
+
+/*
+ * Read the segments of a subvolume as windows of the traces they are in. The
+ * traces are laterally interpolated once, rather than once per sample, and
+ * only the trace positions are materialised. Traces are read in batches of up
+ * to trace_window_batch_size bytes.
+ */
+void read_subvolume_windows(
+    DataHandle& datahandle,
+    SurfaceBoundedSubVolume& subvolume,
+    std::vector< TraceWindow > const& windows,
+    voxel const* coordinates,
+    enum interpolation_method const interpolation
+) noexcept (false) {
+    std::int64_t const trace_size = datahandle.traces_buffer_size(1);
+    std::size_t const batch = std::max< std::int64_t >(
+        1, trace_window_batch_size / trace_size
+    );
+
+    std::size_t const ntraces = windows.size();
+    std::size_t const buffer_traces = std::min(batch, ntraces);
+    std::unique_ptr< char[] > traces(new char[buffer_traces * trace_size]);
+    for (std::size_t from = 0; from < ntraces; from += batch) {
+        std::size_t const n = std::min(batch, ntraces - from);
+        datahandle.read_traces(
+            traces.get(),
+            n * trace_size,
+            coordinates + from,
+            n,
+            interpolation
+        );
+
+        for (std::size_t i = 0; i < n; ++i) {
+            TraceWindow const& window = windows[from + i];
+            float const* trace = reinterpret_cast< float const* >(
+                traces.get() + i * trace_size
+            );
+            std::copy(
+                trace + window.first,
+                trace + window.first + window.count,
+                subvolume.data(window.segment)
+            );
+        }
+    }
+}
+
+/*
+ * Bytes of memory that attribute tiles may hold at once, shared by all
+ * concurrent requests. Tiles that don't fit wait for other tiles to be
+ * released. 0 is unlimited.
+ */
+class TileBudget {
+public:
+    static TileBudget& instance() noexcept (true) {
+        static TileBudget budget;
+        return budget;
+    }
+
+    void configure(std::size_t capacity) noexcept (true) {
+        {
+            std::lock_guard< std::mutex > lock(this->m_mutex);
+            this->m_capacity = capacity;
+        }
+        this->m_released.notify_all();
+    }
+
+    std::size_t capacity() noexcept (true) {
+        std::lock_guard< std::mutex > lock(this->m_mutex);
+        return this->m_capacity;
+    }
+
+    /*
+     * Block until size bytes are available, and take them. Tiles larger than
+     * the capacity only wait for the budget to be unused. Returns the number
+     * of bytes taken, which must be given back with release.
+     */
+    std::size_t acquire(std::size_t size) noexcept (false) {
+        std::unique_lock< std::mutex > lock(this->m_mutex);
+        if (this->m_capacity == 0) return 0;
+
+        size = std::min(size, this->m_capacity);
+        this->m_released.wait(lock, [this, size] {
+            return this->m_capacity == 0
+                or this->m_used + size <= this->m_capacity;
+        });
+        this->m_used += size;
+        return size;
+    }
+
+    /*
+     * Take size bytes if they are available right away. taken is set to the
+     * number of bytes taken, which must be given back with release.
+     */
+    bool try_acquire(std::size_t size, std::size_t& taken) noexcept (true) {
+        std::lock_guard< std::mutex > lock(this->m_mutex);
+        taken = 0;
+        if (this->m_capacity == 0) return true;
+
+        size = std::min(size, this->m_capacity);
+        if (this->m_used + size > this->m_capacity) return false;
+
+        this->m_used += size;
+        taken = size;
+        return true;
+    }
+
+    void release(std::size_t size) noexcept (true) {
+        {
+            std::lock_guard< std::mutex > lock(this->m_mutex);
+            this->m_used -= size;
+        }
+        this->m_released.notify_all();
+    }
+
+private:
+    TileBudget() = default;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_released;
+    std::size_t             m_capacity = 0;
+    std::size_t             m_used = 0;
+};
+
+/*
+ * Bytes held per sample of a tile while it is fetched, at most: the sample
+ * itself, the coordinates fetch_subvolume reads it by, and the staging copy
+ * of segments that are not contiguous in the tile. Segments read as trace
+ * windows need less, but those that are not aligned with the samples are
+ * still read sample by sample.
+ */
+constexpr std::size_t tile_sample_size = 2 * sizeof(float) + sizeof(voxel);
+
+/* Bytes taken from the tile budget for the lifetime of a tile */
+class TileReservation {
+public:
+    /* Wait for size bytes of the budget */
+    explicit TileReservation(std::size_t size) noexcept (false)
+        : m_size(TileBudget::instance().acquire(size))
+        , m_owns(true)
+    {}
+
+    /* Take size bytes of the budget only if they are available right away */
+    TileReservation(std::size_t size, std::try_to_lock_t) noexcept (true)
+        : m_size(0)
+        , m_owns(TileBudget::instance().try_acquire(size, this->m_size))
+    {}
+
+    ~TileReservation() {
+        if (this->m_size) TileBudget::instance().release(this->m_size);
+    }
+
+    TileReservation(TileReservation const&) = delete;
+    TileReservation& operator=(TileReservation const&) = delete;
+
+    bool owns() const noexcept (true) {
+        return this->m_owns;
+    }
+
+private:
+    std::size_t m_size;
+    bool        m_owns;
+};
+
+std::atomic< std::size_t > attribute_prefetch_depth(0);
+
+/*
+ * Without a memory budget, tiles are only split up for prefetching. They are
+ * kept large enough that the requests are not dominated by their overhead.
+ */
+constexpr std::size_t prefetch_tile_samples = 1024 * 1024;
+
+/*
+ * A tile of a subvolume, fetched in the background while earlier tiles are
+ * resampled and reduced. The tile holds its part of the budget until it is
+ * destroyed, which waits for the fetch to complete.
+ */
+struct PendingTile {
+    PendingTile(
+        SurfaceBoundedSubVolume const& subvolume,
+        std::size_t first,
+        std::size_t last,
+        std::unique_ptr< TileReservation > reservation
+    ) : first(first),
+        last(last),
+        reservation(std::move(reservation)),
+        tile(subvolume.tile(first, last))
+    {}
+
+    ~PendingTile() {
+        if (this->fetched.valid()) this->fetched.wait();
+    }
+
+    std::size_t first;
+    std::size_t last;
+    std::unique_ptr< TileReservation > reservation;
+    SurfaceBoundedSubVolume tile;
+    std::future< void > fetched;
+};
+
+/*
+ * Read position of a horizon value: the samples [first, first + count) of a
+ * trace, as voxel coordinates, and the position of the reference in samples
+ * from first. A single sample is the value itself.
+ */
+struct HorizonCell {
+    std::size_t index;
+    double      first;
+    int         count;
+    double      position;
+};
+
+/*
+ * Makima is local: between two samples, the spline only depends on the
+ * samples within this distance of them
+ */
+constexpr int makima_reach = 2;
+
 } // namespace
 
 namespace cppapi {
@@ -134,6 +887,8 @@ void slice(
     Direction const direction,
     int lineno,
     std::vector< Bound > const& slicebounds,
+    LevelOfDetail const& lod,
+    SampleEncoding* encoding,
     response* out
 ) {
     MetadataHandle const& metadata = datahandle.get_metadata();
@@ -151,13 +906,167 @@ void slice(
     SubCube bounds(metadata);
     bounds.constrain(metadata, slicebounds);
     bounds.set_slice(axis, lineno, direction.coordinate_system());
+    bounds.set_lod(lod, datahandle.max_lod());
 
     std::int64_t const size = datahandle.subcube_buffer_size(bounds);
 
     std::unique_ptr<char[]> data(new char[size]);
     datahandle.read_subcube(data.get(), size, bounds);
 
-    return to_response(std::move(data), size, out);
+    return to_response(std::move(data), size, encoding, out);
+}
+
+void slice_batch(
+    DataHandle& datahandle,
+    std::vector< SliceLine > const& slices,
+    std::vector< Bound > const& slicebounds,
+    LevelOfDetail const& lod,
+    SampleEncoding* encodings,
+    std::size_t* offsets,
+    response* out
+) {
+    MetadataHandle const& metadata = datahandle.get_metadata();
+
+    for (auto const& bound : slicebounds) {
+        auto bound_dir = Direction(bound.name);
+        validate_vertical_axis(metadata.sample(), bound_dir);
+    }
+
+    SubCube bounds(metadata);
+    bounds.constrain(metadata, slicebounds);
+
+    int const max_lod = datahandle.max_lod();
+    std::size_t const nslices = slices.size();
+
+    /* The subcube of every slice, and where it goes in the float buffer */
+    std::vector< SubCube > subcubes;
+    std::vector< int > dimensions;
+    std::vector< std::int64_t > positions(nslices + 1, 0);
+    subcubes.reserve(nslices);
+    dimensions.reserve(nslices);
+    for (std::size_t i = 0; i < nslices; ++i) {
+        Direction const direction(slices[i].direction);
+        Axis const& axis = metadata.get_axis(direction);
+
+        if (direction.is_sample()) {
+            validate_vertical_axis(metadata.sample(), direction);
+        }
+
+        SubCube subcube(bounds);
+        subcube.set_slice(axis, slices[i].lineno, direction.coordinate_system());
+        subcube.set_lod(lod, max_lod);
+
+        positions[i + 1] = positions[i] + datahandle.subcube_buffer_size(subcube);
+        subcubes.push_back(subcube);
+        dimensions.push_back(axis.dimension());
+    }
+
+    std::int64_t const size = positions.back();
+    std::unique_ptr< char[] > data(new char[size]);
+
+    /*
+     * Slices along the same dimension, at the same level of detail and within
+     * the same brick are read together as one slab, from which the individual
+     * slices are copied out. A slab spans every plane from its first to its
+     * last slice, so slices are only added to it while the slab stays dense
+     * and small enough, see max_slab_overread and max_slab_size. The rest are
+     * read on their own, or start a new slab.
+     */
+    int const bricksize = datahandle.bricksize();
+    auto group = [&](std::size_t i) {
+        int const lower = subcubes[i].bounds.lower[dimensions[i]];
+        int const level = subcubes[i].lod;
+        return std::make_tuple(dimensions[i], level, lower / (bricksize << level));
+    };
+    auto line = [&](std::size_t i) {
+        return subcubes[i].bounds.lower[dimensions[i]];
+    };
+
+    std::vector< std::size_t > order(nslices);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return std::make_tuple(group(a), line(a)) < std::make_tuple(group(b), line(b));
+    });
+
+    std::vector< char > slab_buffer;
+    for (auto first = order.begin(); first != order.end();) {
+        std::size_t const head = *first;
+        int const level = subcubes[head].lod;
+        int const first_plane = line(head) >> level;
+        std::int64_t const plane_size = positions[head + 1] - positions[head];
+
+        auto last = std::next(first);
+        std::int64_t nrequested = 1;
+        for (; last != order.end() and group(*last) == group(head); ++last) {
+            std::int64_t const nplanes = (line(*last) >> level) - first_plane + 1;
+            if (nplanes > max_slab_overread * (nrequested + 1)) break;
+            if (nplanes * plane_size > max_slab_size) break;
+            ++nrequested;
+        }
+
+        if (nrequested == 1) {
+            datahandle.read_subcube(
+                data.get() + positions[head],
+                plane_size,
+                subcubes[head]
+            );
+            first = last;
+            continue;
+        }
+
+        int const dimension = dimensions[head];
+        SubCube slab(subcubes[head]);
+        slab.bounds.upper[dimension] = line(*std::prev(last)) + 1;
+
+        std::int64_t const slab_size = datahandle.subcube_buffer_size(slab);
+        slab_buffer.resize(slab_size);
+        datahandle.read_subcube(slab_buffer.data(), slab_size, slab);
+
+        for (; first != last; ++first) {
+            copy_plane(
+                reinterpret_cast< float const* >(slab_buffer.data()),
+                slab,
+                dimension,
+                (line(*first) >> level) - first_plane,
+                reinterpret_cast< float* >(data.get() + positions[*first])
+            );
+        }
+    }
+
+    /*
+     * Encode the slices one by one, packing them towards the start of the
+     * buffer. An encoded slice never ends past the start of the next float
+     * slice, so every slice is read before it is overwritten.
+     */
+    offsets[0] = 0;
+    for (std::size_t i = 0; i < nslices; ++i) {
+        std::size_t const nsamples = (positions[i + 1] - positions[i]) / sizeof(float);
+        if (not encodings) {
+            offsets[i + 1] = positions[i + 1];
+            continue;
+        }
+
+        encode_samples(
+            reinterpret_cast< float const* >(data.get() + positions[i]),
+            nsamples,
+            &encodings[i],
+            data.get() + offsets[i]
+        );
+        offsets[i + 1] = offsets[i] + nsamples * sample_size(encodings[i].format);
+    }
+
+    return to_response(std::move(data), offsets[nslices], out);
+}
+
+void configure_fence_sorting(std::size_t min_points) noexcept (true) {
+    ::fence_sort_min_points.store(min_points);
+}
+
+void configure_fence_deduplication(float epsilon) noexcept (false) {
+    if (not (epsilon >= 0)) {
+        throw std::invalid_argument("Epsilon must be non-negative");
+    }
+    ::fence_dedup_epsilon.store(epsilon);
 }
 
 void fence(
@@ -166,7 +1075,9 @@ void fence(
     const float* coordinates,
     size_t npoints,
     enum interpolation_method interpolation_method,
+    Bound const* sample_window,
     const float* fillValue,
+    SampleEncoding* encoding,
     response* out
 ) {
     MetadataHandle const& metadata = datahandle.get_metadata();
@@ -175,37 +1086,44 @@ void fence(
 
     std::unique_ptr< voxel[] > coords(new voxel[npoints]{{0}});
 
-    CoordinateTransformer const& coordinate_transformer = metadata.coordinate_transformer();
-    auto transform_coordinate = [&] (const float x, const float y) {
-        switch (coordinate_system) {
-            case INDEX:
-                return coordinate_transformer.IJKPositionToAnnotation({x, y, 0});
-            case ANNOTATION:
-                return OpenVDS::Vector<double, 3> {x, y, 0};
-            case CDP:
-                return coordinate_transformer.WorldToAnnotation({x, y, 0});
-            default: {
-                throw std::runtime_error("Unhandled coordinate system");
-            }
-        }
-    };
     Axis inline_axis    = metadata.iline();
     Axis crossline_axis = metadata.xline();
-    Axis samples_axis   = metadata.sample();
-    auto nsamples       = samples_axis.nsamples();
+    SampleWindow const window = ::fence_window(metadata, sample_window);
+    auto nsamples       = window.nsamples();
+
+    HorizontalTransform const transform =
+        metadata.coordinate_transformer().horizontal_transform(
+            coordinate_system,
+            inline_axis,
+            crossline_axis
+        );
 
+    std::vector< double > x(npoints);
+    std::vector< double > y(npoints);
     for (size_t i = 0; i < npoints; i++) {
-        const float x = *(coordinates++);
-        const float y = *(coordinates++);
+        x[i] = coordinates[2 * i];
+        y[i] = coordinates[2 * i + 1];
+    }
+
+    std::vector< double > inline_positions(npoints);
+    std::vector< double > crossline_positions(npoints);
+    transform.to_sample_positions(
+        x.data(),
+        y.data(),
+        npoints,
+        inline_positions.data(),
+        crossline_positions.data()
+    );
 
-        auto coordinate = transform_coordinate(x, y);
+    for (size_t i = 0; i < npoints; i++) {
+        double const position[] = { inline_positions[i], crossline_positions[i] };
 
-        auto validate_boundary = [&] (const int voxel, Axis const& axis) {
-            if (!axis.inrange_with_margin(coordinate[voxel])) {
+        auto validate_boundary = [&] (const int voxel) {
+            if (!transform.inrange_with_margin(voxel, position[voxel])) {
                 if (fillValue == nullptr) {
                     const std::string coordinate_str =
-                        "(" +utils::to_string_with_precision(x, 6) + "," +
-                        utils::to_string_with_precision(y, 6) + ")";
+                        "(" +utils::to_string_with_precision(float(x[i]), 6) + "," +
+                        utils::to_string_with_precision(float(y[i]), 6) + ")";
                     throw detail::bad_request(
                         "Coordinate " + coordinate_str + " is out of boundaries "+
                         "in dimension "+ std::to_string(voxel)+ "."
@@ -215,31 +1133,41 @@ void fence(
             }
         };
 
-        validate_boundary(0, inline_axis);
-        validate_boundary(1, crossline_axis);
+        validate_boundary(0);
+        validate_boundary(1);
 
-        coords[i][   inline_axis.dimension()] = inline_axis.to_sample_position(coordinate[0]);
-        coords[i][crossline_axis.dimension()] = crossline_axis.to_sample_position(coordinate[1]);
+        coords[i][   inline_axis.dimension()] = position[0];
+        coords[i][crossline_axis.dimension()] = position[1];
     }
 
-    std::int64_t const size = datahandle.traces_buffer_size(npoints);
+    std::int64_t const size = window.full
+        ? datahandle.traces_buffer_size(npoints)
+        : datahandle.samples_buffer_size(npoints * nsamples);
 
     std::unique_ptr< char[] > data(new char[size]);
 
-    datahandle.read_traces(
+    read_fence_traces(
+        datahandle,
         data.get(),
         size,
         coords.get(),
         npoints,
-        interpolation_method
+        inline_axis.dimension(),
+        crossline_axis.dimension(),
+        interpolation_method,
+        window
     );
     if (!noval_indicies.empty()){
             write_fillvalue(data.get(), noval_indicies, nsamples, *fillValue);
     }
-    return to_response(std::move(data), size, out);
+    return to_response(std::move(data), size, encoding, out);
 }
 
 
+void configure_subvolume_trace_reads(bool enabled) noexcept (true) {
+    ::subvolume_trace_reads.store(enabled);
+}
+
 void fetch_subvolume(
     DataHandle& datahandle,
     SurfaceBoundedSubVolume& subvolume,
@@ -253,55 +1181,125 @@ void fetch_subvolume(
     }
 
     MetadataHandle const& metadata = datahandle.get_metadata();
-    CoordinateTransformer const& transform = metadata.coordinate_transformer();
 
     auto iline  = metadata.iline ();
     auto xline  = metadata.xline();
     auto sample = metadata.sample();
 
+    HorizontalTransform const transform =
+        metadata.coordinate_transformer().horizontal_transform(CDP, iline, xline);
+    GridSamplePositions positions(transform, horizontal_grid);
+
     std::size_t const nsamples = subvolume.nsamples(from, to);
     if (nsamples == 0){
         return;
     }
-    std::unique_ptr< voxel[] > samples(new voxel[nsamples]{{0}});
 
-    std::size_t cur = 0;
-    for (int i = from; i < to; ++i) {
-        if (subvolume.is_empty(i)) {
-            continue;
+    /*
+     * Segments that are aligned with the samples are read as trace windows
+     * when enabled. The remaining segments are read sample by sample.
+     */
+    bool const trace_reads = ::subvolume_trace_reads.load();
+    std::vector< TraceWindow > windows;
+    std::vector< std::size_t > remaining;
+    std::size_t nremaining = 0;
+    std::size_t ncounted = 0;
+    std::size_t nsegments = 0;
+    for (auto const& span : subvolume.spans(from, to)) {
+        nsegments += span.last - span.first;
+        for (std::size_t i = span.first; i < span.last; ++i) {
+            auto segment = subvolume.stored_segment(i);
+            ncounted += segment.size();
+            double const k = sample.to_sample_position(segment.top_sample_position());
+
+            TraceWindow window{ i, 0, 0 };
+            if (trace_reads and
+                to_trace_window(k, static_cast< int >(segment.size()), sample.nsamples(), window)
+            ) {
+                windows.push_back(window);
+                continue;
+            }
+            remaining.push_back(i);
+            nremaining += segment.size();
+        }
+    }
+
+    /* Empty segments take up samples in subvolumes with a stride */
+    std::size_t const npadding = subvolume.stride() * (to - from - nsegments);
+    if (ncounted + npadding != nsamples){
+        throw std::runtime_error("calculated nsamples " + std::to_string(nsamples) +
+                                 " and actual samples " + std::to_string(ncounted) + " differ");
+    }
+
+    if (not windows.empty()) {
+        std::unique_ptr< voxel[] > traces(new voxel[windows.size()]{{0}});
+        for (std::size_t i = 0; i < windows.size(); ++i) {
+            auto const ij = positions.at(windows[i].segment);
+            traces[i][ iline.dimension() ] = ij.first;
+            traces[i][ xline.dimension() ] = ij.second;
         }
+        read_subvolume_windows(
+            datahandle,
+            subvolume,
+            windows,
+            traces.get(),
+            interpolation
+        );
+    }
+
+    if (nremaining == 0) {
+        return;
+    }
 
-        auto segment = subvolume.vertical_segment(i);
+    std::unique_ptr< voxel[] > samples(new voxel[nremaining]{{0}});
 
-        auto const cdp = horizontal_grid.to_cdp(i);
-        auto ij = transform.WorldToAnnotation({cdp.x, cdp.y, 0});
+    std::size_t cur = 0;
+    for (std::size_t i : remaining) {
+        auto segment = subvolume.stored_segment(i);
 
-        ij[0]  = iline.to_sample_position(ij[0]);
-        ij[1]  = xline.to_sample_position(ij[1]);
+        auto const ij = positions.at(i);
 
         double k = sample.to_sample_position(segment.top_sample_position());
         for (int idx = 0; idx < segment.size(); ++idx) {
-            samples[cur][  iline.dimension() ] = ij[0];
-            samples[cur][  xline.dimension() ] = ij[1];
+            samples[cur][  iline.dimension() ] = ij.first;
+            samples[cur][  xline.dimension() ] = ij.second;
             samples[cur][ sample.dimension() ] = k + idx;
             ++cur;
         }
     }
 
-    if (cur != nsamples){
-        throw std::runtime_error("calculated nsamples " + std::to_string(nsamples) +
-                                 " and actual samples " + std::to_string(cur) + " differ");
+    auto const size = datahandle.samples_buffer_size(nremaining);
+
+    /*
+     * Without trace windows or empty segments in between, the segments are
+     * contiguous in the subvolume
+     */
+    if (nremaining == nsamples) {
+        datahandle.read_samples(
+            subvolume.data(from),
+            size,
+            samples.get(),
+            nremaining,
+            interpolation
+        );
+        return;
     }
 
-    auto const size = datahandle.samples_buffer_size(nsamples);
-
+    std::unique_ptr< float[] > data(new float[nremaining]);
     datahandle.read_samples(
-        subvolume.data(from),
+        data.get(),
         size,
         samples.get(),
-        nsamples,
+        nremaining,
         interpolation
     );
+
+    float const* src = data.get();
+    for (std::size_t i : remaining) {
+        auto const count = subvolume.stored_segment(i).size();
+        std::copy(src, src + count, subvolume.data(i));
+        src += count;
+    }
 }
 
 
@@ -316,35 +1314,294 @@ void attributes(
 ) {
     std::size_t size = src_subvolume.horizontal_grid().size() * sizeof(float);
 
-    std::vector< std::unique_ptr< AttributeMap > > attrs;
-    for (int i = 0; i < nattributes; ++i) {
-        void* dst = out[i];
-        switch (*attributes) {
-            case VALUE:    { append(attrs,   Value(dst, size)     );   break; }
-            case MIN:      { append(attrs,   Min(dst, size)       );   break; }
-            case MINAT:    { append(attrs,   MinAt(dst, size)     );   break; }
-            case MAX:      { append(attrs,   Max(dst, size)       );   break; }
-            case MAXAT:    { append(attrs,   MaxAt(dst, size)     );   break; }
-            case MAXABS:   { append(attrs,   MaxAbs(dst, size)    );   break; }
-            case MAXABSAT: { append(attrs,   MaxAbsAt(dst, size)  );   break; }
-            case MEAN:     { append(attrs,   Mean(dst, size)      );   break; }
-            case MEANABS:  { append(attrs,   MeanAbs(dst, size)   );   break; }
-            case MEANPOS:  { append(attrs,   MeanPos(dst, size)   );   break; }
-            case MEANNEG:  { append(attrs,   MeanNeg(dst, size)   );   break; }
-            case MEDIAN:   { append(attrs,   Median(dst, size)    );   break; }
-            case RMS:      { append(attrs,   Rms(dst, size)       );   break; }
-            case VAR:      { append(attrs,   Var(dst, size)       );   break; }
-            case SD:       { append(attrs,   Sd(dst, size)        );   break; }
-            case SUMPOS:   { append(attrs,   SumPos(dst, size)    );   break; }
-            case SUMNEG:   { append(attrs,   SumNeg(dst, size)    );   break; }
-
-            default:
-                throw std::runtime_error("Attribute not implemented");
-        }
-        ++attributes;
-    }
-
-    calc_attributes(src_subvolume, dst_segment_blueprint, attrs, from, to);
+    AttributeReducer reducer(attributes, nattributes, out, size);
+    calc_attributes(src_subvolume, dst_segment_blueprint, reducer, from, to);
+}
+
+void configure_attribute_memory(std::size_t budget) noexcept (true) {
+    TileBudget::instance().configure(budget);
+}
+
+void configure_attribute_prefetch(std::size_t depth) noexcept (true) {
+    ::attribute_prefetch_depth.store(depth);
+}
+
+void tiled_attributes(
+    DataHandle& datahandle,
+    SurfaceBoundedSubVolume const& subvolume,
+    enum interpolation_method interpolation,
+    ResampledSegmentBlueprint const* dst_segment_blueprint,
+    enum attribute* attributes,
+    std::size_t nattributes,
+    std::size_t from,
+    std::size_t to,
+    void** out
+) {
+    if (to > subvolume.horizontal_grid().size()) {
+        throw std::invalid_argument("'to' must be less than surface size");
+    }
+
+    /*
+     * With a budget, tiles are sized so that every core can work on a tile
+     * of its own without exceeding it. Tiles have at least one segment.
+     */
+    std::size_t const depth  = ::attribute_prefetch_depth.load();
+    std::size_t const budget = TileBudget::instance().capacity();
+    std::size_t const nthreads = available_cpus();
+    std::size_t max_tile_samples = subvolume.nsamples(from, to);
+    if (budget != 0) {
+        max_tile_samples = budget / nthreads / tile_sample_size;
+    } else if (depth != 0) {
+        max_tile_samples = prefetch_tile_samples;
+    }
+
+    auto fetch = [&](PendingTile* pending) {
+        fetch_subvolume(
+            datahandle,
+            pending->tile,
+            interpolation,
+            pending->first,
+            pending->last
+        );
+    };
+
+    /*
+     * Up to depth tiles are fetched in the background, on the io pool, while
+     * the oldest tile is resampled and reduced. Only the oldest tile waits for the budget.
+     * Tiles further ahead are only fetched when the budget has room for them
+     * right away, as tiles that wait for the budget while holding earlier
+     * tiles could block each other indefinitely.
+     */
+    std::deque< std::unique_ptr< PendingTile > > pending;
+    std::size_t next = from;
+    while (next < to or not pending.empty()) {
+        while (next < to and pending.size() <= depth) {
+            std::size_t last = next + 1;
+            while (last < to and subvolume.nsamples(next, last + 1) <= max_tile_samples) {
+                ++last;
+            }
+
+            std::size_t const size = subvolume.nsamples(next, last) * tile_sample_size;
+            std::unique_ptr< TileReservation > reservation;
+            if (pending.empty()) {
+                reservation.reset(new TileReservation(size));
+            } else {
+                reservation.reset(new TileReservation(size, std::try_to_lock));
+                if (not reservation->owns()) break;
+            }
+
+            std::unique_ptr< PendingTile > tile(
+                new PendingTile(subvolume, next, last, std::move(reservation))
+            );
+            if (pending.empty()) {
+                fetch(tile.get());
+            } else {
+                PendingTile* const target = tile.get();
+                tile->fetched = ThreadPool::io_instance().submit(
+                    [&fetch, target] { fetch(target); }
+                );
+            }
+            pending.push_back(std::move(tile));
+            next = last;
+        }
+
+        std::unique_ptr< PendingTile > tile = std::move(pending.front());
+        pending.pop_front();
+        if (tile->fetched.valid()) tile->fetched.get();
+
+        cppapi::attributes(
+            tile->tile,
+            dst_segment_blueprint,
+            attributes,
+            nattributes,
+            tile->first,
+            tile->last,
+            out
+        );
+    }
+}
+
+void horizon_values(
+    DataHandle& datahandle,
+    SurfaceBoundedSubVolume const& subvolume,
+    enum interpolation_method interpolation,
+    ResampledSegmentBlueprint const* dst_segment_blueprint,
+    std::size_t from,
+    std::size_t to,
+    float* out
+) {
+    auto const horizontal_grid = subvolume.horizontal_grid();
+    if (to > horizontal_grid.size()) {
+        throw std::invalid_argument("'to' must be less than surface size");
+    }
+
+    MetadataHandle const& metadata = datahandle.get_metadata();
+
+    auto iline  = metadata.iline();
+    auto xline  = metadata.xline();
+    auto sample = metadata.sample();
+
+    HorizontalTransform const transform =
+        metadata.coordinate_transformer().horizontal_transform(CDP, iline, xline);
+    GridSamplePositions positions(transform, horizontal_grid);
+
+    /*
+     * The reference is placed in the segment exactly as resample places the
+     * destination samples, and is copied rather than interpolated when
+     * resample would copy the samples
+     */
+    double const src_stepsize = sample.stepsize();
+    double const step = dst_segment_blueprint->stepsize() / src_stepsize;
+    ResampledSegment dst_segment(0, 0, 0, dst_segment_blueprint);
+
+    std::vector< HorizonCell > cells;
+    std::size_t nsamples = 0;
+    float const fillvalue = subvolume.fillvalue();
+    std::size_t next = from;
+    for (auto const& span : subvolume.spans(from, to)) {
+        std::fill(out + next, out + span.first, fillvalue);
+        next = span.last;
+
+        for (std::size_t i = span.first; i < span.last; ++i) {
+            subvolume.reinitialize(i, dst_segment);
+            auto const extent = subvolume.extent(i);
+            if (extent.size < 4) {
+                throw std::domain_error("Must be at least four data points.");
+            }
+
+            double const src_top = extent.top_sample_position;
+            double const k = sample.to_sample_position(extent.top_sample_position);
+            double const first = (dst_segment.top_sample_position() - src_top) / src_stepsize;
+            std::size_t const reference = dst_segment.reference_index();
+
+            long const n = extent.size;
+            long const m = dst_segment.size();
+            double const top    = std::round(first);
+            double const bottom = top + (m - 1);
+            if (std::abs(first - top) < 1e-3 and
+                std::abs(first + (m - 1) * step - bottom) < 1e-3 and
+                top >= 0 and bottom <= n - 1)
+            {
+                cells.push_back({ i, k + top + reference, 1, 0 });
+                ++nsamples;
+                continue;
+            }
+
+            double const position = std::min(std::max(first + reference * step, 0.0), n - 1.0);
+            long const interval = std::min(static_cast< long >(position), n - 2);
+            long const lower = std::max(0l, interval - makima_reach);
+            long const upper = std::min(n - 1, interval + 1 + makima_reach);
+            int const count = upper - lower + 1;
+            cells.push_back({ i, k + lower, count, position - lower });
+            nsamples += count;
+        }
+    }
+    std::fill(out + next, out + to, fillvalue);
+
+    if (nsamples == 0) {
+        return;
+    }
+
+    std::unique_ptr< voxel[] > samples(new voxel[nsamples]{{0}});
+    std::size_t cur = 0;
+    for (auto const& cell : cells) {
+        auto const ij = positions.at(cell.index);
+        for (int idx = 0; idx < cell.count; ++idx) {
+            samples[cur][  iline.dimension() ] = ij.first;
+            samples[cur][  xline.dimension() ] = ij.second;
+            samples[cur][ sample.dimension() ] = cell.first + idx;
+            ++cur;
+        }
+    }
+
+    std::unique_ptr< float[] > data(new float[nsamples]);
+    datahandle.read_samples(
+        data.get(),
+        datahandle.samples_buffer_size(nsamples),
+        samples.get(),
+        nsamples,
+        interpolation
+    );
+
+    Makima makima;
+    float const* src = data.get();
+    for (auto const& cell : cells) {
+        if (cell.count == 1) {
+            out[cell.index] = *src;
+        } else {
+            double value;
+            makima.interpolate(src, cell.count, cell.position, 1, &value, 1);
+            out[cell.index] = value;
+        }
+        src += cell.count;
+    }
+}
+
+void parallel_attributes(
+    DataHandle& datahandle,
+    SurfaceBoundedSubVolume const& subvolume,
+    enum interpolation_method interpolation,
+    ResampledSegmentBlueprint const* dst_segment_blueprint,
+    enum attribute* attributes,
+    std::size_t nattributes,
+    std::size_t from,
+    std::size_t to,
+    void** out
+) {
+    if (to > subvolume.horizontal_grid().size()) {
+        throw std::invalid_argument("'to' must be less than surface size");
+    }
+
+    /*
+     * A few tasks per thread, so that threads that finish early can steal
+     * the remaining tasks of others
+     */
+    ThreadPool& pool = ThreadPool::instance();
+
+    /*
+     * Values along the reference surface need neither the segments nor
+     * resampling, and every cell costs about the same
+     */
+    bool const values_only = nattributes > 0 and std::all_of(
+        attributes,
+        attributes + nattributes,
+        [](enum attribute attribute) { return attribute == VALUE; }
+    );
+    if (values_only) {
+        std::size_t const ntasks = std::min(pool.size() * 4, to - from);
+        float* values = static_cast< float* >(out[0]);
+        pool.parallel_for(ntasks, [&](std::size_t i) {
+            horizon_values(
+                datahandle,
+                subvolume,
+                interpolation,
+                dst_segment_blueprint,
+                from + (to - from) * i / ntasks,
+                from + (to - from) * (i + 1) / ntasks,
+                values
+            );
+        });
+        for (std::size_t i = 1; i < nattributes; ++i) {
+            std::copy(values + from, values + to, static_cast< float* >(out[i]) + from);
+        }
+        return;
+    }
+
+    auto const boundaries = subvolume.partition(from, to, pool.size() * 4);
+
+    pool.parallel_for(boundaries.size() - 1, [&](std::size_t i) {
+        tiled_attributes(
+            datahandle,
+            subvolume,
+            interpolation,
+            dst_segment_blueprint,
+            attributes,
+            nattributes,
+            boundaries[i],
+            boundaries[i + 1],
+            out
+        );
+    });
 }
 
 namespace {
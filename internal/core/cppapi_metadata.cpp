@@ -34,6 +34,29 @@ std::string fmtstr(OpenVDS::VolumeDataFormat format) {
     }
 }
 
+/*
+ * The samples are read as f4 (see above), but may be encoded in a smaller
+ * format before they are returned.
+ */
+void json_encoding(SampleEncoding const* encoding, nlohmann::json& meta) {
+    if (not encoding) {
+        meta["format"] = fmtstr(SingleDataHandle::format());
+        return;
+    }
+
+    switch (encoding->format) {
+        case FLOAT32: meta["format"] = "<f4"; return;
+        case FLOAT16: meta["format"] = "<f2"; return;
+        case INT16:   meta["format"] = "<i2"; break;
+        case INT8:    meta["format"] = "|i1"; break;
+        default: {
+            throw std::runtime_error("Unhandled sample format");
+        }
+    }
+    meta["scale"]  = encoding->scale;
+    meta["offset"] = encoding->offset;
+}
+
 void to_response(nlohmann::json const& metadata, response* response) {
     auto const dump = metadata.dump();
     std::unique_ptr< char[] > tmp(new char[dump.size()]);
@@ -47,14 +70,12 @@ nlohmann::json json_axis(
     Axis const& axis,
     SubCube const& subcube
 ) {
-    auto const& lower = subcube.bounds.lower;
-    auto const& upper = subcube.bounds.upper;
-
     int dim = axis.dimension();
 
-    float min = axis.min() + axis.stepsize() * lower[dim];
-    float max = axis.min() + axis.stepsize() * (upper[dim] - 1); // inclusive
-    std::size_t samples = upper[dim] - lower[dim];
+    float min = axis.min() + axis.stepsize() * subcube.first(dim);
+    float max = axis.min() + axis.stepsize() * subcube.last(dim); // inclusive
+    std::size_t samples = subcube.nsamples(dim);
+    float stepsize = axis.stepsize() * (1 << subcube.lod);
 
     nlohmann::json doc;
     doc = {
@@ -62,12 +83,32 @@ nlohmann::json json_axis(
         { "min",        min             },
         { "max",        max             },
         { "samples",    samples         },
-        { "stepsize",   axis.stepsize() },
+        { "stepsize",   stepsize        },
         { "unit",       axis.unit()     },
     };
     return doc;
 }
 
+/*
+ * The line of the returned slice, in the coordinate system it was requested
+ * in. Above level of detail 0 only every 2^lod line is stored, and the slice
+ * is the stored line at or before the requested line.
+ */
+float json_lineno(
+    Axis const& axis,
+    SubCube const& subcube,
+    enum coordinate_system const system
+) {
+    int const voxelline = subcube.first(axis.dimension());
+    switch (system) {
+        case ANNOTATION: return axis.min() + axis.stepsize() * voxelline;
+        case INDEX:      return voxelline;
+        default: {
+            throw std::runtime_error("Unhandled coordinate system");
+        }
+    }
+}
+
 nlohmann::json json_slice_geospatial(
     MetadataHandle const& metadata,
     Direction const direction,
@@ -78,16 +119,16 @@ nlohmann::json json_slice_geospatial(
     auto const& transformer = metadata.coordinate_transformer();
 
     auto const lower = transformer.VoxelIndexToIJKIndex({
-        bounds.bounds.lower[0],
-        bounds.bounds.lower[1],
-        bounds.bounds.lower[2]
+        bounds.first(0),
+        bounds.first(1),
+        bounds.first(2)
     });
 
-    // The upper bound is exclusive, while we need it to be inclusive
+    // The last sample is inclusive, contrary to the upper bound
     auto const upper = transformer.VoxelIndexToIJKIndex({
-        bounds.bounds.upper[0] - 1,
-        bounds.bounds.upper[1] - 1,
-        bounds.bounds.upper[2] - 1
+        bounds.last(0),
+        bounds.last(1),
+        bounds.last(2)
     });
 
     /** The slice bounds are given by the lower- and upper-coordinates only:
@@ -147,13 +188,15 @@ void slice_metadata(
     Direction const direction,
     int lineno,
     std::vector< Bound > const& slicebounds,
+    LevelOfDetail const& lod,
+    SampleEncoding const* encoding,
     response* out
 ) {
     MetadataHandle const& metadata = datahandle.get_metadata();
     auto const& axis = metadata.get_axis(direction);
 
     nlohmann::json meta;
-    meta["format"] = fmtstr(SingleDataHandle::format());
+    json_encoding(encoding, meta);
 
     Axis const& inline_axis = metadata.iline();
     Axis const& crossline_axis = metadata.xline();
@@ -162,16 +205,14 @@ void slice_metadata(
     SubCube bounds(metadata);
     bounds.constrain(metadata, slicebounds);
     bounds.set_slice(axis, lineno, direction.coordinate_system());
-
-    auto const& lower = bounds.bounds.lower;
-    auto const& upper = bounds.bounds.upper;
+    bounds.set_lod(lod, datahandle.max_lod());
 
     auto json_shape = [&](Axis const &x, Axis const &y) {
         meta["x"] = json_axis(x, bounds);
         meta["y"] = json_axis(y, bounds);
         meta["shape"] = nlohmann::json::array({
-            upper[y.dimension()] - lower[y.dimension()],
-            upper[x.dimension()] - lower[x.dimension()],
+            bounds.nsamples(y.dimension()),
+            bounds.nsamples(x.dimension()),
         });
     };
 
@@ -189,6 +230,7 @@ void slice_metadata(
             throw std::runtime_error("Unhandled direction");
     }
 
+    meta["lineno"] = json_lineno(axis, bounds, direction.coordinate_system());
     meta["geospatial"] = json_slice_geospatial(
         metadata,
         direction,
@@ -202,14 +244,24 @@ void slice_metadata(
 void fence_metadata(
     DataHandle& datahandle,
     size_t npoints,
+    Bound const* sample_window,
+    SampleEncoding const* encoding,
     response* out
 ) {
     MetadataHandle const& metadata = datahandle.get_metadata();
 
+    SubCube window(metadata);
+    if (sample_window) {
+        window.constrain(metadata, { *sample_window });
+    }
+
     nlohmann::json meta;
     Axis const& sample_axis = metadata.sample();
-    meta["shape"] = nlohmann::json::array({npoints, sample_axis.nsamples()});
-    meta["format"] = fmtstr(SingleDataHandle::format());
+    meta["shape"] = nlohmann::json::array({
+        npoints,
+        window.nsamples(sample_axis.dimension())
+    });
+    json_encoding(encoding, meta);
 
     return to_response(meta, out);
 }
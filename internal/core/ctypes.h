@@ -68,4 +68,44 @@ struct Bound {
     enum axis_name name;
 };
 
+/* A single slice of a batch, given by its direction and line number */
+struct SliceLine {
+    enum axis_name direction;
+    int            lineno;
+};
+
+/*
+ * Level of detail (LOD) of a slice. Level 0 is full resolution and every
+ * following level halves the resolution in all dimensions.
+ *
+ * A negative level picks the level automatically: the coarsest one at which
+ * the longest side of the slice still has at least target_size samples.
+ * target_size is ignored otherwise.
+ */
+struct LevelOfDetail {
+    int    level;
+    size_t target_size;
+};
+
+enum sample_format {
+    FLOAT32 = 0,
+    FLOAT16 = 1,
+    INT16   = 2,
+    INT8    = 3,
+};
+
+/*
+ * Encoding of the samples in a response. The scaled integer formats decode as
+ *
+ *     value = offset + scale * sample
+ *
+ * except for the lowest value of the type, which marks samples without a
+ * finite value. scale and offset are unused for the float formats.
+ */
+struct SampleEncoding {
+    enum sample_format format;
+    float              scale;
+    float              offset;
+};
+
 #endif // ONESEISMIC_API_CTYPES_H
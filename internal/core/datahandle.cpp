@@ -1,10 +1,17 @@
 #include "datahandle.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
 #include <stdexcept>
+#include <string>
+#include <utility>
 
 #include <OpenVDS/KnownMetadata.h>
 #include <OpenVDS/OpenVDS.h>
 
+#include "chunkcache.hpp"
 #include "exceptions.hpp"
 #include "metadatahandle.hpp"
 #include "subcube.hpp"
@@ -25,8 +32,214 @@ OpenVDS::InterpolationMethod to_interpolation(interpolation_method interpolation
     }
 }
 
+std::atomic< std::size_t > max_subcube_requests(1);
+
+/* Max total size of the chunks touched by a read through the chunk cache */
+std::size_t constexpr max_cached_subcube_size = 256 * 1024 * 1024;
+
+/*
+ * Identity of a VDS in the chunk cache. Azure urls only name the container
+ * and blob, the storage account is given by the BlobEndpoint of the
+ * connection string. The rest of the connection string, e.g. the SAS token,
+ * is left out so that requests with different tokens share cached chunks.
+ */
+std::string vds_identity(
+    std::string const& url,
+    std::string const& credentials
+) noexcept (false) {
+    std::string const key = "BlobEndpoint=";
+    auto const begin = credentials.find(key);
+    if (begin == std::string::npos) return url;
+
+    auto const end = credentials.find(';', begin);
+    return credentials.substr(begin, end - begin) + ";" + url;
+}
+
+/*
+ * Wait for all requests to complete, even when some of them fail, as the
+ * requests write to buffers owned by the caller.
+ */
+void wait_for_completion(
+    VolumeDataRequests const& requests
+) noexcept (false) {
+    bool success = true;
+    for (auto const& request : requests) {
+        success = request->WaitForCompletion() and success;
+    }
+
+    if (!success) {
+        throw std::runtime_error("Failed to read from VDS.");
+    }
+}
+
+void wait_for_completion(
+    PendingRead const& read
+) noexcept (false) {
+    ::wait_for_completion(read.requests);
+    for (auto const& complete : read.completions) {
+        complete();
+    }
+}
+
+void append(
+    PendingRead& read,
+    std::shared_ptr< OpenVDS::VolumeDataRequest > request
+) noexcept (false) {
+    read.requests.push_back(std::move(request));
+}
+
+void append(
+    PendingRead& read,
+    PendingRead other
+) noexcept (false) {
+    read.requests.insert(
+        read.requests.end(),
+        other.requests.begin(),
+        other.requests.end()
+    );
+    read.completions.insert(
+        read.completions.end(),
+        std::make_move_iterator(other.completions.begin()),
+        std::make_move_iterator(other.completions.end())
+    );
+}
+
+/*
+ * Issue both requests before waiting for any of them, so that the total
+ * latency is bound by the slowest request rather than the sum of them.
+ */
+template< typename RequestA, typename RequestB >
+void read_concurrently(
+    RequestA request_a,
+    RequestB request_b
+) noexcept (false) {
+    PendingRead read;
+    ::append(read, request_a());
+
+    try {
+        ::append(read, request_b());
+    } catch (...) {
+        for (auto const& request : read.requests) {
+            request->WaitForCompletion();
+        }
+        throw;
+    }
+
+    ::wait_for_completion(read);
+}
+
+/*
+ * Copy the part of chunk that overlaps subcube into the subcube buffer. Both
+ * are at the same level of detail, with dimension 0 the fastest.
+ */
+void copy_chunk(
+    float const*   chunk,
+    SubCube const& chunk_bounds,
+    SubCube const& subcube,
+    float*         buffer
+) noexcept (true) {
+    int const lod = subcube.lod;
+    int constexpr ndims = OpenVDS::Dimensionality_Max;
+
+    int begin[ndims];
+    int end[ndims];
+    int chunk_first[ndims];
+    int subcube_first[ndims];
+    std::int64_t chunk_stride[ndims];
+    std::int64_t subcube_stride[ndims];
+
+    std::int64_t chunk_size   = 1;
+    std::int64_t subcube_size = 1;
+    for (int d = 0; d < ndims; ++d) {
+        chunk_first[d]   = chunk_bounds.bounds.lower[d] >> lod;
+        subcube_first[d] = subcube.bounds.lower[d] >> lod;
+        begin[d] = std::max(chunk_first[d], subcube_first[d]);
+        end[d]   = std::min(
+            chunk_first[d]   + chunk_bounds.nsamples(d),
+            subcube_first[d] + subcube.nsamples(d)
+        );
+        if (begin[d] >= end[d]) return;
+
+        chunk_stride[d]   = chunk_size;
+        subcube_stride[d] = subcube_size;
+        chunk_size   *= chunk_bounds.nsamples(d);
+        subcube_size *= subcube.nsamples(d);
+    }
+
+    /* Copy one row along dimension 0 at a time */
+    std::size_t const row = end[0] - begin[0];
+    int position[ndims];
+    std::copy(begin, begin + ndims, position);
+    while (true) {
+        std::int64_t src = 0;
+        std::int64_t dst = 0;
+        for (int d = 0; d < ndims; ++d) {
+            src += (position[d] - chunk_first[d])   * chunk_stride[d];
+            dst += (position[d] - subcube_first[d]) * subcube_stride[d];
+        }
+        std::copy(chunk + src, chunk + src + row, buffer + dst);
+
+        int d = 1;
+        for (; d < ndims; ++d) {
+            if (++position[d] < end[d]) break;
+            position[d] = begin[d];
+        }
+        if (d == ndims) break;
+    }
+}
+
+/*
+ * Scratch buffers for DoubleDataHandle::read_traces, kept by every thread
+ * between calls
+ */
+struct TraceScratch {
+    std::vector<float> coordinates_a;
+    std::vector<float> coordinates_b;
+    std::vector<float> traces_a;
+    std::vector<float> traces_b;
+};
+
+/*
+ * Largest scratch, in bytes, a thread keeps after a call. Larger buffers are
+ * freed, so that a single large fence doesn't pin its buffers in every thread
+ * for the lifetime of the process.
+ */
+constexpr std::size_t max_kept_trace_scratch = 16 * 1024 * 1024;
+
+/* Frees the buffers of scratch when it goes out of scope, if they are large */
+class TraceScratchRelease {
+public:
+    explicit TraceScratchRelease(TraceScratch* scratch) : m_scratch(scratch) {}
+
+    ~TraceScratchRelease() {
+        std::vector<float>* buffers[] = {
+            &this->m_scratch->coordinates_a,
+            &this->m_scratch->coordinates_b,
+            &this->m_scratch->traces_a,
+            &this->m_scratch->traces_b,
+        };
+
+        std::size_t size = 0;
+        for (auto const* buffer : buffers) {
+            size += buffer->capacity() * sizeof(float);
+        }
+        if (size <= max_kept_trace_scratch) return;
+
+        for (auto* buffer : buffers) {
+            std::vector<float>().swap(*buffer);
+        }
+    }
+
+private:
+    TraceScratch* m_scratch;
+};
+
 } /* namespace */
 
+void configure_subcube_requests(std::size_t max_requests) noexcept (true) {
+    ::max_subcube_requests.store(std::max(max_requests, std::size_t(1)));
+}
+
 OpenVDS::VolumeDataFormat DataHandle::format() noexcept(true) {
     /*
      * We always want to request data in OpenVDS::VolumeDataFormat::Format_R32
@@ -45,14 +258,16 @@ SingleDataHandle make_single_datahandle(
     if(error.code != 0) {
         throw std::runtime_error("Could not open VDS: " + error.string);
     }
-    return SingleDataHandle(handle);
+    return SingleDataHandle(handle, ::vds_identity(url, credentials));
 }
 
-SingleDataHandle::SingleDataHandle(OpenVDS::VDSHandle handle)
-    :m_handle(handle), m_access_manager(OpenVDS::GetAccessManager(handle)), m_metadata(SingleMetadataHandle::create(m_access_manager.GetVolumeDataLayout())) {}
+SingleDataHandle::SingleDataHandle(OpenVDS::VDSHandle handle, std::string identity)
+    :m_handle(handle, [](OpenVDS::VDSHandle handle) { OpenVDS::Close(handle); }),
+     m_access_manager(OpenVDS::GetAccessManager(handle)), m_metadata(SingleMetadataHandle::create(m_access_manager.GetVolumeDataLayout())),
+     m_identity(std::move(identity)) {}
 
 void SingleDataHandle::close() {
-    OpenVDS::Close(m_handle);
+    this->m_handle.reset();
 }
 
 SingleMetadataHandle const& SingleDataHandle::get_metadata() const noexcept(true) {
@@ -68,6 +283,16 @@ OpenVDS::VolumeDataFormat SingleDataHandle::format() noexcept(true) {
     return OpenVDS::VolumeDataFormat::Format_R32;
 }
 
+int SingleDataHandle::max_lod() noexcept (false) {
+    auto const* layout = this->m_access_manager.GetVolumeDataLayout();
+    return layout->GetLayoutDescriptor().GetLODLevels();
+}
+
+int SingleDataHandle::bricksize() noexcept (false) {
+    auto const* layout = this->m_access_manager.GetVolumeDataLayout();
+    return 1 << layout->GetLayoutDescriptor().GetBrickSize();
+}
+
 std::int64_t SingleDataHandle::subcube_buffer_size(
     SubCube const& subcube
 ) noexcept (false) {
@@ -75,7 +300,7 @@ std::int64_t SingleDataHandle::subcube_buffer_size(
         subcube.bounds.lower,
         subcube.bounds.upper,
         SingleDataHandle::format(),
-        SingleDataHandle::lod_level,
+        subcube.lod,
         SingleDataHandle::channel
     );
 
@@ -87,21 +312,178 @@ void SingleDataHandle::read_subcube(
     std::int64_t size,
     SubCube const& subcube
 ) noexcept (false) {
-    auto request = this->m_access_manager.RequestVolumeSubset(
-        buffer,
-        size,
-        OpenVDS::Dimensions_012,
-        SingleDataHandle::lod_level,
-        SingleDataHandle::channel,
-        subcube.bounds.lower,
-        subcube.bounds.upper,
-        SingleDataHandle::format()
+    ::wait_for_completion(this->request_subcube(buffer, size, subcube));
+}
+
+PendingRead SingleDataHandle::request_subcube(
+    void* const buffer,
+    std::int64_t size,
+    SubCube const& subcube
+) noexcept (false) {
+    if (ChunkCache::instance().enabled()) {
+        return this->request_cached_subcube(buffer, size, subcube);
+    }
+
+    return this->request_uncached_subcube(buffer, size, subcube);
+}
+
+PendingRead SingleDataHandle::request_uncached_subcube(
+    void* const buffer,
+    std::int64_t size,
+    SubCube const& subcube
+) noexcept (false) {
+    auto const pieces = subcube.split(
+        this->bricksize() << subcube.lod,
+        ::max_subcube_requests.load()
     );
-    bool const success = request.get()->WaitForCompletion();
 
-    if (!success) {
-        throw std::runtime_error("Failed to read from VDS.");
+    PendingRead read;
+    char* piece_buffer = static_cast< char* >(buffer);
+    try {
+        for (auto const& piece : pieces) {
+            std::int64_t const piece_size = std::min(
+                this->subcube_buffer_size(piece),
+                size
+            );
+
+            read.requests.push_back(this->m_access_manager.RequestVolumeSubset(
+                piece_buffer,
+                piece_size,
+                OpenVDS::Dimensions_012,
+                piece.lod,
+                SingleDataHandle::channel,
+                piece.bounds.lower,
+                piece.bounds.upper,
+                SingleDataHandle::format()
+            ));
+
+            piece_buffer += piece_size;
+            size         -= piece_size;
+        }
+    } catch (...) {
+        for (auto const& request : read.requests) {
+            request->WaitForCompletion();
+        }
+        throw;
     }
+
+    return read;
+}
+
+PendingRead SingleDataHandle::request_cached_subcube(
+    void* const buffer,
+    std::int64_t size,
+    SubCube const& subcube
+) noexcept (false) {
+    int constexpr ndims = OpenVDS::Dimensionality_Max;
+
+    if (size < this->subcube_buffer_size(subcube)) {
+        throw std::invalid_argument("Buffer too small for subcube");
+    }
+
+    auto const* layout = this->m_access_manager.GetVolumeDataLayout();
+    int const dimensionality = layout->GetDimensionality();
+    int const bricksize = this->bricksize();
+
+    /*
+     * Chunks are bricks at the level of detail of the subcube, which in full
+     * resolution voxels span bricksize << lod along every dimension.
+     */
+    int const span = bricksize << subcube.lod;
+
+    int nsamples[ndims];
+    int first_chunk[ndims];
+    int last_chunk[ndims];
+    int nchunks[ndims];
+    for (int d = 0; d < ndims; ++d) {
+        nsamples[d]    = d < dimensionality ? layout->GetDimensionNumSamples(d) : 1;
+        nchunks[d]     = (nsamples[d] + span - 1) / span;
+        first_chunk[d] = subcube.bounds.lower[d] / span;
+        last_chunk[d]  = (subcube.bounds.upper[d] - 1) / span;
+    }
+
+    /*
+     * Chunks that miss the cache are decoded into buffers of their own, which
+     * are all alive until the read completes. Reads that touch more chunks
+     * than fit in the cache, or more than max_cached_subcube_size, bypass the
+     * cache and are read directly into the output buffer, which bounds the
+     * memory held per read. So do reads of chunks that are too large to be
+     * cached at all.
+     */
+    ChunkCache& cache = ChunkCache::instance();
+    std::size_t chunk_size = sizeof(float);
+    std::size_t touched = 1;
+    for (int d = 0; d < ndims; ++d) {
+        chunk_size *= std::min(span, nsamples[d]);
+        touched    *= last_chunk[d] - first_chunk[d] + 1;
+    }
+    std::size_t const limit = std::min(
+        cache.capacity(),
+        ::max_cached_subcube_size
+    );
+    if (chunk_size > cache.max_chunk_size() or touched * chunk_size > limit) {
+        return this->request_uncached_subcube(buffer, size, subcube);
+    }
+
+    float* const output = static_cast< float* >(buffer);
+
+    PendingRead read;
+    int chunk[ndims];
+    std::copy(first_chunk, first_chunk + ndims, chunk);
+    try {
+        while (true) {
+            SubCube bounds = subcube;
+            std::int64_t index = 0;
+            std::size_t  count = 1;
+            for (int d = ndims - 1; d >= 0; --d) {
+                bounds.bounds.lower[d] = chunk[d] * span;
+                bounds.bounds.upper[d] = std::min(
+                    bounds.bounds.lower[d] + span,
+                    nsamples[d]
+                );
+                index = index * nchunks[d] + chunk[d];
+                count *= bounds.nsamples(d);
+            }
+
+            ChunkCache::Key key{ this->m_identity, subcube.lod, index };
+            ChunkCache::Chunk cached = cache.get(key);
+            if (cached) {
+                ::copy_chunk(cached->data(), bounds, subcube, output);
+            } else {
+                auto data = std::make_shared< std::vector< float > >(count);
+                read.requests.push_back(this->m_access_manager.RequestVolumeSubset(
+                    data->data(),
+                    count * sizeof(float),
+                    OpenVDS::Dimensions_012,
+                    bounds.lod,
+                    SingleDataHandle::channel,
+                    bounds.bounds.lower,
+                    bounds.bounds.upper,
+                    SingleDataHandle::format()
+                ));
+                read.completions.push_back(
+                    [&cache, key, data, bounds, subcube, output]() {
+                        ::copy_chunk(data->data(), bounds, subcube, output);
+                        cache.put(key, data);
+                    }
+                );
+            }
+
+            int d = 0;
+            for (; d < ndims; ++d) {
+                if (++chunk[d] <= last_chunk[d]) break;
+                chunk[d] = first_chunk[d];
+            }
+            if (d == ndims) break;
+        }
+    } catch (...) {
+        for (auto const& request : read.requests) {
+            request->WaitForCompletion();
+        }
+        throw;
+    }
+
+    return read;
 }
 
 std::int64_t SingleDataHandle::traces_buffer_size(std::size_t const ntraces) noexcept(false) {
@@ -115,10 +497,28 @@ void SingleDataHandle::read_traces(
     voxel const* coordinates,
     std::size_t const ntraces,
     enum interpolation_method const interpolation_method
+) noexcept (false) {
+    ::wait_for_completion({
+        this->request_traces(
+            buffer,
+            size,
+            coordinates,
+            ntraces,
+            interpolation_method
+        )
+    });
+}
+
+std::shared_ptr< OpenVDS::VolumeDataRequest > SingleDataHandle::request_traces(
+    void* const buffer,
+    std::int64_t const size,
+    voxel const* coordinates,
+    std::size_t const ntraces,
+    enum interpolation_method const interpolation_method
 ) noexcept (false) {
     int const dimension = this->get_metadata().sample().dimension();
 
-    auto request = this->m_access_manager.RequestVolumeTraces(
+    return this->m_access_manager.RequestVolumeTraces(
         (float*)buffer,
         size,
         OpenVDS::Dimensions_012,
@@ -129,11 +529,6 @@ void SingleDataHandle::read_traces(
         ::to_interpolation(interpolation_method),
         dimension
     );
-    bool const success = request.get()->WaitForCompletion();
-
-    if (!success) {
-        throw std::runtime_error("Failed to read from VDS.");
-    }
 }
 
 std::int64_t SingleDataHandle::samples_buffer_size(
@@ -152,7 +547,25 @@ void SingleDataHandle::read_samples(
     std::size_t const nsamples,
     enum interpolation_method const interpolation_method
 ) noexcept (false) {
-    auto request = this->m_access_manager.RequestVolumeSamples(
+    ::wait_for_completion({
+        this->request_samples(
+            buffer,
+            size,
+            samples,
+            nsamples,
+            interpolation_method
+        )
+    });
+}
+
+std::shared_ptr< OpenVDS::VolumeDataRequest > SingleDataHandle::request_samples(
+    void* const buffer,
+    std::int64_t const size,
+    voxel const* samples,
+    std::size_t const nsamples,
+    enum interpolation_method const interpolation_method
+) noexcept (false) {
+    return this->m_access_manager.RequestVolumeSamples(
         (float*)buffer,
         size,
         OpenVDS::Dimensions_012,
@@ -162,11 +575,6 @@ void SingleDataHandle::read_samples(
         nsamples,
         ::to_interpolation(interpolation_method)
     );
-
-    bool const success = request.get()->WaitForCompletion();
-    if (!success) {
-        throw std::runtime_error("Failed to read from VDS.");
-    }
 }
 
 DoubleDataHandle make_double_datahandle(
@@ -187,14 +595,9 @@ DoubleDataHandle::DoubleDataHandle(SingleDataHandle datahandle_a, SingleDataHand
 
     if (binary_symbol == NO_OPERATOR)
         throw detail::bad_request("Invalid function");
-    else if (binary_symbol == ADDITION)
-        this->m_binary_operator = &inplace_addition;
-    else if (binary_symbol == SUBTRACTION)
-        this->m_binary_operator = &inplace_subtraction;
-    else if (binary_symbol == MULTIPLICATION)
-        this->m_binary_operator = &inplace_multiplication;
-    else if (binary_symbol == DIVISION)
-        this->m_binary_operator = &inplace_division;
+    else if (binary_symbol == ADDITION or binary_symbol == SUBTRACTION or
+             binary_symbol == MULTIPLICATION or binary_symbol == DIVISION)
+        this->m_binary_operator = make_binary_kernel(binary_symbol);
     else
         throw detail::bad_request("Invalid binary_operator string");
 }
@@ -217,6 +620,38 @@ OpenVDS::VolumeDataFormat DoubleDataHandle::format() noexcept(true) {
     return OpenVDS::VolumeDataFormat::Format_R32;
 }
 
+int DoubleDataHandle::max_lod() noexcept(false) {
+    int lod = std::min(
+        this->m_datahandle_a.max_lod(),
+        this->m_datahandle_b.max_lod()
+    );
+
+    auto transformer = this->m_metadata.coordinate_transformer();
+    int const zero[OpenVDS::Dimensionality_Max] = { 0, 0, 0, 0, 0, 0 };
+    int zero_a[OpenVDS::Dimensionality_Max] = { 0, 0, 0, 0, 0, 0 };
+    int zero_b[OpenVDS::Dimensionality_Max] = { 0, 0, 0, 0, 0, 0 };
+    transformer.to_cube_a_voxel_position(zero_a, zero);
+    transformer.to_cube_b_voxel_position(zero_b, zero);
+
+    auto aligned = [&](int lod) {
+        int const mask = (1 << lod) - 1;
+        for (int i = 0; i < 3; ++i) {
+            if ((zero_a[i] & mask) or (zero_b[i] & mask)) return false;
+        }
+        return true;
+    };
+
+    while (lod > 0 and not aligned(lod)) --lod;
+    return lod;
+}
+
+int DoubleDataHandle::bricksize() noexcept(false) {
+    return std::max(
+        this->m_datahandle_a.bricksize(),
+        this->m_datahandle_b.bricksize()
+    );
+}
+
 std::int64_t DoubleDataHandle::subcube_buffer_size(
     SubCube const& subcube
 ) noexcept(false) {
@@ -238,27 +673,18 @@ void DoubleDataHandle::read_subcube(
     transformer.to_cube_a_voxel_position(subcube_a.bounds.lower, subcube.bounds.lower);
     transformer.to_cube_a_voxel_position(subcube_a.bounds.upper, subcube.bounds.upper);
 
-    std::vector<char> buffer_a(size);
-
-    this->m_datahandle_a.read_subcube(
-        buffer,
-        size,
-        subcube_a
-    );
-
     SubCube subcube_b = SubCube(subcube);
     transformer.to_cube_b_voxel_position(subcube_b.bounds.lower, subcube.bounds.lower);
     transformer.to_cube_b_voxel_position(subcube_b.bounds.upper, subcube.bounds.upper);
 
     std::vector<char> buffer_b(size);
 
-    this->m_datahandle_b.read_subcube(
-        buffer_b.data(),
-        size,
-        subcube_b
+    ::read_concurrently(
+        [&] { return this->m_datahandle_a.request_subcube(buffer, size, subcube_a); },
+        [&] { return this->m_datahandle_b.request_subcube(buffer_b.data(), size, subcube_b); }
     );
 
-    m_binary_operator((float*)buffer, (float* const)buffer_b.data(), (std::size_t)size / sizeof(float));
+    m_binary_operator((float*)buffer, (float*)buffer, (float* const)buffer_b.data(), (std::size_t)size / sizeof(float));
 }
 
 std::int64_t DoubleDataHandle::traces_buffer_size(std::size_t const ntraces) noexcept(false) {
@@ -272,74 +698,97 @@ void DoubleDataHandle::read_traces(
     std::size_t const ntraces,
     enum interpolation_method const interpolation_method
 ) noexcept(false) {
+    if (size < this->traces_buffer_size(ntraces)) {
+        throw std::invalid_argument("Buffer too small for traces");
+    }
+
     int const sample_dimension_index = this->get_metadata().sample().dimension();
     auto transformer = this->m_metadata.coordinate_transformer();
 
+    /*
+     * Fences are usually requested over and over with about the same number
+     * of traces, so the buffers are kept between calls on the same thread
+     */
+    thread_local TraceScratch scratch_buffers;
+    TraceScratch* const scratch = &scratch_buffers;
+    TraceScratchRelease const release(scratch);
+
     std::size_t coordinates_buffer_size = OpenVDS::Dimensionality_Max * ntraces;
-    std::vector<float> coordinates_a(coordinates_buffer_size);
+    std::vector<float>& coordinates_a = scratch->coordinates_a;
+    coordinates_a.resize(coordinates_buffer_size);
     for (int v = 0; v < ntraces; v++) {
         transformer.to_cube_a_voxel_position(coordinates_a.data() + OpenVDS::Dimensionality_Max * v, coordinates[v]);
     }
 
-    std::vector<float> coordinates_b(coordinates_buffer_size);
+    std::vector<float>& coordinates_b = scratch->coordinates_b;
+    coordinates_b.resize(coordinates_buffer_size);
     for (int v = 0; v < ntraces; v++) {
         transformer.to_cube_b_voxel_position(coordinates_b.data() + OpenVDS::Dimensionality_Max * v, coordinates[v]);
     }
 
     std::size_t size_a = this->m_datahandle_a.traces_buffer_size(ntraces);
-    std::vector<float> buffer_a((std::size_t)size_a / sizeof(float));
-    this->m_datahandle_a.read_traces(
-        buffer_a.data(),
-        size_a,
-        (voxel*)coordinates_a.data(),
-        ntraces,
-        interpolation_method
-    );
+    std::vector<float>& buffer_a = scratch->traces_a;
+    buffer_a.resize((std::size_t)size_a / sizeof(float));
 
     std::size_t size_b = this->m_datahandle_b.traces_buffer_size(ntraces);
-    std::vector<float> buffer_b((std::size_t)size_b / sizeof(float));
-    this->m_datahandle_b.read_traces(
-        buffer_b.data(),
-        size_b,
-        (voxel*)coordinates_b.data(),
-        ntraces,
-        interpolation_method
+    std::vector<float>& buffer_b = scratch->traces_b;
+    buffer_b.resize((std::size_t)size_b / sizeof(float));
+
+    ::read_concurrently(
+        [&] {
+            return this->m_datahandle_a.request_traces(
+                buffer_a.data(),
+                size_a,
+                (voxel*)coordinates_a.data(),
+                ntraces,
+                interpolation_method
+            );
+        },
+        [&] {
+            return this->m_datahandle_b.request_traces(
+                buffer_b.data(),
+                size_b,
+                (voxel*)coordinates_b.data(),
+                ntraces,
+                interpolation_method
+            );
+        }
     );
 
     // Function read_traces extracts whole traces out of corresponding files.
     // However it could happen that data files are not fully aligned in their sample dimensions.
     // That creates a need to extract from each trace data that make up the intersection.
-    float* floatBuffer = (float*)buffer;
-    this->extract_continuous_part_of_trace(
-        &buffer_a,
+    this->combine_trace_windows(
+        buffer_a.data(),
         m_datahandle_a.get_metadata().sample().nsamples(),
         (long)(coordinates_a[sample_dimension_index] + 0.5f),
-        this->get_metadata().sample().nsamples(),
-        floatBuffer);
-
-    std::vector<float> res_buffer_b(this->get_metadata().sample().nsamples() * ntraces);
-    this->extract_continuous_part_of_trace(
-        &buffer_b,
+        buffer_b.data(),
         m_datahandle_b.get_metadata().sample().nsamples(),
         (long)(coordinates_b[sample_dimension_index] + 0.5f),
+        ntraces,
         this->get_metadata().sample().nsamples(),
-        res_buffer_b.data());
-
-    m_binary_operator((float*)buffer, (float* const)res_buffer_b.data(), (std::size_t)size / sizeof(float));
+        (float*)buffer
+    );
 }
 
-void DoubleDataHandle::extract_continuous_part_of_trace(
-    std::vector<float>* source_traces,
-    int source_trace_length,
-    long start_extract_index,
-    int nsamples_to_extract,
+void DoubleDataHandle::combine_trace_windows(
+    float const* traces_a,
+    int trace_length_a,
+    long offset_a,
+    float const* traces_b,
+    int trace_length_b,
+    long offset_b,
+    std::size_t ntraces,
+    int nsamples,
     float* target_buffer
-) {
-    int ntraces = source_traces->size() / source_trace_length;
-    for (int i = 0; i < ntraces; ++i) {
-        float* src_trace = source_traces->data() + i * source_trace_length;
-        float* dst_trace = target_buffer + i * nsamples_to_extract;
-        std::memcpy(dst_trace, src_trace + start_extract_index, nsamples_to_extract * sizeof(float));
+) noexcept (true) {
+    for (std::size_t i = 0; i < ntraces; ++i) {
+        this->m_binary_operator(
+            target_buffer + i * nsamples,
+            traces_a + i * trace_length_a + offset_a,
+            traces_b + i * trace_length_b + offset_b,
+            nsamples
+        );
     }
 }
 
@@ -376,47 +825,28 @@ void DoubleDataHandle::read_samples(
         transformer_b.to_cube_b_voxel_position(samples_b.data() + OpenVDS::Dimensionality_Max * v, samples[v]);
     }
 
-    this->m_datahandle_a.read_samples(
-        buffer,
-        size,
-        (voxel*)samples_a.data(),
-        nsamples,
-        interpolation_method
-    );
-
     std::vector<float> buffer_b((std::size_t)size / sizeof(float));
 
-    this->m_datahandle_b.read_samples(
-        buffer_b.data(),
-        size,
-        (voxel*)samples_b.data(),
-        nsamples,
-        interpolation_method
+    ::read_concurrently(
+        [&] {
+            return this->m_datahandle_a.request_samples(
+                buffer,
+                size,
+                (voxel*)samples_a.data(),
+                nsamples,
+                interpolation_method
+            );
+        },
+        [&] {
+            return this->m_datahandle_b.request_samples(
+                buffer_b.data(),
+                size,
+                (voxel*)samples_b.data(),
+                nsamples,
+                interpolation_method
+            );
+        }
     );
 
-    m_binary_operator((float*)buffer, (float* const)buffer_b.data(), (std::size_t)size / sizeof(float));
-}
-
-void inplace_subtraction(float* buffer_A, const float* buffer_B, std::size_t nsamples) noexcept(true) {
-    for (std::size_t i = 0; i < nsamples; i++) {
-        buffer_A[i] -= buffer_B[i];
-    }
-}
-
-void inplace_addition(float* buffer_A, const float* buffer_B, std::size_t nsamples) noexcept(true) {
-    for (std::size_t i = 0; i < nsamples; i++) {
-        buffer_A[i] += buffer_B[i];
-    }
-}
-
-void inplace_multiplication(float* buffer_A, const float* buffer_B, std::size_t nsamples) noexcept(true) {
-    for (std::size_t i = 0; i < nsamples; i++) {
-        buffer_A[i] *= buffer_B[i];
-    }
-}
-
-void inplace_division(float* buffer_A, const float* buffer_B, std::size_t nsamples) noexcept(true) {
-    for (std::size_t i = 0; i < nsamples; i++) {
-        buffer_A[i] /= buffer_B[i];
-    }
+    m_binary_operator((float*)buffer, (float*)buffer, (float* const)buffer_b.data(), (std::size_t)size / sizeof(float));
 }
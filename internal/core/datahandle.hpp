@@ -3,15 +3,47 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <OpenVDS/OpenVDS.h>
 #include <functional>
+#include <type_traits>
 
+#include "binaryoperator.hpp"
 #include "metadatahandle.hpp"
 #include "subcube.hpp"
 
 using voxel = float[OpenVDS::Dimensionality_Max];
 
+using VolumeDataRequests = std::vector< std::shared_ptr< OpenVDS::VolumeDataRequest > >;
+
+/**
+ * Reads that have been issued, but not necessarily completed.
+ *
+ * Some reads have more work to do once their data has arrived, e.g. copying
+ * chunks read through the chunk cache into the output buffer. The completion
+ * handlers do that work, and must only be run after all the requests have
+ * completed successfully.
+ */
+struct PendingRead {
+    VolumeDataRequests requests;
+    std::vector< std::function< void() > > completions;
+};
+
+/**
+ * Max number of concurrent requests a single subcube read is split into.
+ *
+ * Large subcubes are split along chunk (brick) boundaries of the slowest
+ * dimension in the output, so that every request covers a disjoint set of
+ * chunks and writes to a contiguous, disjoint part of the output buffer. 1
+ * reads every subcube with a single request. The library defaults to 1, while
+ * the server defaults to 4 (--subcube-requests).
+ *
+ * Does not apply when the chunk cache is enabled, in which case every chunk
+ * that is not already cached is read with a request of its own.
+ */
+void configure_subcube_requests(std::size_t max_requests) noexcept (true);
+
 class DataHandle {
 
 public:
@@ -30,6 +62,16 @@ public:
         enum interpolation_method const interpolation_method
     ) noexcept(false) = 0;
 
+    /** Coarsest level of detail subcubes can be read at */
+    virtual int max_lod() noexcept(false) = 0;
+
+    /**
+     * Size of the bricks (chunks) the data is stored in, in full resolution
+     * voxels along every dimension. Reads within the same brick decode the
+     * same chunks.
+     */
+    virtual int bricksize() noexcept(false) = 0;
+
     virtual std::int64_t subcube_buffer_size(SubCube const& subcube) noexcept(false) = 0;
 
     virtual void read_subcube(
@@ -52,16 +94,26 @@ public:
 };
 
 class SingleDataHandle : public DataHandle {
-    SingleDataHandle(OpenVDS::VDSHandle handle);
+    SingleDataHandle(OpenVDS::VDSHandle handle, std::string identity);
     friend SingleDataHandle make_single_datahandle(const char* url, const char* credentials);
+    friend class DataHandlePool;
 
 public:
+    /**
+     * Release this handle's reference to the VDS. Copies of a handle share
+     * the underlying VDS, which is closed when the last copy is closed or
+     * destroyed.
+     */
     void close();
 
     SingleMetadataHandle const& get_metadata() const noexcept (true);
 
     static OpenVDS::VolumeDataFormat format() noexcept (true);
 
+    int max_lod() noexcept (false);
+
+    int bricksize() noexcept (false);
+
     std::int64_t subcube_buffer_size(SubCube const& subcube) noexcept (false);
 
     void read_subcube(
@@ -91,13 +143,66 @@ public:
         enum interpolation_method const interpolation_method
     ) noexcept (false);
 
+    /*
+     * The request_* functions issue the same reads as their read_*
+     * counterparts, but return without waiting for the data. This allows
+     * several requests to be in flight at the same time. The buffer (and
+     * coordinates) must be kept alive until the request has completed.
+     */
+    PendingRead request_subcube(
+        void * const buffer,
+        std::int64_t size,
+        SubCube const& subcube
+    ) noexcept (false);
+
+    std::shared_ptr< OpenVDS::VolumeDataRequest > request_traces(
+        void * const                    buffer,
+        std::int64_t const              size,
+        voxel const*                    coordinates,
+        std::size_t const               ntraces,
+        enum interpolation_method const interpolation_method
+    ) noexcept (false);
+
+    std::shared_ptr< OpenVDS::VolumeDataRequest > request_samples(
+        void * const                    buffer,
+        std::int64_t const              size,
+        voxel const*                    samples,
+        std::size_t const               nsamples,
+        enum interpolation_method const interpolation_method
+    ) noexcept (false);
+
 private:
-    OpenVDS::VDSHandle m_handle;
+    std::shared_ptr< std::remove_pointer< OpenVDS::VDSHandle >::type > m_handle;
     OpenVDS::VolumeDataAccessManager m_access_manager;
     SingleMetadataHandle m_metadata;
+    /* Identifies the VDS in the chunk cache */
+    std::string m_identity;
 
     static int constexpr lod_level = 0;
     static int constexpr channel = 0;
+
+    /*
+     * Read the subcube chunk by chunk through the chunk cache. Chunks that
+     * are cached are copied into the buffer right away, the rest are copied
+     * by the completion handlers of the returned read. Falls back to
+     * request_uncached_subcube for reads that touch too many chunks to hold
+     * in memory at once.
+     */
+    PendingRead request_cached_subcube(
+        void * const buffer,
+        std::int64_t size,
+        SubCube const& subcube
+    ) noexcept (false);
+
+    /*
+     * Read the subcube directly from OpenVDS, split in up to
+     * max_subcube_requests pieces.
+     */
+    PendingRead request_uncached_subcube(
+        void * const buffer,
+        std::int64_t size,
+        SubCube const& subcube
+    ) noexcept (false);
 };
 
 SingleDataHandle make_single_datahandle(
@@ -123,6 +228,15 @@ public:
 
     static OpenVDS::VolumeDataFormat format() noexcept(true);
 
+    /*
+     * The coarsest level both cubes have, at which the voxels of cube A and B
+     * still line up in the intersection.
+     */
+    int max_lod() noexcept(false);
+
+    /* The larger of the brick sizes of cube A and B */
+    int bricksize() noexcept(false);
+
     std::int64_t subcube_buffer_size(SubCube const& subcube) noexcept(false);
 
     void read_subcube(
@@ -155,19 +269,31 @@ private:
     SingleDataHandle m_datahandle_a;
     SingleDataHandle m_datahandle_b;
     DoubleMetadataHandle m_metadata;
-    std::function<void(float*, const float*, std::size_t)> m_binary_operator;
+    binary_kernel m_binary_operator;
 
     static int constexpr lod_level = 0;
     static int constexpr channel = 0;
 
     SubCube offset_bounds(const SubCube subcube, SingleMetadataHandle metadata);
-    void extract_continuous_part_of_trace(
-        std::vector<float>* source_traces,
-        int source_trace_length,
-        long start_extract_index,
-        int nsamples_to_extract,
+
+    /*
+     * Applies the binary operator to the aligned part of every trace from A
+     * and B, writing the result straight into target_buffer. The whole
+     * traces of A and B are read first, only the copy of the aligned part is
+     * fused with the operator. target_buffer must hold ntraces * nsamples
+     * floats.
+     */
+    void combine_trace_windows(
+        float const* traces_a,
+        int trace_length_a,
+        long offset_a,
+        float const* traces_b,
+        int trace_length_b,
+        long offset_b,
+        std::size_t ntraces,
+        int nsamples,
         float* target_buffer
-    );
+    ) noexcept (true);
 };
 
 DoubleDataHandle make_double_datahandle(
@@ -176,28 +302,4 @@ DoubleDataHandle make_double_datahandle(
     enum binary_operator bin_operator
 ) noexcept(false);
 
-void inplace_subtraction(
-    float* buffer_A,
-    const float* buffer_B,
-    std::size_t nsamples
-) noexcept(true);
-
-void inplace_addition(
-    float* buffer_A,
-    const float* buffer_B,
-    std::size_t nsamples
-) noexcept(true);
-
-void inplace_multiplication(
-    float* buffer_A,
-    const float* buffer_B,
-    std::size_t nsamples
-) noexcept(true);
-
-void inplace_division(
-    float* buffer_A,
-    const float* buffer_B,
-    std::size_t nsamples
-) noexcept(true);
-
 #endif /* ONESEISMIC_API_DATAHANDLE_HPP */
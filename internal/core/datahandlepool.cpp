@@ -0,0 +1,124 @@
+#include "datahandlepool.hpp"
+
+#include <chrono>
+#include <iterator>
+#include <mutex>
+#include <string>
+
+#include "datahandle.hpp"
+
+DataHandlePool& DataHandlePool::instance() noexcept (true) {
+    static DataHandlePool pool;
+    return pool;
+}
+
+void DataHandlePool::configure(
+    std::size_t capacity,
+    std::chrono::seconds idle_ttl
+) noexcept (true) {
+    std::lock_guard< std::mutex > lock(this->m_mutex);
+    this->m_capacity = capacity;
+    this->m_idle_ttl = idle_ttl;
+    this->evict(this->m_capacity, clock::now());
+}
+
+SingleDataHandle DataHandlePool::checkout(
+    std::string const& url,
+    std::string const& credentials,
+    bool* pooled
+) noexcept (false) {
+    Key key(url, credentials);
+    if (pooled) *pooled = false;
+    {
+        std::lock_guard< std::mutex > lock(this->m_mutex);
+        if (this->m_capacity == 0) {
+            return make_single_datahandle(url.c_str(), credentials.c_str());
+        }
+
+        auto const now = clock::now();
+        this->evict(this->m_capacity, now);
+
+        auto hit = this->m_index.find(key);
+        if (hit != this->m_index.end()) {
+            auto entry = hit->second;
+            entry->last_used = now;
+            this->m_entries.splice(this->m_entries.begin(), this->m_entries, entry);
+            if (pooled) *pooled = true;
+            return entry->handle;
+        }
+    }
+
+    /*
+     * Opening the VDS is slow and must not block checkouts of other handles.
+     * Should two requests race to open the same VDS, the handle that makes it
+     * into the pool first wins and the other one is only used by its
+     * requester.
+     */
+    SingleDataHandle handle = make_single_datahandle(url.c_str(), credentials.c_str());
+
+    std::lock_guard< std::mutex > lock(this->m_mutex);
+    if (this->m_capacity == 0 or this->m_index.count(key) != 0) {
+        return handle;
+    }
+
+    this->m_entries.push_front(Entry{ key, handle, clock::now() });
+    this->m_index.emplace(key, this->m_entries.begin());
+    this->evict(this->m_capacity, clock::now());
+
+    return handle;
+}
+
+void DataHandlePool::evict_expired() noexcept (true) {
+    std::lock_guard< std::mutex > lock(this->m_mutex);
+    this->evict(this->m_capacity, clock::now());
+}
+
+void DataHandlePool::clear() noexcept (true) {
+    std::lock_guard< std::mutex > lock(this->m_mutex);
+    this->evict(0, clock::now());
+}
+
+std::size_t DataHandlePool::size() const noexcept (true) {
+    std::lock_guard< std::mutex > lock(this->m_mutex);
+    return this->m_entries.size();
+}
+
+bool DataHandlePool::in_use(Entry const& entry) noexcept (true) {
+    return entry.handle.m_handle.use_count() > 1;
+}
+
+void DataHandlePool::evict(
+    std::size_t capacity,
+    clock::time_point now
+) noexcept (true) {
+    auto erase = [this](std::list< Entry >::iterator entry) {
+        this->m_index.erase(entry->key);
+        return this->m_entries.erase(entry);
+    };
+
+    for (auto entry = this->m_entries.begin(); entry != this->m_entries.end();) {
+        bool const expired = now - entry->last_used > this->m_idle_ttl;
+        if (expired and not in_use(*entry)) {
+            entry = erase(entry);
+        } else {
+            ++entry;
+        }
+    }
+
+    /* Prefer to evict idle entries, starting with the least recently used */
+    for (auto entry = this->m_entries.end(); this->m_entries.size() > capacity;) {
+        if (entry == this->m_entries.begin()) break;
+        --entry;
+        if (not in_use(*entry)) {
+            entry = erase(entry);
+        }
+    }
+
+    /*
+     * All remaining entries are in use. Dropping them from the pool is still
+     * safe, the VDS is closed once the last copy of the handle is returned.
+     */
+    while (this->m_entries.size() > capacity) {
+        erase(std::prev(this->m_entries.end()));
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef ONESEISMIC_API_DATAHANDLEPOOL_HPP
+#define ONESEISMIC_API_DATAHANDLEPOOL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "datahandle.hpp"
+
+/**
+ * Process-wide pool of opened VDS handles.
+ *
+ * Opening a VDS involves downloading and parsing its layout, which for small
+ * slices and fences is a considerable part of the total request time. The pool
+ * keeps recently used handles open, so that subsequent requests to the same
+ * VDS can skip that step.
+ *
+ * Handles are keyed by url and credentials, so a handle is never shared
+ * between requests that authenticated differently. Note that the pool does not
+ * validate the credentials on reuse, that is the responsibility of the caller.
+ *
+ * Checked out handles are copies sharing the underlying VDS with the pool
+ * entry. The number of copies in circulation is the reference count of the
+ * entry. A handle is returned by closing it. Entries that are not checked out
+ * are evicted in least recently used order when the pool exceeds its capacity,
+ * or when they have been idle for longer than the idle ttl. Evicting an entry
+ * never invalidates handles in use, as the VDS is only closed when the last
+ * copy is closed.
+ *
+ * The pool is disabled (capacity 0) by default, in which case every checkout
+ * opens a new VDS.
+ */
+class DataHandlePool {
+public:
+    static DataHandlePool& instance() noexcept (true);
+
+    /**
+     * @param capacity Max number of entries kept in the pool. 0 disables the
+     * pool and closes all idle entries.
+     * @param idle_ttl Time an entry can stay in the pool without being
+     * checked out.
+     */
+    void configure(
+        std::size_t capacity,
+        std::chrono::seconds idle_ttl
+    ) noexcept (true);
+
+    /**
+     * Handle for url and credentials, from the pool if there is one. pooled,
+     * if not null, is set to whether the handle was already opened, in which
+     * case the credentials have not been validated by this checkout.
+     */
+    SingleDataHandle checkout(
+        std::string const& url,
+        std::string const& credentials,
+        bool* pooled = nullptr
+    ) noexcept (false);
+
+    /**
+     * Evict entries that are not checked out and have been idle for longer
+     * than the idle ttl.
+     */
+    void evict_expired() noexcept (true);
+
+    /** Evict all entries. Handles in use stay valid. */
+    void clear() noexcept (true);
+
+    std::size_t size() const noexcept (true);
+
+private:
+    DataHandlePool() = default;
+
+    using clock = std::chrono::steady_clock;
+    using Key   = std::pair< std::string, std::string >;
+
+    struct Entry {
+        Key               key;
+        SingleDataHandle  handle;
+        clock::time_point last_used;
+    };
+
+    /** An entry is in use as long as any copy of its handle is open */
+    static bool in_use(Entry const& entry) noexcept (true);
+
+    void evict(std::size_t capacity, clock::time_point now) noexcept (true);
+
+    /* Entries in most recently used order */
+    std::list< Entry > m_entries;
+    std::map< Key, std::list< Entry >::iterator > m_index;
+
+    std::size_t          m_capacity = 0;
+    std::chrono::seconds m_idle_ttl = std::chrono::seconds(0);
+
+    mutable std::mutex m_mutex;
+};
+
+#endif /* ONESEISMIC_API_DATAHANDLEPOOL_HPP */
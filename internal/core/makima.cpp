@@ -0,0 +1,84 @@
+#include "makima.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+namespace {
+
+/*
+ * Derivative at a sample from the two secants on either side of it. The
+ * weights are those of the modified Akima spline, which do not overshoot when
+ * several samples in a row are equal.
+ */
+double slope(double mim2, double mim1, double mi, double mip1) noexcept (true) {
+    double const w1 = std::abs(mip1 - mi) + std::abs(mip1 + mi) / 2;
+    double const w2 = std::abs(mim1 - mim2) + std::abs(mim1 + mim2) / 2;
+    double const s = (w1 * mim1 + w2 * mi) / (w1 + w2);
+    /* All four secants are zero, i.e. the data is flat around the sample */
+    if (std::isnan(s)) return 0;
+    return s;
+}
+
+/*
+ * Positions are computed in double, so positions that are on the ends of the
+ * segment in float may be just outside of it
+ */
+constexpr double tolerance = 1e-3;
+
+} /* namespace */
+
+void Makima::interpolate(
+    float const* src,
+    std::size_t  n,
+    double       first,
+    double       step,
+    double*      dst,
+    std::size_t  m
+) noexcept (false) {
+    if (n < 4) {
+        throw std::domain_error("Must be at least four data points.");
+    }
+    if (m == 0) return;
+
+    double const last = first + (m - 1) * step;
+    double const end = n - 1;
+    if (first < -tolerance or last > end + tolerance) {
+        throw std::domain_error("Requested position is outside of the segment");
+    }
+
+    /*
+     * Secant i is stored at index i + 2. The secants beyond the ends are
+     * extrapolated linearly, as boost does.
+     */
+    this->m_secants.resize(n + 3);
+    double* secants = this->m_secants.data();
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+        secants[i + 2] = double(src[i + 1]) - double(src[i]);
+    }
+    secants[1] = 2 * secants[2] - secants[3];
+    secants[0] = 2 * secants[1] - secants[2];
+    secants[n + 1] = 2 * secants[n] - secants[n - 1];
+    secants[n + 2] = 2 * secants[n + 1] - secants[n];
+
+    this->m_slopes.resize(n);
+    double* slopes = this->m_slopes.data();
+    for (std::size_t i = 0; i < n; ++i) {
+        slopes[i] = slope(secants[i], secants[i + 1], secants[i + 2], secants[i + 3]);
+    }
+
+    for (std::size_t j = 0; j < m; ++j) {
+        double const position = std::min(std::max(first + j * step, 0.0), end);
+        std::size_t const i = std::min(static_cast< std::size_t >(position), n - 2);
+        double const t = position - i;
+
+        double const y0 = src[i];
+        double const y1 = src[i + 1];
+        double const s0 = slopes[i];
+        double const s1 = slopes[i + 1];
+        /* Cubic Hermite spline on the unit interval */
+        dst[j] = (1 - t) * (1 - t) * (y0 * (1 + 2 * t) + s0 * t)
+               + t * t * (y1 * (3 - 2 * t) + s1 * (t - 1));
+    }
+}
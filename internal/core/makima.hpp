@@ -0,0 +1,46 @@
+#ifndef ONESEISMIC_API_MAKIMA_HPP
+#define ONESEISMIC_API_MAKIMA_HPP
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Modified Akima (makima) interpolation of uniformly sampled data.
+ *
+ * Produces the same spline as boost::math::interpolators::makima, including
+ * its choice of slopes at the ends, but is made for resampling many short
+ * segments: positions are given as a start and a step rather than as arrays,
+ * all the destination positions are evaluated in one sweep, and the scratch
+ * space for the slopes is kept between calls. Once the scratch space has grown
+ * to the longest segment, interpolation does not allocate.
+ *
+ * Positions are in units of source samples, i.e. source sample i is at
+ * position i.
+ */
+class Makima {
+public:
+    /**
+     * Interpolate the n source samples at the m positions first + j * step,
+     * j in [0, m), and write the result to dst. Needs n >= 4, step > 0, and
+     * all the positions to be within [0, n - 1].
+     */
+    void interpolate(
+        float const* src,
+        std::size_t  n,
+        double       first,
+        double       step,
+        double*      dst,
+        std::size_t  m
+    ) noexcept (false);
+
+private:
+    /*
+     * Secants between neighbouring samples, with two extrapolated secants on
+     * either side
+     */
+    std::vector< double > m_secants;
+    /* Derivatives of the spline at the samples */
+    std::vector< double > m_slopes;
+};
+
+#endif /* ONESEISMIC_API_MAKIMA_HPP */
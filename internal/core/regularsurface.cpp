@@ -118,13 +118,17 @@ std::pair<std::size_t, std::size_t> as_pair(std::size_t row, std::size_t col) {
 float &RegularSurface::operator[](std::size_t i) noexcept(false) {
     if (i >= this->m_grid.size())
         throw std::runtime_error("operator[]: index out of range");
+    if (this->m_offset != 0)
+        throw std::runtime_error("operator[]: shifted surface is read-only");
     return this->m_data[i];
 }
 
-const float &RegularSurface::operator[](std::size_t i) const noexcept(false) {
+float RegularSurface::operator[](std::size_t i) const noexcept(false) {
     if (i >= this->m_grid.size())
         throw std::runtime_error("const operator[]: index out of range");
-    return this->m_data[i];
+    float const value = this->m_data[i];
+    if (value == this->m_fillvalue) return value;
+    return value + this->m_offset;
 }
 
 float &RegularSurface::operator[](std::pair<std::size_t, std::size_t> p) noexcept(false) {
@@ -132,13 +136,21 @@ float &RegularSurface::operator[](std::pair<std::size_t, std::size_t> p) noexcep
         throw std::runtime_error("operator[]: index out of range");
     if (p.second >= this->m_grid.ncols())
         throw std::runtime_error("operator[]: index out of range");
+    if (this->m_offset != 0)
+        throw std::runtime_error("operator[]: shifted surface is read-only");
     return this->m_data[p.first * this->m_grid.ncols() + p.second];
 }
 
-const float &RegularSurface::operator[](std::pair<std::size_t, std::size_t> p) const noexcept(false) {
+float RegularSurface::operator[](std::pair<std::size_t, std::size_t> p) const noexcept(false) {
     if (p.first >= this->m_grid.nrows())
         throw std::runtime_error("const operator[]: index out of range");
     if (p.second >= this->m_grid.ncols())
         throw std::runtime_error("const operator[]: index out of range");
-    return this->m_data[p.first * this->m_grid.ncols() + p.second];
+    return (*this)[p.first * this->m_grid.ncols() + p.second];
+}
+
+RegularSurface RegularSurface::shifted(float offset) const noexcept(true) {
+    RegularSurface surface(*this);
+    surface.m_offset += offset;
+    return surface;
 }
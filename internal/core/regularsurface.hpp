@@ -152,11 +152,26 @@ public:
     ) : RegularSurface(data, BoundedGrid(grid, nrows, ncols), fillvalue)
     {}
 
+    /*
+     * Writable values. Shifted surfaces are views of the data of another
+     * surface and can not be written.
+     */
     float(&operator[](std::size_t i) noexcept(false));
-    const float(&operator[](std::size_t i) const noexcept(false));
-
     float(&operator[](std::pair<std::size_t, std::size_t>) noexcept(false));
-    const float(&operator[](std::pair<std::size_t, std::size_t>) const noexcept(false));
+
+    /* Values, with the offset of shifted surfaces applied */
+    float operator[](std::size_t i) const noexcept(false);
+    float operator[](std::pair<std::size_t, std::size_t>) const noexcept(false);
+
+    /**
+     * Surface with the same grid and data as this one, with every value but
+     * the fillvalue offset by offset. No data is copied, so the shifted
+     * surface is only valid as long as the data is.
+     *
+     * Surfaces a constant distance above and below a reference surface are
+     * common, and the reference often has millions of values.
+     */
+    RegularSurface shifted(float offset) const noexcept (true);
 
     float fillvalue() const noexcept (true) { return this->m_fillvalue; };
 
@@ -168,6 +183,7 @@ private:
     float*             m_data;
     float              m_fillvalue;
     const BoundedGrid m_grid;
+    float              m_offset = 0;
 };
 
 // } // namespace surface
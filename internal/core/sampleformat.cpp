@@ -0,0 +1,354 @@
+#include "sampleformat.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define ONESEISMIC_API_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
+#include "ctypes.h"
+
+namespace {
+
+/*
+ * Scaled integers use the symmetric range [-max, max] of the type. The lowest
+ * value, -max - 1, is reserved for samples that are NaN or infinite, e.g. the
+ * result of division by zero.
+ */
+template< typename T >
+struct Scaled {
+    static constexpr float max    = float(std::numeric_limits< T >::max());
+    static constexpr T     novalue = std::numeric_limits< T >::min();
+};
+
+struct Range {
+    float min =  std::numeric_limits< float >::infinity();
+    float max = -std::numeric_limits< float >::infinity();
+};
+
+/* IEEE 754 binary16, rounded to nearest even like the F16C instructions */
+std::uint16_t float_to_half(float value) noexcept (true) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    std::uint32_t const sign = (bits >> 16) & 0x8000;
+    bits &= 0x7FFFFFFF;
+
+    std::uint16_t half;
+    if (bits >= 0x47800000) {
+        /* Too large for half, infinity or NaN */
+        half = bits > 0x7F800000 ? 0x7E00 : 0x7C00;
+    } else if (bits < 0x38800000) {
+        /*
+         * Subnormal half or zero. Adding 0.5 shifts the mantissa into place,
+         * with the rounding done by the fpu.
+         */
+        float const magic = 0.5f;
+        float tmp;
+        std::memcpy(&tmp, &bits, sizeof(tmp));
+        tmp += magic;
+
+        std::uint32_t tmpbits;
+        std::uint32_t magicbits;
+        std::memcpy(&tmpbits, &tmp, sizeof(tmpbits));
+        std::memcpy(&magicbits, &magic, sizeof(magicbits));
+        half = std::uint16_t(tmpbits - magicbits);
+    } else {
+        std::uint32_t const odd = (bits >> 13) & 1;
+        bits += (std::uint32_t(15 - 127) << 23) + 0xFFF + odd;
+        half = std::uint16_t(bits >> 13);
+    }
+    return std::uint16_t(half | sign);
+}
+
+void encode_float16_scalar(
+    float const* src,
+    std::size_t  n,
+    char*        dst
+) noexcept (true) {
+    for (std::size_t i = 0; i < n; ++i) {
+        std::uint16_t const half = float_to_half(src[i]);
+        std::memcpy(dst + i * sizeof(half), &half, sizeof(half));
+    }
+}
+
+Range finite_range_scalar(float const* src, std::size_t n) noexcept (true) {
+    Range range;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (not std::isfinite(src[i])) continue;
+        range.min = std::min(range.min, src[i]);
+        range.max = std::max(range.max, src[i]);
+    }
+    return range;
+}
+
+template< typename T >
+void quantize_scalar(
+    float const* src,
+    std::size_t  n,
+    float        offset,
+    float        inverse_scale,
+    char*        dst
+) noexcept (true) {
+    for (std::size_t i = 0; i < n; ++i) {
+        T sample = Scaled< T >::novalue;
+        if (std::isfinite(src[i])) {
+            float x = (src[i] - offset) * inverse_scale;
+            x = std::min(std::max(x, -Scaled< T >::max), Scaled< T >::max);
+            sample = T(std::lrint(x));
+        }
+        std::memcpy(dst + i * sizeof(T), &sample, sizeof(T));
+    }
+}
+
+#ifdef ONESEISMIC_API_X86_KERNELS
+
+/*
+ * The vectorized kernels process 8 samples per iteration and leave the tail
+ * to the scalar kernels, which round the same way. Loads of a block happen
+ * before its stores, and the stores never reach past the current block, so
+ * converting in place is safe.
+ */
+
+__attribute__((target("avx2,f16c")))
+void encode_float16_avx2(
+    float const* src,
+    std::size_t  n,
+    char*        dst
+) noexcept (true) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256  const x    = _mm256_loadu_ps(src + i);
+        __m128i const half = _mm256_cvtps_ph(x, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast< __m128i* >(dst + i * 2), half);
+    }
+    encode_float16_scalar(src + i, n - i, dst + i * 2);
+}
+
+__attribute__((target("avx2")))
+__m256 finite_mask(__m256 x) noexcept (true) {
+    __m256 const abs = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+    __m256 const inf = _mm256_set1_ps(std::numeric_limits< float >::infinity());
+    return _mm256_cmp_ps(abs, inf, _CMP_LT_OQ);
+}
+
+__attribute__((target("avx2")))
+float horizontal_min(__m256 x) noexcept (true) {
+    __m128 v = _mm_min_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+    v = _mm_min_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, 0x1));
+    return _mm_cvtss_f32(v);
+}
+
+__attribute__((target("avx2")))
+float horizontal_max(__m256 x) noexcept (true) {
+    __m128 v = _mm_max_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+    v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, 0x1));
+    return _mm_cvtss_f32(v);
+}
+
+__attribute__((target("avx2")))
+Range finite_range_avx2(float const* src, std::size_t n) noexcept (true) {
+    Range range;
+    __m256 vmin = _mm256_set1_ps(range.min);
+    __m256 vmax = _mm256_set1_ps(range.max);
+
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 const x    = _mm256_loadu_ps(src + i);
+        __m256 const mask = finite_mask(x);
+        vmin = _mm256_min_ps(vmin, _mm256_blendv_ps(vmin, x, mask));
+        vmax = _mm256_max_ps(vmax, _mm256_blendv_ps(vmax, x, mask));
+    }
+
+    Range const tail = finite_range_scalar(src + i, n - i);
+    range.min = std::min(horizontal_min(vmin), tail.min);
+    range.max = std::max(horizontal_max(vmax), tail.max);
+    return range;
+}
+
+/* Quantize 8 samples into 8 int32 lanes, novalue for non-finite samples */
+template< typename T >
+__attribute__((target("avx2")))
+__m256i quantize8(
+    __m256 x,
+    __m256 offset,
+    __m256 inverse_scale
+) noexcept (true) {
+    __m256 const max = _mm256_set1_ps(Scaled< T >::max);
+
+    __m256 const mask = finite_mask(x);
+    x = _mm256_mul_ps(_mm256_sub_ps(x, offset), inverse_scale);
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_sub_ps(_mm256_setzero_ps(), max)), max);
+
+    __m256i const novalue = _mm256_set1_epi32(Scaled< T >::novalue);
+    __m256i const sample  = _mm256_cvtps_epi32(x);
+    return _mm256_blendv_epi8(novalue, sample, _mm256_castps_si256(mask));
+}
+
+__attribute__((target("avx2")))
+void quantize_int16_avx2(
+    float const* src,
+    std::size_t  n,
+    float        offset,
+    float        inverse_scale,
+    char*        dst
+) noexcept (true) {
+    __m256 const voffset = _mm256_set1_ps(offset);
+    __m256 const vscale  = _mm256_set1_ps(inverse_scale);
+
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i const x = quantize8< std::int16_t >(
+            _mm256_loadu_ps(src + i), voffset, vscale
+        );
+        __m128i const packed = _mm_packs_epi32(
+            _mm256_castsi256_si128(x),
+            _mm256_extracti128_si256(x, 1)
+        );
+        _mm_storeu_si128(reinterpret_cast< __m128i* >(dst + i * 2), packed);
+    }
+    quantize_scalar< std::int16_t >(
+        src + i, n - i, offset, inverse_scale, dst + i * 2
+    );
+}
+
+__attribute__((target("avx2")))
+void quantize_int8_avx2(
+    float const* src,
+    std::size_t  n,
+    float        offset,
+    float        inverse_scale,
+    char*        dst
+) noexcept (true) {
+    __m256 const voffset = _mm256_set1_ps(offset);
+    __m256 const vscale  = _mm256_set1_ps(inverse_scale);
+
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i const x = quantize8< std::int8_t >(
+            _mm256_loadu_ps(src + i), voffset, vscale
+        );
+        __m128i const words = _mm_packs_epi32(
+            _mm256_castsi256_si128(x),
+            _mm256_extracti128_si256(x, 1)
+        );
+        __m128i const bytes = _mm_packs_epi16(words, words);
+        _mm_storel_epi64(reinterpret_cast< __m128i* >(dst + i), bytes);
+    }
+    quantize_scalar< std::int8_t >(
+        src + i, n - i, offset, inverse_scale, dst + i
+    );
+}
+
+#endif /* ONESEISMIC_API_X86_KERNELS */
+
+bool has_avx2() noexcept (true) {
+#ifdef ONESEISMIC_API_X86_KERNELS
+    static bool const supported = []() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") and __builtin_cpu_supports("f16c");
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void encode_float16(
+    float const* src,
+    std::size_t  n,
+    char*        dst,
+    bool         vectorize
+) noexcept (true) {
+#ifdef ONESEISMIC_API_X86_KERNELS
+    if (vectorize and has_avx2()) return encode_float16_avx2(src, n, dst);
+#endif
+    encode_float16_scalar(src, n, dst);
+}
+
+template< typename T >
+void encode_scaled(
+    float const*    src,
+    std::size_t     n,
+    SampleEncoding* encoding,
+    char*           dst,
+    bool            vectorize
+) noexcept (true) {
+    vectorize = vectorize and has_avx2();
+
+    Range range;
+#ifdef ONESEISMIC_API_X86_KERNELS
+    if (vectorize) range = finite_range_avx2(src, n);
+    else
+#endif
+        range = finite_range_scalar(src, n);
+
+    float offset = 0;
+    float scale  = 1;
+    if (range.min <= range.max) {
+        /* In double, as the span of finite floats can exceed FLT_MAX */
+        double const min = range.min;
+        double const max = range.max;
+        offset = static_cast< float >(min + (max - min) / 2);
+        scale  = static_cast< float >((max - min) / (2.0 * Scaled< T >::max));
+        /* Constant data, every sample is encoded as 0 */
+        if (scale == 0) scale = 1;
+    }
+    encoding->offset = offset;
+    encoding->scale  = scale;
+
+    float const inverse_scale = 1 / scale;
+#ifdef ONESEISMIC_API_X86_KERNELS
+    if (vectorize) {
+        if (sizeof(T) == 2) return quantize_int16_avx2(src, n, offset, inverse_scale, dst);
+        else                return quantize_int8_avx2 (src, n, offset, inverse_scale, dst);
+    }
+#endif
+    quantize_scalar< T >(src, n, offset, inverse_scale, dst);
+}
+
+} // namespace
+
+std::size_t sample_size(enum sample_format format) noexcept (false) {
+    switch (format) {
+        case FLOAT32: return sizeof(float);
+        case FLOAT16: return sizeof(std::uint16_t);
+        case INT16:   return sizeof(std::int16_t);
+        case INT8:    return sizeof(std::int8_t);
+        default: {
+            throw std::invalid_argument("Unhandled sample format");
+        }
+    }
+}
+
+void encode_samples(
+    float const*    src,
+    std::size_t     n,
+    SampleEncoding* encoding,
+    char*           dst,
+    bool            vectorize
+) noexcept (false) {
+    switch (encoding->format) {
+        case FLOAT32: {
+            if (reinterpret_cast< char const* >(src) != dst) {
+                std::memmove(dst, src, n * sizeof(float));
+            }
+            return;
+        }
+        case FLOAT16: return encode_float16(src, n, dst, vectorize);
+        case INT16:   return encode_scaled< std::int16_t >(src, n, encoding, dst, vectorize);
+        case INT8:    return encode_scaled< std::int8_t >(src, n, encoding, dst, vectorize);
+        default: {
+            throw std::invalid_argument("Unhandled sample format");
+        }
+    }
+}
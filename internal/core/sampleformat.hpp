@@ -0,0 +1,39 @@
+#ifndef ONESEISMIC_API_SAMPLEFORMAT_HPP
+#define ONESEISMIC_API_SAMPLEFORMAT_HPP
+
+#include <cstddef>
+
+#include "ctypes.h"
+
+/**
+ * Conversion of samples to the formats a response can be encoded in.
+ *
+ * Data is always read from OpenVDS as 32-bit floats. Clients that only
+ * visualize the data rarely need that precision, and can ask for the samples
+ * to be converted to a smaller format before they are returned.
+ */
+
+/** Number of bytes per sample in the given format */
+std::size_t sample_size(enum sample_format format) noexcept (false);
+
+/**
+ * Encode n samples from src into dst, in the format given by
+ * encoding->format. For the scaled integer formats the scale and offset are
+ * computed from the range of the samples, and written back to encoding.
+ *
+ * dst must hold n * sample_size(encoding->format) bytes. It may point to the
+ * same buffer as src, which allows converting a response in place. More
+ * generally dst may overlap src as long as it does not start after src.
+ *
+ * Conversion uses AVX2 and F16C when supported by the cpu. Pass
+ * vectorize = false to force the scalar implementation.
+ */
+void encode_samples(
+    float const*    src,
+    std::size_t     n,
+    SampleEncoding* encoding,
+    char*           dst,
+    bool            vectorize = true
+) noexcept (false);
+
+#endif /* ONESEISMIC_API_SAMPLEFORMAT_HPP */
@@ -1,6 +1,8 @@
 #include "subcube.hpp"
 
+#include <algorithm>
 #include <stdexcept>
+#include <vector>
 
 #include "axis.hpp"
 #include "exceptions.hpp"
@@ -70,6 +72,14 @@ int to_voxel(
     }
 }
 
+/*
+ * Number of voxels at the given level of detail covering the full resolution
+ * range [lower, upper)
+ */
+int lod_samples(int lower, int upper, int lod) noexcept (true) {
+    return ((upper - 1) >> lod) - (lower >> lod) + 1;
+}
+
 } /* namespace */
 
 SubCube::SubCube(MetadataHandle const& metadata) {
@@ -110,3 +120,91 @@ void SubCube::set_slice(
     this->bounds.lower[axis.dimension()] = voxelline;
     this->bounds.upper[axis.dimension()] = voxelline + 1;
 }
+
+void SubCube::set_lod(
+    LevelOfDetail const& lod,
+    int const max_lod
+) noexcept (false) {
+    if (lod.level >= 0) {
+        if (lod.level > max_lod) {
+            throw detail::bad_request(
+                "Invalid level of detail: " + std::to_string(lod.level) +
+                ", valid range: [0:" + std::to_string(max_lod) + "]"
+            );
+        }
+        this->lod = lod.level;
+        return;
+    }
+
+    int longest = 0;
+    for (int i = 0; i < OpenVDS::VolumeDataLayout::Dimensionality_Max; ++i) {
+        if (this->bounds.upper[i] - this->bounds.lower[i] > this->bounds.upper[longest] - this->bounds.lower[longest]) {
+            longest = i;
+        }
+    }
+
+    int const lower = this->bounds.lower[longest];
+    int const upper = this->bounds.upper[longest];
+
+    this->lod = 0;
+    while (
+        this->lod < max_lod and
+        std::size_t(::lod_samples(lower, upper, this->lod + 1)) >= lod.target_size
+    ) {
+        ++this->lod;
+    }
+}
+
+int SubCube::nsamples(int const dimension) const noexcept (true) {
+    return ::lod_samples(
+        this->bounds.lower[dimension],
+        this->bounds.upper[dimension],
+        this->lod
+    );
+}
+
+int SubCube::first(int const dimension) const noexcept (true) {
+    return (this->bounds.lower[dimension] >> this->lod) << this->lod;
+}
+
+int SubCube::last(int const dimension) const noexcept (true) {
+    return this->first(dimension) + ((this->nsamples(dimension) - 1) << this->lod);
+}
+
+std::vector< SubCube > SubCube::split(
+    int const         bricksize,
+    std::size_t const max_pieces
+) const noexcept (false) {
+    if (bricksize <= 0) {
+        throw std::invalid_argument("Brick size must be positive");
+    }
+
+    int dimension = -1;
+    for (int i = OpenVDS::VolumeDataLayout::Dimensionality_Max - 1; i >= 0; --i) {
+        if (this->nsamples(i) > 1) {
+            dimension = i;
+            break;
+        }
+    }
+    if (dimension < 0) return { *this };
+
+    int const lower = this->bounds.lower[dimension];
+    int const upper = this->bounds.upper[dimension];
+
+    int const first_brick = lower / bricksize;
+    int const nbricks     = (upper - 1) / bricksize - first_brick + 1;
+    int const npieces     = std::min(std::size_t(nbricks), max_pieces);
+    if (npieces <= 1) return { *this };
+
+    std::vector< SubCube > pieces;
+    for (int piece = 0; piece < npieces; ++piece) {
+        int const begin = first_brick + (nbricks * piece)       / npieces;
+        int const end   = first_brick + (nbricks * (piece + 1)) / npieces;
+
+        SubCube subcube(*this);
+        subcube.bounds.lower[dimension] = std::max(lower, begin * bricksize);
+        subcube.bounds.upper[dimension] = std::min(upper, end   * bricksize);
+        pieces.push_back(subcube);
+    }
+    return pieces;
+}
@@ -1,6 +1,9 @@
 #ifndef ONESEISMIC_API_SUBCUBE_HPP
 #define ONESEISMIC_API_SUBCUBE_HPP
 
+#include <cstddef>
+#include <vector>
+
 #include <OpenVDS/OpenVDS.h>
 
 #include "axis.hpp"
@@ -13,6 +16,14 @@ struct SubCube {
         int upper[OpenVDS::VolumeDataLayout::Dimensionality_Max]{1, 1, 1, 1, 1, 1};
     } bounds;
 
+    /*
+     * Level of detail the subcube is read at. The bounds are always given in
+     * full resolution voxels, at level n the subcube contains every voxel
+     * (along all dimensions) whose index is a multiple of 2^n, starting from
+     * the one at or before the lower bound.
+     */
+    int lod = 0;
+
     SubCube(MetadataHandle const& metadata);
 
     void set_slice(
@@ -25,6 +36,47 @@ struct SubCube {
         MetadataHandle const& metadata,
         std::vector< Bound > const& bounds
     ) noexcept (false);
+
+    /**
+     * Set the level of detail. An explicit level must be within [0, max_lod].
+     * With automatic level selection the coarsest level at which the longest
+     * side of the subcube has at least lod.target_size samples is picked.
+     */
+    void set_lod(
+        LevelOfDetail const& lod,
+        int const max_lod
+    ) noexcept (false);
+
+    /** Number of samples along dimension at the subcube's level of detail */
+    int nsamples(int const dimension) const noexcept (true);
+
+    /**
+     * Full resolution voxel index of the first sample along dimension at the
+     * subcube's level of detail
+     */
+    int first(int const dimension) const noexcept (true);
+
+    /**
+     * Full resolution voxel index of the last sample (inclusive) along
+     * dimension at the subcube's level of detail
+     */
+    int last(int const dimension) const noexcept (true);
+
+    /**
+     * Split the subcube into at most max_pieces pieces along brick boundaries
+     * of its slowest dimension with more than one sample. The brick size is
+     * in full resolution voxels.
+     *
+     * Dimension 0 is the fastest in a subcube buffer, so every piece maps to a
+     * contiguous part of the buffer for the whole subcube. Pieces are returned
+     * in the order they appear in that buffer. Bricks are distributed as evenly
+     * as possible between the pieces, and a piece never covers only part of a
+     * brick in the split dimension unless the subcube itself does.
+     */
+    std::vector< SubCube > split(
+        int const         bricksize,
+        std::size_t const max_pieces
+    ) const noexcept (false);
 };
 
 #endif /* ONESEISMIC_API_SUBCUBE_HPP */
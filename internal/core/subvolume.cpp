@@ -1,14 +1,14 @@
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <memory>
 #include <stdexcept>
 
 #include "axis.hpp"
+#include "makima.hpp"
 #include "subvolume.hpp"
 #include "utils.hpp"
 
-#include <boost/math/interpolators/makima.hpp>
-using boost::math::interpolators::makima;
-
 static const float tolerance = 1e-3f;
 
 float floor_with_tolerance(float x) {
@@ -34,7 +34,141 @@ enum class Border {
     Bottom
 };
 
-SurfaceBoundedSubVolume* make_subvolume(
+/*
+ * Whether there is data for the segment at horizontal position i, i.e. the
+ * surfaces are defined and the position is within the survey. Throws if the
+ * surfaces are not ordered, or the segment is out of the vertical bounds of
+ * the data.
+ */
+bool has_data(
+    RegularSurface const& reference,
+    RegularSurface const& top,
+    RegularSurface const& bottom,
+    std::size_t i,
+    HorizontalTransform const& transform,
+    GridSamplePositions& positions,
+    Axis const& sample
+) {
+    float reference_depth = reference[i];
+    float top_depth = top[i];
+    float bottom_depth = bottom[i];
+
+    if (
+        reference_depth == reference.fillvalue() ||
+        top_depth == top.fillvalue() ||
+        bottom_depth == bottom.fillvalue()
+    ) {
+        return false;
+    }
+
+    if (
+        reference_depth < top_depth ||
+        reference_depth > bottom_depth
+    ) {
+        throw std::runtime_error(
+            "Planes are not ordered as top <= reference <= bottom"
+        );
+    }
+
+    auto const position = positions.at(i);
+    if (not transform.inrange_with_margin(0, position.first) or
+        not transform.inrange_with_margin(1, position.second))
+    {
+        return false;
+    }
+
+    if (not sample.inrange(top_depth) or
+        not sample.inrange(bottom_depth))
+    {
+        auto const& horizontal_grid = reference.grid();
+        auto row = horizontal_grid.row(i);
+        auto col = horizontal_grid.col(i);
+        throw std::runtime_error(
+            "Vertical window is out of vertical bounds at"
+            " row: " + std::to_string(row) +
+            " col:" + std::to_string(col) +
+            ". Request: [" + utils::to_string_with_precision(top_depth) +
+            ", " + utils::to_string_with_precision(bottom_depth) +
+            "]. Seismic bounds: [" + utils::to_string_with_precision(sample.min())
+            + ", " + utils::to_string_with_precision(sample.max()) + "]"
+        );
+    }
+    return true;
+}
+
+/*
+ * The packed segment between top_depth and bottom_depth: the preferred
+ * margins of the blueprint where they fit within the trace, extended so that
+ * the segment has enough samples to be interpolated.
+ */
+struct PackedSegment {
+    std::uint8_t top_margin;
+    std::size_t  size;
+};
+
+PackedSegment packed_segment(
+    RawSegmentBlueprint const& segment_blueprint,
+    Axis const& sample,
+    float top_depth,
+    float bottom_depth
+) {
+    auto calculate_margin = [&](Border border) {
+        std::int8_t margin = segment_blueprint.preferred_margin();
+        while (margin > 0) {
+            float sample_position;
+            if (border == Border::Top) {
+                sample_position = segment_blueprint.top_sample_position(top_depth, margin);
+            } else {
+                sample_position = segment_blueprint.bottom_sample_position(bottom_depth, margin);
+            }
+            if (sample.inrange(sample_position)) {
+                return margin;
+            }
+            --margin;
+        }
+        return margin;
+
+    };
+
+    std::int8_t top_margin = calculate_margin(Border::Top);
+    bool is_top_margin_atypical = (top_margin != segment_blueprint.preferred_margin());
+
+    std::int8_t bottom_margin = calculate_margin(Border::Bottom);
+    bool is_bottom_margin_atypical = (bottom_margin != segment_blueprint.preferred_margin());
+
+    // limitation from makima samples interpolation algorithm
+    const int min_samples = 4;
+    assert(
+        (void("Current logic relies on relationship between min_samples and preferred_margin"),
+         min_samples == 2 * segment_blueprint.preferred_margin())
+    );
+    auto size = segment_blueprint.size(top_depth, bottom_depth, top_margin, bottom_margin);
+    if (size < min_samples) {
+        if (is_top_margin_atypical && is_bottom_margin_atypical) {
+            throw std::runtime_error(
+                "Segment size is too small. Top margin: " +
+                std::to_string(top_margin) + ", bottom margin: " +
+                std::to_string(bottom_margin)
+            );
+        }
+
+        int diff = min_samples - size;
+        if (is_top_margin_atypical) {
+            bottom_margin += diff;
+            is_bottom_margin_atypical = true;
+        } else {
+            top_margin += diff;
+            is_top_margin_atypical = true;
+        }
+    }
+
+    return {
+        static_cast<std::uint8_t>(top_margin),
+        segment_blueprint.size(top_depth, bottom_depth, top_margin, bottom_margin)
+    };
+}
+
+SurfaceBoundedSubVolume* make_tiled_subvolume(
     MetadataHandle const& metadata,
     RegularSurface const& reference,
     RegularSurface const& top,
@@ -44,20 +178,25 @@ SurfaceBoundedSubVolume* make_subvolume(
         throw std::runtime_error("Expected surfaces to have the same plane and size");
     }
 
-    CoordinateTransformer const& transform = metadata.coordinate_transformer();
-
     auto iline = metadata.iline();
     auto xline = metadata.xline();
     auto sample = metadata.sample();
 
+    HorizontalTransform const transform =
+        metadata.coordinate_transformer().horizontal_transform(CDP, iline, xline);
+
     RawSegmentBlueprint segment_blueprint = RawSegmentBlueprint(sample.stepsize(), sample.min());
     std::unique_ptr<SurfaceBoundedSubVolume> subvolume_unique_ptr(
         new SurfaceBoundedSubVolume(reference, top, bottom, segment_blueprint)
     );
     SurfaceBoundedSubVolume* subvolume = subvolume_unique_ptr.get();
     auto const horizontal_grid = subvolume->horizontal_grid();
+    GridSamplePositions positions(transform, horizontal_grid);
 
-    subvolume->m_segment_offsets[0] = 0;
+    subvolume->m_layout = std::make_shared<SurfaceBoundedSubVolume::Layout>();
+    auto& segment_offsets = subvolume->m_layout->segment_offsets;
+    segment_offsets = std::vector<std::size_t>(horizontal_grid.size() + 1);
+    segment_offsets[0] = 0;
 
     /**
      * Try to establish how far away from the start each segment in the
@@ -69,122 +208,223 @@ SurfaceBoundedSubVolume* make_subvolume(
      * current one as no data is expected to be fetched.
      */
     for (int i = 0; i < horizontal_grid.size(); ++i) {
-        float reference_depth = reference[i];
-        float top_depth = top[i];
-        float bottom_depth = bottom[i];
-
-        if (
-            reference_depth == reference.fillvalue() ||
-            top_depth == top.fillvalue() ||
-            bottom_depth == bottom.fillvalue()
-        ) {
-            subvolume->m_segment_offsets[i + 1] = subvolume->m_segment_offsets[i];
+        if (not has_data(reference, top, bottom, i, transform, positions, sample)) {
+            segment_offsets[i + 1] = segment_offsets[i];
             continue;
         }
 
-        if (
-            reference_depth < top_depth ||
-            reference_depth > bottom_depth
-        ) {
-            throw std::runtime_error(
-                "Planes are not ordered as top <= reference <= bottom"
-            );
+        auto const segment = packed_segment(segment_blueprint, sample, top[i], bottom[i]);
+        if (segment.top_margin != segment_blueprint.preferred_margin()) {
+            subvolume->m_layout->segment_top_margins.emplace(i, segment.top_margin);
         }
+        subvolume->m_layout->add_segment(i);
+
+        segment_offsets[i + 1] = segment_offsets[i] + segment.size;
+    }
+
+    return subvolume_unique_ptr.release();
+}
+
+SurfaceBoundedSubVolume* make_subvolume(
+    MetadataHandle const& metadata,
+    RegularSurface const& reference,
+    RegularSurface const& top,
+    RegularSurface const& bottom
+) {
+    std::unique_ptr<SurfaceBoundedSubVolume> subvolume(
+        make_tiled_subvolume(metadata, reference, top, bottom)
+    );
+    auto const size = subvolume->horizontal_grid().size();
+    subvolume->m_data.reserve(subvolume->nsamples(0, size));
+    return subvolume.release();
+}
 
-        auto const cdp = horizontal_grid.to_cdp(i);
-        auto ij = transform.WorldToAnnotation({cdp.x, cdp.y, 0});
+SurfaceBoundedSubVolume* make_tiled_subvolume(
+    MetadataHandle const& metadata,
+    RegularSurface const& reference,
+    float above,
+    float below
+) {
+    RegularSurface const top = reference.shifted(-above);
+    RegularSurface const bottom = reference.shifted(below);
+
+    auto iline = metadata.iline();
+    auto xline = metadata.xline();
+    auto sample = metadata.sample();
 
-        if (not iline.inrange_with_margin(ij[0]) or not xline.inrange_with_margin(ij[1])) {
-            subvolume->m_segment_offsets[i + 1] = subvolume->m_segment_offsets[i];
+    RawSegmentBlueprint segment_blueprint = RawSegmentBlueprint(sample.stepsize(), sample.min());
+    std::uint8_t const margin = segment_blueprint.preferred_margin();
+
+    /*
+     * The longest segment with preferred margins. The window is the same
+     * everywhere, so segments only differ by how the window lines up with
+     * the samples.
+     */
+    std::size_t stride = 0;
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        if (reference[i] == reference.fillvalue()) continue;
+        stride = std::max(stride, segment_blueprint.size(top[i], bottom[i], margin, margin));
+    }
+
+    std::size_t const trace_length = sample.nsamples();
+    if (stride == 0 or stride > trace_length) {
+        return make_tiled_subvolume(metadata, reference, top, bottom);
+    }
+
+    HorizontalTransform const transform =
+        metadata.coordinate_transformer().horizontal_transform(CDP, iline, xline);
+
+    std::unique_ptr<SurfaceBoundedSubVolume> subvolume(
+        new SurfaceBoundedSubVolume(reference, top, bottom, segment_blueprint)
+    );
+    auto const horizontal_grid = subvolume->horizontal_grid();
+    GridSamplePositions positions(transform, horizontal_grid);
+
+    auto& layout = *(subvolume->m_layout = std::make_shared<SurfaceBoundedSubVolume::Layout>());
+    layout.stride = stride;
+    layout.empty_segments.assign(horizontal_grid.size(), true);
+    layout.packed_segments.assign(horizontal_grid.size(), { 0, 0 });
+
+    for (std::size_t i = 0; i < horizontal_grid.size(); ++i) {
+        if (not has_data(reference, top, bottom, i, transform, positions, sample)) {
             continue;
         }
-
-        if (not sample.inrange(top_depth) or
-            not sample.inrange(bottom_depth))
-        {
-            auto row = horizontal_grid.row(i);
-            auto col = horizontal_grid.col(i);
-            throw std::runtime_error(
-                "Vertical window is out of vertical bounds at"
-                " row: " + std::to_string(row) +
-                " col:" + std::to_string(col) +
-                ". Request: [" + utils::to_string_with_precision(top_depth) +
-                ", " + utils::to_string_with_precision(bottom_depth) +
-                "]. Seismic bounds: [" + utils::to_string_with_precision(sample.min())
-                + ", " + utils::to_string_with_precision(sample.max()) + "]"
-            );
+        layout.empty_segments[i] = false;
+        layout.add_segment(i);
+
+        /*
+         * The stride starts where the packed segment does, unless that would
+         * take it past the end of the trace
+         */
+        auto const segment = packed_segment(segment_blueprint, sample, top[i], bottom[i]);
+        long const top_index = std::lround(
+            (segment_blueprint.top_sample_position(top[i], 0) - sample.min()) / sample.stepsize()
+        );
+        long const packed_first = top_index - segment.top_margin;
+        long const first = std::min(
+            packed_first,
+            static_cast< long >(trace_length - stride)
+        );
+        std::uint8_t const top_margin = top_index - first;
+        if (top_margin != margin) {
+            layout.segment_top_margins.emplace(i, top_margin);
         }
+        layout.packed_segments[i] = {
+            static_cast< std::uint32_t >(packed_first - first),
+            static_cast< std::uint32_t >(segment.size)
+        };
+    }
 
-        auto calculate_margin = [&](Border border) {
-            std::int8_t margin = segment_blueprint.preferred_margin();
-            while (margin > 0) {
-                float sample_position;
-                if (border == Border::Top) {
-                    sample_position = segment_blueprint.top_sample_position(top_depth, margin);
-                } else {
-                    sample_position = segment_blueprint.bottom_sample_position(bottom_depth, margin);
-                }
-                if (sample.inrange(sample_position)) {
-                    return margin;
-                }
-                --margin;
-            }
-            return margin;
+    return subvolume.release();
+}
 
-        };
+SurfaceBoundedSubVolume* make_subvolume(
+    MetadataHandle const& metadata,
+    RegularSurface const& reference,
+    float above,
+    float below
+) {
+    std::unique_ptr<SurfaceBoundedSubVolume> subvolume(
+        make_tiled_subvolume(metadata, reference, above, below)
+    );
+    auto const size = subvolume->horizontal_grid().size();
+    subvolume->m_data.reserve(subvolume->nsamples(0, size));
+    return subvolume.release();
+}
 
-        std::int8_t top_margin = calculate_margin(Border::Top);
-        bool is_top_margin_atypical = (top_margin != segment_blueprint.preferred_margin());
+SurfaceBoundedSubVolume SurfaceBoundedSubVolume::tile(
+    std::size_t from,
+    std::size_t to
+) const {
+    if (from > to or to > this->horizontal_grid().size()) {
+        throw std::invalid_argument("Tile is out of the subvolume");
+    }
 
-        std::int8_t bottom_margin = calculate_margin(Border::Bottom);
-        bool is_bottom_margin_atypical = (bottom_margin != segment_blueprint.preferred_margin());
+    SurfaceBoundedSubVolume tile(
+        this->m_ref,
+        this->m_top,
+        this->m_bottom,
+        this->m_segment_blueprint
+    );
+    tile.m_layout = this->m_layout;
+    tile.m_data_offset = this->offset(from);
+    tile.m_data.reserve(this->nsamples(from, to));
+    return tile;
+}
 
-        // limitation from makima samples interpolation algorithm
-        const int min_samples = 4;
-        assert(
-            (void("Current logic relies on relationship between min_samples and preferred_margin"),
-             min_samples == 2 * segment_blueprint.preferred_margin())
-        );
-        auto size = segment_blueprint.size(top_depth, bottom_depth, top_margin, bottom_margin);
-        if (size < min_samples) {
-            if (is_top_margin_atypical && is_bottom_margin_atypical) {
-                throw std::runtime_error(
-                    "Segment size is too small. Top margin: " +
-                    std::to_string(top_margin) + ", bottom margin: " +
-                    std::to_string(bottom_margin)
-                );
-            }
+std::vector<SegmentSpan> SurfaceBoundedSubVolume::spans(
+    std::size_t from,
+    std::size_t to
+) const {
+    auto const& spans = this->m_layout->spans;
+    auto span = std::upper_bound(
+        spans.begin(),
+        spans.end(),
+        from,
+        [](std::size_t index, SegmentSpan const& span) { return index < span.last; }
+    );
 
-            int diff = min_samples - size;
-            if (is_top_margin_atypical) {
-                bottom_margin += diff;
-                is_bottom_margin_atypical = true;
-            } else {
-                top_margin += diff;
-                is_top_margin_atypical = true;
-            }
-        }
+    std::vector<SegmentSpan> clipped;
+    for (; span != spans.end() and span->first < to; ++span) {
+        clipped.push_back({ std::max(span->first, from), std::min(span->last, to) });
+    }
+    return clipped;
+}
 
-        if (is_top_margin_atypical) {
-            subvolume->m_segment_top_margins.emplace(i, top_margin);
+std::vector<std::size_t> SurfaceBoundedSubVolume::partition(
+    std::size_t from,
+    std::size_t to,
+    std::size_t nparts
+) const {
+    std::vector<std::size_t> boundaries{ from };
+    if (from >= to) return boundaries;
+
+    /* Segments with a stride all take up the same number of samples */
+    if (this->m_layout->stride) {
+        nparts = std::max<std::size_t>(1, std::min(nparts, to - from));
+        for (std::size_t part = 1; part < nparts; ++part) {
+            boundaries.push_back(from + (to - from) * part / nparts);
         }
-
-        subvolume->m_segment_offsets[i + 1] =
-            subvolume->m_segment_offsets[i] + segment_blueprint.size(top_depth, bottom_depth, top_margin, bottom_margin);
+        boundaries.push_back(to);
+        return boundaries;
     }
-    subvolume->m_data.reserve(subvolume->m_segment_offsets[horizontal_grid.size()]);
 
-    return subvolume_unique_ptr.release();
+    auto const& offsets = this->m_layout->segment_offsets;
+    auto const first = offsets.begin() + from;
+    auto const last  = offsets.begin() + to;
+
+    std::size_t const nsamples = this->nsamples(from, to);
+    nparts = std::max<std::size_t>(1, std::min(nparts, to - from));
+    for (std::size_t part = 1; part < nparts; ++part) {
+        std::size_t const target = offsets[from] + nsamples * part / nparts;
+        std::size_t const boundary = std::lower_bound(first, last, target) - offsets.begin();
+        if (boundary > boundaries.back() and boundary < to) {
+            boundaries.push_back(boundary);
+        }
+    }
+    boundaries.push_back(to);
+    return boundaries;
 }
 
 void SurfaceBoundedSubVolume::reinitialize(
     std::size_t index,
     RawSegment& segment
 ) const {
+    if (not m_layout->stride) {
+        segment.reinitialize(
+            m_ref[index], m_top[index], m_bottom[index],
+            top_margin(index),
+            data_begin(index), data_begin(index + 1)
+        );
+        return;
+    }
+
+    auto const& packed = m_layout->packed_segments[index];
+    auto const data = data_begin(index) + packed.begin;
     segment.reinitialize(
         m_ref[index], m_top[index], m_bottom[index],
-        top_margin(index),
-        m_data.begin() + m_segment_offsets[index], m_data.begin() + m_segment_offsets[index + 1]
+        top_margin(index) - packed.begin,
+        data, data + packed.size
     );
 }
 
@@ -196,21 +436,43 @@ void SurfaceBoundedSubVolume::reinitialize(
 }
 
 void resample(RawSegment const& src_segment, ResampledSegment& dst_segment) {
+    /*
+     * Millions of segments are resampled per request, so the scratch space of
+     * the interpolation is kept between the segments of each thread
+     */
+    thread_local Makima makima;
+
+    if (dst_segment.size() == 0) return;
+    if (src_segment.size() < 4) {
+        throw std::domain_error("Must be at least four data points.");
+    }
+
     /**
      * Interpolation and attribute calculation should be performed on
      * doubles to avoid loss of precision in these intermediate steps.
      */
-    std::vector<double> src_points = src_segment.sample_positions();
-    /**
-     * something weird is going on here. If dst_points creation is moved after makima
-     * interpolation on machine under test whole attributes function performance
-     * became unstable. On some calls it was a bit faster than the one with
-     * current lines order, on some calls it is twice as slow. Reason is
-     * unknown.
-     */
-    std::vector<double> dst_points = dst_segment.sample_positions();
+    double const src_top      = src_segment.top_sample_position();
+    double const src_stepsize = src_segment.stepsize();
+    double const first = (dst_segment.top_sample_position() - src_top) / src_stepsize;
+    double const step  = dst_segment.stepsize() / src_stepsize;
 
-    std::vector<double> src_data(src_segment.begin(), src_segment.end());
+    /*
+     * With the default stepsize and a reference surface on the sample grid
+     * every destination sample is a source sample, and the samples are
+     * copied rather than interpolated
+     */
+    std::size_t const n = src_segment.size();
+    std::size_t const m = dst_segment.size();
+    double const top    = std::round(first);
+    double const bottom = top + (m - 1);
+    if (std::abs(first - top) < tolerance and
+        std::abs(first + (m - 1) * step - bottom) < tolerance and
+        top >= 0 and bottom <= n - 1)
+    {
+        auto const src = src_segment.begin() + static_cast< std::ptrdiff_t >(top);
+        std::copy(src, src + m, dst_segment.begin());
+        return;
+    }
 
     /*
      * Regarding use of data at the array edge: in majority of cases
@@ -219,11 +481,5 @@ void resample(RawSegment const& src_segment, ResampledSegment& dst_segment) {
      * allow algorithm to choose spline itself. Supplying additional edge
      * samples with arbitrary value seems unnecessary.
      */
-    auto spline = makima<std::vector<double>>(std::move(src_points), std::move(src_data));
-
-    auto dst = dst_segment.begin();
-    for (int j = 0; j < dst_points.size(); ++j) {
-        *dst = spline(dst_points.at(j));
-        std::advance(dst, 1);
-    }
+    makima.interpolate(&*src_segment.begin(), n, first, step, &*dst_segment.begin(), m);
 }
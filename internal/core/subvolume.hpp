@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <memory>
 #include <stdexcept>
 #include <unordered_map>
 #include <vector>
@@ -46,6 +47,12 @@ public:
     float sample_position_at(int index, float zero_index_sample_position) const noexcept{
         return zero_index_sample_position + this->stepsize() * index;
     }
+
+    /**
+     * Distance between sequential samples (in annotated coordinate system of
+     * samples axis)
+     */
+    float stepsize() const { return m_stepsize; }
 protected:
     /**
      * @param stepsize Distance between sequential samples
@@ -73,12 +80,6 @@ protected:
                this->to_round_up_sample_number(zero_sample_offset, top_boundary) + 1;
     }
 
-    /**
-     * Distance between sequential samples (in annotated coordinate system of
-     * samples axis)
-     */
-    float stepsize() const { return m_stepsize; }
-
     /**
      * Sequence number of the closest sample that is <= position
      *
@@ -284,6 +285,13 @@ public:
         return this->blueprint()->sample_position_at(index, this->top_sample_position());
     }
 
+    /**
+     * Distance (in annotated coordinates of samples axis) between samples
+     */
+    float stepsize() const noexcept {
+        return this->blueprint()->stepsize();
+    }
+
 protected:
     Segment(
         const float reference,
@@ -443,6 +451,24 @@ private:
     std::vector<double> m_data;
 };
 
+/**
+ * Where a segment is in its trace, without its data.
+ */
+struct SegmentExtent {
+    /* Position (in annotated coordinates of samples axis) of the top sample */
+    float       top_sample_position;
+    /* Number of samples */
+    std::size_t size;
+};
+
+/**
+ * Run of consecutive segments [first, last) of a subvolume.
+ */
+struct SegmentSpan {
+    std::size_t first;
+    std::size_t last;
+};
+
 /**
  * 3D chunk of (raw) seismic data.
  *
@@ -453,6 +479,13 @@ private:
  * vertical samples at the same horizontal position are contiguous in memory.
  */
 class SurfaceBoundedSubVolume {
+    friend SurfaceBoundedSubVolume* make_tiled_subvolume(
+        MetadataHandle const& metadata,
+        RegularSurface const& reference,
+        RegularSurface const& top,
+        RegularSurface const& bottom
+    );
+
     friend SurfaceBoundedSubVolume* make_subvolume(
         MetadataHandle const& metadata,
         RegularSurface const& reference,
@@ -460,48 +493,183 @@ class SurfaceBoundedSubVolume {
         RegularSurface const& bottom
     );
 
+    friend SurfaceBoundedSubVolume* make_tiled_subvolume(
+        MetadataHandle const& metadata,
+        RegularSurface const& reference,
+        float above,
+        float below
+    );
+
+    friend SurfaceBoundedSubVolume* make_subvolume(
+        MetadataHandle const& metadata,
+        RegularSurface const& reference,
+        float above,
+        float below
+    );
+
 public:
     BoundedGrid const& horizontal_grid() const noexcept {
         return m_ref.grid();
     }
 
+    /**
+     * Number of samples stored above the top surface for segment index. For
+     * segments with a stride, this is the margin of the stride.
+     */
     std::uint8_t top_margin(std::size_t index) const {
-        return this->m_segment_top_margins.count(index)
-                   ? this->m_segment_top_margins.at(index)
+        auto const& margins = this->m_layout->segment_top_margins;
+        return margins.count(index)
+                   ? margins.at(index)
                    : this->m_segment_blueprint.preferred_margin();
     }
 
+    /**
+     * The samples of segment index, i.e. the samples between the top and
+     * bottom surfaces and the margins around them. Segments with a stride
+     * are the part of their stride that a packed segment would have.
+     */
     RawSegment vertical_segment(std::size_t index) const noexcept {
+        auto const data = this->data_begin(index);
+        if (not this->m_layout->stride) {
+            return RawSegment(
+                this->m_ref[index],
+                this->m_top[index],
+                this->m_bottom[index],
+                this->top_margin(index),
+                data,
+                this->data_begin(index + 1),
+                &this->m_segment_blueprint
+            );
+        }
+
+        auto const& packed = this->m_layout->packed_segments[index];
+        return RawSegment(
+            this->m_ref[index],
+            this->m_top[index],
+            this->m_bottom[index],
+            this->top_margin(index) - packed.begin,
+            data + packed.begin,
+            data + packed.begin + packed.size,
+            &this->m_segment_blueprint
+        );
+    }
+
+    /**
+     * Top sample position and size of vertical_segment(index). Unlike the
+     * segment itself this does not need the data, and so works for
+     * subvolumes from make_tiled_subvolume too.
+     */
+    SegmentExtent extent(std::size_t index) const noexcept {
+        std::uint8_t margin = this->top_margin(index);
+        std::size_t size;
+        if (this->m_layout->stride) {
+            auto const& packed = this->m_layout->packed_segments[index];
+            margin -= packed.begin;
+            size = packed.size;
+        } else {
+            size = this->offset(index + 1) - this->offset(index);
+        }
+        return {
+            this->m_segment_blueprint.top_sample_position(this->m_top[index], margin),
+            size
+        };
+    }
+
+    /**
+     * All the samples stored for segment index, which are the ones fetched.
+     * The same as vertical_segment for packed segments, and the whole stride
+     * for segments with a stride.
+     */
+    RawSegment stored_segment(std::size_t index) const noexcept {
         return RawSegment(
             this->m_ref[index],
             this->m_top[index],
             this->m_bottom[index],
             this->top_margin(index),
-            m_data.begin() + m_segment_offsets[index],
-            m_data.begin() + m_segment_offsets[index + 1],
+            this->data_begin(index),
+            this->data_begin(index + 1),
             &this->m_segment_blueprint
         );
     }
 
     /**
-     * Number if samples contained in total between segments [from, to)
+     * Number if samples contained in total between segments [from, to). For
+     * subvolumes with a stride, empty segments take up a stride too.
      */
     std::size_t nsamples(std::size_t from_segment, std::size_t to_segment) const noexcept {
-        return this->m_segment_offsets[to_segment] - this->m_segment_offsets[from_segment];
+        return this->offset(to_segment) - this->offset(from_segment);
     }
 
     bool is_empty(std::size_t index) const noexcept {
-        return m_segment_offsets[index] == m_segment_offsets[index + 1];
+        if (this->m_layout->stride) {
+            return this->m_layout->empty_segments[index];
+        }
+        auto const& offsets = this->m_layout->segment_offsets;
+        return offsets[index] == offsets[index + 1];
+    }
+
+    /**
+     * The runs of segments with data in [from, to), clipped to [from, to).
+     * All other segments are empty.
+     *
+     * Surfaces with large holes, or that are partly outside the survey, have
+     * few runs compared to their number of segments. Going through the runs
+     * rather than every segment makes the cost proportional to the coverage.
+     */
+    std::vector<SegmentSpan> spans(std::size_t from, std::size_t to) const;
+
+    /**
+     * Number of samples of every segment, when the data is laid out as a
+     * dense [segment][sample] array. 0 when the segments are packed, and
+     * differ in size.
+     *
+     * Segment i is then stored at data(0) + i * stride, no matter which
+     * segments are empty, and neighbouring segments can be processed
+     * together. The stride may hold samples above and below the segment, see
+     * stored_segment and vertical_segment.
+     */
+    std::size_t stride() const noexcept {
+        return this->m_layout->stride;
     }
 
     float* data(std::size_t from_segment) noexcept {
-        return this->m_data.data() + m_segment_offsets[from_segment];
+        return this->m_data.data() + (this->offset(from_segment) - this->m_data_offset);
     }
 
     float fillvalue() const noexcept {
         return m_ref.fillvalue();
     }
 
+    /**
+     * Position (in annotated coordinates of samples axis) of the reference
+     * surface at horizontal position index
+     */
+    float reference(std::size_t index) const noexcept {
+        return m_ref[index];
+    }
+
+    /**
+     * The segments [from, to) of this subvolume, with storage for the data of
+     * those segments only. The tile shares surfaces and segment layout with
+     * this subvolume, and segments are indexed the same way in both, but only
+     * the segments [from, to) of the tile can be fetched and read.
+     *
+     * Tiles let large surfaces be processed piece by piece, so that the data
+     * of the whole subvolume never has to be in memory at once.
+     */
+    SurfaceBoundedSubVolume tile(std::size_t from, std::size_t to) const;
+
+    /**
+     * Split the segments [from, to) into at most nparts consecutive ranges
+     * with about the same number of samples each. Returns the boundaries of
+     * the ranges, starting with from and ending with to.
+     */
+    std::vector<std::size_t> partition(
+        std::size_t from,
+        std::size_t to,
+        std::size_t nparts
+    ) const;
+
     /**
      * Reinitialize segments with data at provided index.
      * Purpose of this functionality is to avoid creating new segment objects.
@@ -521,34 +689,128 @@ private:
         RegularSurface const& bottom,
         RawSegmentBlueprint segment_blueprint
     )
-        : m_ref(reference), m_top(top), m_bottom(bottom), m_segment_blueprint(segment_blueprint) {
+        : m_ref(reference), m_top(top), m_bottom(bottom), m_segment_blueprint(segment_blueprint)
+    {}
 
-        this->m_segment_offsets = std::vector<std::size_t>(horizontal_grid().size() + 1);
+    std::vector<float>::const_iterator data_begin(std::size_t index) const noexcept {
+        return m_data.begin() + (this->offset(index) - this->m_data_offset);
     }
 
-    std::vector<float> m_data;
     /**
-     * Distances from data start to start of every segment, i.e.
-     * m_segment_offsets[i] contains number of samples one must skip from start
-     * of m_data to get to the data of segment i.
+     * Number of samples one must skip from start of the subvolume to get to
+     * the data of segment index
      */
-    std::vector<std::size_t> m_segment_offsets;
+    std::size_t offset(std::size_t index) const noexcept {
+        if (this->m_layout->stride) {
+            return index * this->m_layout->stride;
+        }
+        return this->m_layout->segment_offsets[index];
+    }
 
     /**
-     * In order to not bloat structure unnecessary, contains only margins
-     * that are different from preferred blueprint margin.
+     * Position of the segments in the data, shared between a subvolume and
+     * its tiles.
+     *
+     * Segments are either packed, with offsets for every segment, or all
+     * stride samples long.
      */
-    std::unordered_map<std::size_t, std::uint8_t> m_segment_top_margins;
+    struct Layout {
+        /**
+         * Number of samples of every segment, or 0 if the segments are packed
+         */
+        std::size_t stride = 0;
+
+        /**
+         * Distances from data start to start of every segment, i.e.
+         * segment_offsets[i] contains number of samples one must skip from
+         * start of the subvolume to get to the data of segment i. Packed
+         * segments only.
+         */
+        std::vector<std::size_t> segment_offsets;
+
+        /**
+         * Segments without data. Segments with a stride only, as empty
+         * packed segments take up no samples.
+         */
+        std::vector<bool> empty_segments;
+
+        /**
+         * The samples [begin, begin + size) of a stride that the segment
+         * would have if it was packed
+         */
+        struct PackedSegment {
+            std::uint32_t begin;
+            std::uint32_t size;
+        };
+
+        /**
+         * The packed segment within every stride. Segments with a stride
+         * only. The stride holds samples beyond the segment's margins, which
+         * would change how it is interpolated, so only the packed segment is
+         * resampled.
+         */
+        std::vector<PackedSegment> packed_segments;
+
+        /**
+         * In order to not bloat structure unnecessary, contains only margins
+         * that are different from preferred blueprint margin.
+         */
+        std::unordered_map<std::size_t, std::uint8_t> segment_top_margins;
+
+        /**
+         * Runs of segments with data, in order
+         */
+        std::vector<SegmentSpan> spans;
+
+        /**
+         * Record that segment index has data. Segments must be added in order.
+         */
+        void add_segment(std::size_t index) {
+            if (not spans.empty() and spans.back().last == index) {
+                ++spans.back().last;
+            } else {
+                spans.push_back({ index, index + 1 });
+            }
+        }
+    };
 
-    RegularSurface const& m_ref;
-    RegularSurface const& m_top;
-    RegularSurface const& m_bottom;
+    std::shared_ptr<Layout> m_layout;
+
+    std::vector<float> m_data;
+    /**
+     * Number of samples of the subvolume before the start of m_data. 0 unless
+     * this is a tile.
+     */
+    std::size_t m_data_offset = 0;
+
+    /*
+     * Surfaces are views of data owned by the caller, and are cheap to copy.
+     * Holding them by value lets the bounds be shifted views of the reference
+     * that live no longer than the subvolume.
+     */
+    RegularSurface const m_ref;
+    RegularSurface const m_top;
+    RegularSurface const m_bottom;
 
     RawSegmentBlueprint m_segment_blueprint;
 };
 
 /**
- * Constructs new SurfaceBoundedSubVolume object.
+ * Constructs new SurfaceBoundedSubVolume object, without storage for its
+ * data. The data must be fetched and read through tiles, see
+ * SurfaceBoundedSubVolume::tile.
+ * Note that object would be allocated on heap.
+ */
+SurfaceBoundedSubVolume* make_tiled_subvolume(
+    MetadataHandle const& metadata,
+    RegularSurface const& reference,
+    RegularSurface const& top,
+    RegularSurface const& bottom
+);
+
+/**
+ * Constructs new SurfaceBoundedSubVolume object, with storage for the data of
+ * the whole subvolume.
  * Note that object would be allocated on heap.
  */
 SurfaceBoundedSubVolume* make_subvolume(
@@ -558,6 +820,31 @@ SurfaceBoundedSubVolume* make_subvolume(
     RegularSurface const& bottom
 );
 
+/**
+ * Subvolume between above and below the reference surface, i.e. bounded by
+ * reference.shifted(-above) and reference.shifted(below). The bounds share
+ * the data of the reference, so no surface data is copied.
+ *
+ * With a constant window the segments have nearly the same size, so they are
+ * all extended to the size of the longest one and laid out with a stride, see
+ * SurfaceBoundedSubVolume::stride. Segments are extended at the
+ * bottom, or at the top near the end of the trace. Traces too short for the
+ * longest segment fall back to packed segments.
+ */
+SurfaceBoundedSubVolume* make_tiled_subvolume(
+    MetadataHandle const& metadata,
+    RegularSurface const& reference,
+    float above,
+    float below
+);
+
+SurfaceBoundedSubVolume* make_subvolume(
+    MetadataHandle const& metadata,
+    RegularSurface const& reference,
+    float above,
+    float below
+);
+
 /**
  * Resamples source segment into destination.
  */
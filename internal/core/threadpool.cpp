@@ -0,0 +1,225 @@
+#include "threadpool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace {
+
+/* Cpu quota of the cgroup v2 of the process, or 0 if there is none */
+double cgroup_v2_quota() noexcept (false) {
+    std::ifstream file("/sys/fs/cgroup/cpu.max");
+    std::string quota;
+    double period = 0;
+    if (not (file >> quota >> period)) return 0;
+    if (quota == "max" or period <= 0) return 0;
+    return std::stod(quota) / period;
+}
+
+/* Cpu quota of the cgroup v1 of the process, or 0 if there is none */
+double cgroup_v1_quota() noexcept (false) {
+    std::ifstream quota_file("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+    std::ifstream period_file("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+    double quota = 0;
+    double period = 0;
+    if (not (quota_file >> quota) or not (period_file >> period)) return 0;
+    if (quota <= 0 or period <= 0) return 0;
+    return quota / period;
+}
+
+/*
+ * A call to parallel_for. Tasks may be picked up by any thread, including
+ * threads in other calls to parallel_for, so the batch is kept alive by its
+ * tasks.
+ */
+struct Batch {
+    explicit Batch(std::size_t ntasks) : remaining(ntasks) {}
+
+    void complete(std::exception_ptr error) noexcept (true) {
+        std::lock_guard< std::mutex > lock(this->mutex);
+        if (error and not this->error) this->error = error;
+        if (--this->remaining == 0) this->done.notify_all();
+    }
+
+    std::size_t             remaining;
+    std::exception_ptr      error;
+    std::mutex              mutex;
+    std::condition_variable done;
+};
+
+} /* namespace */
+
+std::size_t available_cpus() noexcept (true) {
+    std::size_t cpus = std::max(1u, std::thread::hardware_concurrency());
+    try {
+        double quota = cgroup_v2_quota();
+        if (quota == 0) quota = cgroup_v1_quota();
+        if (quota > 0) {
+            cpus = std::min(cpus, static_cast< std::size_t >(std::ceil(quota)));
+        }
+    } catch (...) {
+        /* Unreadable quotas are treated as no quota */
+    }
+    return std::max< std::size_t >(1, cpus);
+}
+
+ThreadPool& ThreadPool::instance() noexcept (false) {
+    static ThreadPool pool(available_cpus());
+    return pool;
+}
+
+ThreadPool& ThreadPool::io_instance() noexcept (false) {
+    static ThreadPool pool(available_cpus());
+    return pool;
+}
+
+ThreadPool::ThreadPool(std::size_t nthreads) noexcept (false) {
+    nthreads = std::max< std::size_t >(1, nthreads);
+    for (std::size_t i = 0; i < nthreads; ++i) {
+        this->m_queues.emplace_back(new Queue());
+    }
+    for (std::size_t i = 0; i < nthreads; ++i) {
+        this->m_threads.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard< std::mutex > lock(this->m_mutex);
+        this->m_stop = true;
+    }
+    this->m_wakeup.notify_all();
+    for (auto& thread : this->m_threads) {
+        thread.join();
+    }
+}
+
+std::size_t ThreadPool::size() const noexcept (true) {
+    return this->m_threads.size();
+}
+
+void ThreadPool::parallel_for(
+    std::size_t ntasks,
+    std::function< void (std::size_t) > const& task
+) noexcept (false) {
+    if (ntasks == 0) return;
+
+    auto batch = std::make_shared< Batch >(ntasks);
+    std::size_t const nqueues = this->m_queues.size();
+    std::size_t const first = this->m_next.fetch_add(1) % nqueues;
+    for (std::size_t i = 0; i < ntasks; ++i) {
+        Task wrapped = [batch, &task, i] {
+            std::exception_ptr error;
+            try {
+                task(i);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            batch->complete(error);
+        };
+
+        Queue& queue = *this->m_queues[(first + i) % nqueues];
+        std::lock_guard< std::mutex > lock(queue.mutex);
+        queue.tasks.push_back(std::move(wrapped));
+        ++this->m_queued;
+    }
+    {
+        /* Pair with the predicate check of sleeping workers */
+        std::lock_guard< std::mutex > lock(this->m_mutex);
+    }
+    this->m_wakeup.notify_all();
+
+    /*
+     * Work on the tasks until they are all taken. The tasks of this batch
+     * that are still running on workers are then waited for.
+     */
+    Task next;
+    while (true) {
+        {
+            std::lock_guard< std::mutex > lock(batch->mutex);
+            if (batch->remaining == 0) break;
+        }
+        if (not this->pop(first, next)) break;
+        next();
+    }
+
+    std::unique_lock< std::mutex > lock(batch->mutex);
+    batch->done.wait(lock, [&batch] { return batch->remaining == 0; });
+    if (batch->error) std::rethrow_exception(batch->error);
+}
+
+std::future< void > ThreadPool::submit(
+    std::function< void () > task
+) noexcept (false) {
+    /* Tasks must be copyable, packaged tasks are not */
+    auto packaged = std::make_shared< std::packaged_task< void () > >(
+        std::move(task)
+    );
+    std::future< void > result = packaged->get_future();
+
+    std::size_t const nqueues = this->m_queues.size();
+    Queue& queue = *this->m_queues[this->m_next.fetch_add(1) % nqueues];
+    {
+        std::lock_guard< std::mutex > lock(queue.mutex);
+        queue.tasks.push_back([packaged] { (*packaged)(); });
+        ++this->m_queued;
+    }
+    {
+        /* Pair with the predicate check of sleeping workers */
+        std::lock_guard< std::mutex > lock(this->m_mutex);
+    }
+    this->m_wakeup.notify_all();
+    return result;
+}
+
+bool ThreadPool::pop(std::size_t queue, Task& task) noexcept (false) {
+    std::size_t const nqueues = this->m_queues.size();
+    {
+        Queue& own = *this->m_queues[queue];
+        std::lock_guard< std::mutex > lock(own.mutex);
+        if (not own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --this->m_queued;
+            return true;
+        }
+    }
+
+    for (std::size_t i = 1; i < nqueues; ++i) {
+        Queue& other = *this->m_queues[(queue + i) % nqueues];
+        std::lock_guard< std::mutex > lock(other.mutex);
+        if (not other.tasks.empty()) {
+            task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            --this->m_queued;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::work(std::size_t queue) noexcept (true) {
+    Task task;
+    while (true) {
+        if (this->pop(queue, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock< std::mutex > lock(this->m_mutex);
+        this->m_wakeup.wait(lock, [this] {
+            return this->m_stop or this->m_queued.load() > 0;
+        });
+        if (this->m_stop) return;
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef ONESEISMIC_API_THREADPOOL_HPP
+#define ONESEISMIC_API_THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Number of cpus available to the process.
+ *
+ * In containers the cpu quota of the cgroup (v2 cpu.max, or v1
+ * cpu.cfs_quota_us and cpu.cfs_period_us) is usually much lower than the
+ * number of cores of the host. The quota is rounded up to whole cpus. Falls
+ * back to the number of cores when there is no quota, and is at least 1.
+ */
+std::size_t available_cpus() noexcept (true);
+
+/**
+ * Process-wide pool of worker threads with work stealing.
+ *
+ * Every worker has a queue of its own. Tasks are spread over the queues, and
+ * workers take tasks from the back of their own queue. Workers that run out of
+ * tasks steal from the front of the other queues, so that the load is
+ * balanced even when tasks take very different amounts of time.
+ *
+ * The pool of the process is sized to the available cpus, see
+ * available_cpus.
+ */
+class ThreadPool {
+public:
+    static ThreadPool& instance() noexcept (false);
+
+    /**
+     * Process-wide pool for reads that are issued ahead of when their data is
+     * needed, e.g. prefetching. Workers of instance() that wait for such reads
+     * would otherwise deadlock if the reads were queued behind them. Sized
+     * like instance().
+     */
+    static ThreadPool& io_instance() noexcept (false);
+
+    explicit ThreadPool(std::size_t nthreads) noexcept (false);
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    /** Number of worker threads */
+    std::size_t size() const noexcept (true);
+
+    /**
+     * Run task(i) for every i in [0, ntasks) on the pool, and wait for all of
+     * them to complete. The calling thread works on the tasks too, so calls
+     * from within tasks do not deadlock. If tasks throw, the first exception
+     * is rethrown once all tasks have completed.
+     */
+    void parallel_for(
+        std::size_t ntasks,
+        std::function< void (std::size_t) > const& task
+    ) noexcept (false);
+
+    /**
+     * Run task on the pool without waiting for it. The future is ready once
+     * the task has completed, and rethrows what the task threw.
+     */
+    std::future< void > submit(std::function< void () > task) noexcept (false);
+
+private:
+    using Task = std::function< void () >;
+
+    struct Queue {
+        std::mutex        mutex;
+        std::deque< Task > tasks;
+    };
+
+    /*
+     * Take a task from the back of queue, or steal one from the front of
+     * the other queues
+     */
+    bool pop(std::size_t queue, Task& task) noexcept (false);
+
+    void work(std::size_t queue) noexcept (true);
+
+    std::vector< std::unique_ptr< Queue > > m_queues;
+    std::vector< std::thread >              m_threads;
+
+    /* Next queue to push to */
+    std::atomic< std::size_t > m_next{ 0 };
+    /* Number of tasks in the queues */
+    std::atomic< std::size_t > m_queued{ 0 };
+
+    std::mutex              m_mutex;
+    std::condition_variable m_wakeup;
+    bool                    m_stop = false;
+};
+
+#endif /* ONESEISMIC_API_THREADPOOL_HPP */
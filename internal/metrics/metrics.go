@@ -62,6 +62,37 @@ func NewMetrics() *Metrics {
 	return metrics;
 }
 
+/** Mirrors core.ChunkCacheStatistics, which can't be used here without cgo */
+type ChunkCacheStatistics struct {
+	Hits    uint64
+	Misses  uint64
+	Size    uint64
+	Entries uint64
+}
+
+/** Expose the counters of the chunk cache
+ *
+ * statistics is called on every scrape of the metrics endpoint.
+ */
+func (metrics *Metrics) RegisterChunkCache(statistics func() ChunkCacheStatistics) {
+	metrics.registry.MustRegister(
+		prometheus.NewCounterFunc(prometheus.CounterOpts{
+			Name: "oneseismic_api_chunk_cache_hits_count",
+			Help: "oneseismic-api number of chunks found in the chunk cache.",
+		}, func() float64 { return float64(statistics().Hits) }),
+
+		prometheus.NewCounterFunc(prometheus.CounterOpts{
+			Name: "oneseismic_api_chunk_cache_misses_count",
+			Help: "oneseismic-api number of chunks not found in the chunk cache.",
+		}, func() float64 { return float64(statistics().Misses) }),
+
+		prometheus.NewGaugeFunc(prometheus.GaugeOpts{
+			Name: "oneseismic_api_chunk_cache_size_bytes",
+			Help: "oneseismic-api total size of the chunks in the chunk cache.",
+		}, func() float64 { return float64(statistics().Size) }),
+	)
+}
+
 /** New gin middleware for writing prometheus metrics */
 func NewGinMiddleware(metrics *Metrics) gin.HandlerFunc {
 	return func(ctx *gin.Context) {
@@ -49,3 +49,29 @@ func TestExtractStorageAccounts(t *testing.T) {
 		require.ElementsMatch(t, storageAccounts, testcase.expected, "[case: %v]", testcase.name)
 	}
 }
+
+func TestChunkCacheMetrics(t *testing.T) {
+	metrics := NewMetrics()
+	metrics.RegisterChunkCache(func() ChunkCacheStatistics {
+		return ChunkCacheStatistics{Hits: 3, Misses: 2, Size: 1024, Entries: 1}
+	})
+
+	families, err := metrics.registry.Gather()
+	require.NoError(t, err)
+
+	values := map[string]float64{}
+	for _, family := range families {
+		for _, metric := range family.GetMetric() {
+			if counter := metric.GetCounter(); counter != nil {
+				values[family.GetName()] = counter.GetValue()
+			}
+			if gauge := metric.GetGauge(); gauge != nil {
+				values[family.GetName()] = gauge.GetValue()
+			}
+		}
+	}
+
+	require.Equal(t, 3.0, values["oneseismic_api_chunk_cache_hits_count"])
+	require.Equal(t, 2.0, values["oneseismic_api_chunk_cache_misses_count"])
+	require.Equal(t, 1024.0, values["oneseismic_api_chunk_cache_size_bytes"])
+}
@@ -0,0 +1,153 @@
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include "attribute.hpp"
+#include "binaryoperator.hpp"
+
+#include "benchmark/benchmark.h"
+
+/**
+ * Throughput of the attribute statistics kernels.
+ *
+ * Segments are short, from a few samples around a horizon to a couple of
+ * thousand samples for the full trace, so a large share of the time may go to
+ * combining the lanes and to the tail. The sequential benchmarks are the
+ * plain one-sample-at-a-time loops the kernels replaced, and serve as the
+ * reference.
+ *
+ * Run with e.g. --benchmark_filter=Extrema to limit the output.
+ */
+
+namespace {
+
+using Moments = AttributeReducer::Moments;
+using Extrema = AttributeReducer::Extrema;
+
+void segment_lengths(benchmark::internal::Benchmark* benchmark) {
+    for (int n : { 4, 7, 8, 16, 33, 64, 100, 250, 500, 1000, 2000 }) {
+        benchmark->Arg(n);
+    }
+}
+
+std::vector< double > segment(std::size_t n) {
+    std::mt19937 rng(42);
+    std::normal_distribution< double > distribution(0, 100);
+    std::vector< double > data(n);
+    for (auto& x : data) x = distribution(rng);
+    return data;
+}
+
+Moments sequential_moments(double const* data, std::size_t n, double shift) {
+    Moments m{ 0, 0, 0, 0, 0, 0, 0, shift, 0, 0 };
+    for (std::size_t i = 0; i < n; ++i) {
+        double const x = data[i];
+        m.sum    += x;
+        m.sumabs += std::abs(x);
+        m.sumsq  += x * x;
+        if (x > 0) {
+            m.sumpos += x;
+            ++m.npos;
+        }
+        if (x < 0) {
+            m.sumneg += x;
+            ++m.nneg;
+        }
+        double const shifted = x - shift;
+        m.shifted_sum   += shifted;
+        m.shifted_sumsq += shifted * shifted;
+    }
+    return m;
+}
+
+Extrema sequential_extrema(double const* data, std::size_t n) {
+    Extrema e{ 0, 0, 0 };
+    double min    = data[0];
+    double max    = data[0];
+    double maxabs = std::abs(data[0]);
+    for (std::size_t i = 1; i < n; ++i) {
+        double const x = data[i];
+        if (x < min) {
+            min = x;
+            e.min_index = i;
+        }
+        if (x > max) {
+            max = x;
+            e.max_index = i;
+        }
+        if (std::abs(x) > maxabs) {
+            maxabs = std::abs(x);
+            e.maxabs_index = i;
+        }
+    }
+    return e;
+}
+
+void set_processed(benchmark::State& state) {
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(double));
+}
+
+void BM_SequentialMoments(benchmark::State& state) {
+    auto const data = segment(state.range(0));
+    for (auto _ : state) {
+        auto m = sequential_moments(data.data(), data.size(), data[0]);
+        benchmark::DoNotOptimize(m);
+    }
+    set_processed(state);
+}
+
+void BM_SequentialExtrema(benchmark::State& state) {
+    auto const data = segment(state.range(0));
+    for (auto _ : state) {
+        auto e = sequential_extrema(data.data(), data.size());
+        benchmark::DoNotOptimize(e);
+    }
+    set_processed(state);
+}
+
+void run_moments(benchmark::State& state, SimdLevel level) {
+    if (level > simd_level()) {
+        state.SkipWithError("Instruction set not supported by the cpu");
+        return;
+    }
+
+    auto const data = segment(state.range(0));
+    for (auto _ : state) {
+        auto m = AttributeReducer::moments(data.data(), data.size(), data[0], level);
+        benchmark::DoNotOptimize(m);
+    }
+    set_processed(state);
+}
+
+void run_extrema(benchmark::State& state, SimdLevel level) {
+    if (level > simd_level()) {
+        state.SkipWithError("Instruction set not supported by the cpu");
+        return;
+    }
+
+    auto const data = segment(state.range(0));
+    for (auto _ : state) {
+        auto e = AttributeReducer::extrema(data.data(), data.size(), level);
+        benchmark::DoNotOptimize(e);
+    }
+    set_processed(state);
+}
+
+} // namespace
+
+BENCHMARK(BM_SequentialMoments)->Apply(segment_lengths);
+BENCHMARK(BM_SequentialExtrema)->Apply(segment_lengths);
+
+#define ATTRIBUTE_BENCHMARK(function, name, level)     \
+    BENCHMARK_CAPTURE(function, name, level)->Apply(segment_lengths)
+
+ATTRIBUTE_BENCHMARK(run_moments, Moments/Scalar, SimdLevel::SCALAR);
+ATTRIBUTE_BENCHMARK(run_moments, Moments/SSE2,   SimdLevel::SSE2);
+ATTRIBUTE_BENCHMARK(run_moments, Moments/AVX2,   SimdLevel::AVX2);
+ATTRIBUTE_BENCHMARK(run_moments, Moments/AVX512, SimdLevel::AVX512);
+ATTRIBUTE_BENCHMARK(run_extrema, Extrema/Scalar, SimdLevel::SCALAR);
+ATTRIBUTE_BENCHMARK(run_extrema, Extrema/SSE2,   SimdLevel::SSE2);
+ATTRIBUTE_BENCHMARK(run_extrema, Extrema/AVX2,   SimdLevel::AVX2);
+ATTRIBUTE_BENCHMARK(run_extrema, Extrema/AVX512, SimdLevel::AVX512);
@@ -0,0 +1,95 @@
+#include <cstring>
+#include <vector>
+
+#include "binaryoperator.hpp"
+
+#include "benchmark/benchmark.h"
+
+/**
+ * Throughput of the binary operator kernels.
+ *
+ * The kernels read two buffers and write one, so on buffers much larger than
+ * the last level cache they are bound by memory bandwidth. The memcpy
+ * benchmark serves as a reference for what the machine can do, and reports
+ * bytes processed the same way (bytes read + bytes written).
+ *
+ * Run with e.g. --benchmark_filter=Division to limit the output.
+ */
+
+namespace {
+
+/* From a slice that stays in L1 to a depth slice of a large cube */
+constexpr std::int64_t min_size = 1 << 12;
+constexpr std::int64_t max_size = 1 << 24;
+
+void run_kernel(
+    benchmark::State& state,
+    enum binary_operator binary_symbol,
+    SimdLevel level
+) {
+    if (level > simd_level()) {
+        state.SkipWithError("Instruction set not supported by the cpu");
+        return;
+    }
+
+    std::size_t const size = state.range(0);
+    std::vector< float > a(size, 3.0f);
+    std::vector< float > b(size, 2.0f);
+    /*
+     * Not in place, as repeatedly applying the operator to its own result
+     * would eventually produce denormals, which are much slower to process
+     */
+    std::vector< float > dst(size);
+
+    binary_kernel kernel = make_binary_kernel(binary_symbol, level);
+    for (auto _ : state) {
+        kernel(dst.data(), a.data(), b.data(), size);
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(
+        state.iterations() * std::int64_t(size) * 3 * sizeof(float)
+    );
+}
+
+void BM_Memcpy(benchmark::State& state) {
+    std::size_t const size = state.range(0);
+    std::vector< float > a(size, 3.0f);
+    std::vector< float > b(size, 2.0f);
+
+    for (auto _ : state) {
+        std::memcpy(a.data(), b.data(), size * sizeof(float));
+        benchmark::DoNotOptimize(a.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(
+        state.iterations() * std::int64_t(size) * 2 * sizeof(float)
+    );
+}
+
+} // namespace
+
+BENCHMARK(BM_Memcpy)->RangeMultiplier(16)->Range(min_size, max_size);
+
+#define BINARY_OPERATOR_BENCHMARK(name, binary_symbol, level)      \
+    BENCHMARK_CAPTURE(run_kernel, name, binary_symbol, level)      \
+        ->RangeMultiplier(16)->Range(min_size, max_size)
+
+BINARY_OPERATOR_BENCHMARK(Addition/Scalar,       ADDITION,       SimdLevel::SCALAR);
+BINARY_OPERATOR_BENCHMARK(Addition/SSE2,         ADDITION,       SimdLevel::SSE2);
+BINARY_OPERATOR_BENCHMARK(Addition/AVX2,         ADDITION,       SimdLevel::AVX2);
+BINARY_OPERATOR_BENCHMARK(Addition/AVX512,       ADDITION,       SimdLevel::AVX512);
+BINARY_OPERATOR_BENCHMARK(Subtraction/Scalar,    SUBTRACTION,    SimdLevel::SCALAR);
+BINARY_OPERATOR_BENCHMARK(Subtraction/SSE2,      SUBTRACTION,    SimdLevel::SSE2);
+BINARY_OPERATOR_BENCHMARK(Subtraction/AVX2,      SUBTRACTION,    SimdLevel::AVX2);
+BINARY_OPERATOR_BENCHMARK(Subtraction/AVX512,    SUBTRACTION,    SimdLevel::AVX512);
+BINARY_OPERATOR_BENCHMARK(Multiplication/Scalar, MULTIPLICATION, SimdLevel::SCALAR);
+BINARY_OPERATOR_BENCHMARK(Multiplication/SSE2,   MULTIPLICATION, SimdLevel::SSE2);
+BINARY_OPERATOR_BENCHMARK(Multiplication/AVX2,   MULTIPLICATION, SimdLevel::AVX2);
+BINARY_OPERATOR_BENCHMARK(Multiplication/AVX512, MULTIPLICATION, SimdLevel::AVX512);
+BINARY_OPERATOR_BENCHMARK(Division/Scalar,       DIVISION,       SimdLevel::SCALAR);
+BINARY_OPERATOR_BENCHMARK(Division/SSE2,         DIVISION,       SimdLevel::SSE2);
+BINARY_OPERATOR_BENCHMARK(Division/AVX2,         DIVISION,       SimdLevel::AVX2);
+BINARY_OPERATOR_BENCHMARK(Division/AVX512,       DIVISION,       SimdLevel::AVX512);
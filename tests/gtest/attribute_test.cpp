@@ -0,0 +1,303 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "attribute.hpp"
+#include "binaryoperator.hpp"
+#include "ctypes.h"
+#include "subvolume.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector< enum attribute > all_attributes() {
+    std::vector< enum attribute > attributes;
+    for (int i = VALUE; i <= SUMNEG; ++i) {
+        attributes.push_back(static_cast< enum attribute >(i));
+    }
+    return attributes;
+}
+
+/* Straight-forward, one attribute at a time, calculation of the attributes */
+float reference_attribute(ResampledSegment const& segment, enum attribute attribute) {
+    std::vector< double > data(segment.begin(), segment.end());
+    double const n = data.size();
+
+    auto const min = std::min_element(data.begin(), data.end());
+    auto const max = std::max_element(data.begin(), data.end());
+    auto const maxabs = std::max_element(data.begin(), data.end(),
+        [](double a, double b) { return std::abs(a) < std::abs(b); }
+    );
+
+    double const sum = std::accumulate(data.begin(), data.end(), 0.0);
+    double const mean = sum / n;
+    double sumabs = 0, sumsq = 0, sumpos = 0, sumneg = 0, sqdev = 0;
+    int npos = 0, nneg = 0;
+    for (double x : data) {
+        sumabs += std::abs(x);
+        sumsq  += x * x;
+        sqdev  += (x - mean) * (x - mean);
+        if (x > 0) { sumpos += x; ++npos; }
+        if (x < 0) { sumneg += x; ++nneg; }
+    }
+
+    std::vector< double > sorted = data;
+    std::sort(sorted.begin(), sorted.end());
+    double const median = sorted.size() % 2
+        ? sorted[sorted.size() / 2]
+        : (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) / 2;
+
+    switch (attribute) {
+        case VALUE:    return data[segment.reference_index()];
+        case MIN:      return *min;
+        case MINAT:    return segment.sample_position_at(min - data.begin());
+        case MAX:      return *max;
+        case MAXAT:    return segment.sample_position_at(max - data.begin());
+        case MAXABS:   return std::abs(*maxabs);
+        case MAXABSAT: return segment.sample_position_at(maxabs - data.begin());
+        case MEAN:     return mean;
+        case MEANABS:  return sumabs / n;
+        case MEANPOS:  return npos ? sumpos / npos : 0;
+        case MEANNEG:  return nneg ? sumneg / nneg : 0;
+        case MEDIAN:   return median;
+        case RMS:      return std::sqrt(sumsq / n);
+        case VAR:      return sqdev / n;
+        case SD:       return std::sqrt(sqdev / n);
+        case SUMPOS:   return sumpos;
+        case SUMNEG:   return sumneg;
+    }
+    throw std::runtime_error("Unhandled attribute");
+}
+
+class AttributeReducerTest : public ::testing::Test {
+protected:
+    std::vector< float > reduce(
+        ResampledSegment const& segment,
+        std::vector< enum attribute > const& attributes
+    ) {
+        std::vector< float > result(attributes.size());
+        std::vector< void* > dst;
+        for (auto& value : result) dst.push_back(&value);
+
+        AttributeReducer reducer(
+            attributes.data(), attributes.size(), dst.data(), sizeof(float)
+        );
+        reducer.reduce(segment, 0);
+        return result;
+    }
+
+    void check(ResampledSegment const& segment) {
+        auto const attributes = all_attributes();
+        auto const result = reduce(segment, attributes);
+        for (std::size_t i = 0; i < attributes.size(); ++i) {
+            float const expected = reference_attribute(segment, attributes[i]);
+            EXPECT_NEAR(expected, result[i], 1e-4 * std::max(1.0f, std::abs(expected)))
+                << "attribute " << attributes[i];
+        }
+    }
+};
+
+TEST_F(AttributeReducerTest, MatchesSeparateCalculations) {
+    ResampledSegmentBlueprint blueprint(4);
+    ResampledSegment segment(18, 10, 26, &blueprint);
+    ASSERT_EQ(segment.size(), 5);
+
+    std::vector< double > const data = { 1.5, -3, 4, 2, -0.5 };
+    std::copy(data.begin(), data.end(), segment.begin());
+    check(segment);
+}
+
+TEST_F(AttributeReducerTest, MatchesSeparateCalculationsOnLongSegments) {
+    ResampledSegmentBlueprint blueprint(0.1);
+    ResampledSegment segment(18, 10, 26, &blueprint);
+    ASSERT_EQ(segment.size(), 161);
+
+    /* Far from zero, where naive one pass variance loses precision */
+    std::mt19937 rng(42);
+    std::normal_distribution< double > distribution(1e4, 3);
+    std::generate(segment.begin(), segment.end(), [&] { return distribution(rng); });
+    check(segment);
+}
+
+TEST_F(AttributeReducerTest, FirstExtremaAreReported) {
+    ResampledSegmentBlueprint blueprint(4);
+    ResampledSegment segment(18, 10, 26, &blueprint);
+
+    std::vector< double > const data = { 2, -2, 1, 2, -2 };
+    std::copy(data.begin(), data.end(), segment.begin());
+
+    auto const result = reduce(segment, { MINAT, MAXAT, MAXABSAT });
+    EXPECT_THAT(result, ::testing::ElementsAre(14, 10, 10));
+}
+
+TEST_F(AttributeReducerTest, ConstantSegment) {
+    ResampledSegmentBlueprint blueprint(4);
+    ResampledSegment segment(18, 10, 26, &blueprint);
+    std::fill(segment.begin(), segment.end(), 0.3);
+
+    auto const result = reduce(segment, { VAR, SD, MEANPOS, MEANNEG, SUMNEG });
+    EXPECT_THAT(result, ::testing::ElementsAre(0, 0, 0.3f, 0, 0));
+}
+
+TEST_F(AttributeReducerTest, FillWritesEveryAttribute) {
+    std::vector< enum attribute > const attributes = { MEDIAN, VALUE, SD };
+    std::vector< float > result(attributes.size() * 2, 0);
+    std::vector< void* > dst = { &result[0], &result[2], &result[4] };
+
+    AttributeReducer reducer(attributes.data(), attributes.size(), dst.data(), 2 * sizeof(float));
+    EXPECT_EQ(reducer.size(), 2);
+
+    reducer.fill(-999.25, 1);
+    EXPECT_THAT(result, ::testing::ElementsAre(0, -999.25, 0, -999.25, 0, -999.25));
+}
+
+TEST_F(AttributeReducerTest, FillRangeWritesEveryAttribute) {
+    std::vector< enum attribute > const attributes = { MEDIAN, VALUE };
+    std::vector< float > result(attributes.size() * 4, 0);
+    std::vector< void* > dst = { &result[0], &result[4] };
+
+    AttributeReducer reducer(attributes.data(), attributes.size(), dst.data(), 4 * sizeof(float));
+
+    reducer.fill(-999.25, 1, 3);
+    reducer.fill(1, 3, 3);
+    EXPECT_THAT(result, ::testing::ElementsAre(0, -999.25, -999.25, 0, 0, -999.25, -999.25, 0));
+}
+
+TEST_F(AttributeReducerTest, UnknownAttribute) {
+    std::vector< enum attribute > const attributes = { static_cast< enum attribute >(SUMNEG + 1) };
+    float value;
+    void* dst = &value;
+    EXPECT_THROW(
+        AttributeReducer(attributes.data(), attributes.size(), &dst, sizeof(float)),
+        std::runtime_error
+    );
+}
+
+std::vector< SimdLevel > supported_levels() {
+    std::vector< SimdLevel > levels;
+    for (auto level : { SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512 }) {
+        if (level <= simd_level()) levels.push_back(level);
+    }
+    return levels;
+}
+
+/*
+ * Short segments, reduced one sample at a time, and longer segments of whole
+ * blocks of 8 samples, with and without tails
+ */
+std::vector< std::size_t > segment_lengths() {
+    std::vector< std::size_t > lengths;
+    for (std::size_t n = 1; n <= 90; ++n) lengths.push_back(n);
+    lengths.push_back(161);
+    lengths.push_back(2000);
+    return lengths;
+}
+
+TEST(AttributeKernelTest, InstructionSetsAreIdentical) {
+    std::mt19937 rng(7);
+    std::normal_distribution< double > distribution(0.5, 10);
+
+    for (std::size_t n : segment_lengths()) {
+        std::vector< double > data(n);
+        std::generate(data.begin(), data.end(), [&] { return distribution(rng); });
+        data[n / 2] = 0;
+
+        auto const expected = AttributeReducer::moments(data.data(), n, data[0], SimdLevel::SCALAR);
+        for (auto level : supported_levels()) {
+            auto const m = AttributeReducer::moments(data.data(), n, data[0], level);
+            EXPECT_EQ(m.sum,           expected.sum)           << "n = " << n;
+            EXPECT_EQ(m.sumabs,        expected.sumabs)        << "n = " << n;
+            EXPECT_EQ(m.sumsq,         expected.sumsq)         << "n = " << n;
+            EXPECT_EQ(m.sumpos,        expected.sumpos)        << "n = " << n;
+            EXPECT_EQ(m.sumneg,        expected.sumneg)        << "n = " << n;
+            EXPECT_EQ(m.npos,          expected.npos)          << "n = " << n;
+            EXPECT_EQ(m.nneg,          expected.nneg)          << "n = " << n;
+            EXPECT_EQ(m.shifted_sum,   expected.shifted_sum)   << "n = " << n;
+            EXPECT_EQ(m.shifted_sumsq, expected.shifted_sumsq) << "n = " << n;
+        }
+    }
+}
+
+TEST(AttributeKernelTest, MomentsMatchSequentialSums) {
+    std::mt19937 rng(11);
+    std::normal_distribution< double > distribution(-0.5, 10);
+
+    for (std::size_t n : segment_lengths()) {
+        std::vector< double > data(n);
+        std::generate(data.begin(), data.end(), [&] { return distribution(rng); });
+        double const shift = data[n - 1];
+
+        double sum = 0, sumabs = 0, sumsq = 0, sumpos = 0, sumneg = 0;
+        double shifted_sum = 0, shifted_sumsq = 0;
+        std::size_t npos = 0, nneg = 0;
+        for (double x : data) {
+            sum    += x;
+            sumabs += std::abs(x);
+            sumsq  += x * x;
+            if (x > 0) { sumpos += x; ++npos; }
+            if (x < 0) { sumneg += x; ++nneg; }
+            shifted_sum   += x - shift;
+            shifted_sumsq += (x - shift) * (x - shift);
+        }
+
+        for (auto level : supported_levels()) {
+            auto const m = AttributeReducer::moments(data.data(), n, shift, level);
+            double const tolerance = 1e-12 * sumsq + 1e-12;
+            EXPECT_NEAR(m.sum,           sum,           tolerance) << "n = " << n;
+            EXPECT_NEAR(m.sumabs,        sumabs,        tolerance) << "n = " << n;
+            EXPECT_NEAR(m.sumsq,         sumsq,         tolerance) << "n = " << n;
+            EXPECT_NEAR(m.sumpos,        sumpos,        tolerance) << "n = " << n;
+            EXPECT_NEAR(m.sumneg,        sumneg,        tolerance) << "n = " << n;
+            EXPECT_NEAR(m.shifted_sum,   shifted_sum,   tolerance) << "n = " << n;
+            EXPECT_NEAR(m.shifted_sumsq, shifted_sumsq, tolerance) << "n = " << n;
+            EXPECT_EQ(m.npos,  npos) << "n = " << n;
+            EXPECT_EQ(m.nneg,  nneg) << "n = " << n;
+            EXPECT_EQ(m.shift, shift);
+        }
+    }
+}
+
+TEST(AttributeKernelTest, ExtremaAreFirstOccurrences) {
+    /* Few distinct values, so that there are ties both within and across lanes */
+    std::mt19937 rng(13);
+    std::uniform_int_distribution< int > distribution(-3, 3);
+
+    auto const abs_less = [](double a, double b) { return std::abs(a) < std::abs(b); };
+    for (std::size_t n : segment_lengths()) {
+        std::vector< double > data(n);
+        std::generate(data.begin(), data.end(), [&] { return distribution(rng); });
+
+        std::size_t const min = std::min_element(data.begin(), data.end()) - data.begin();
+        std::size_t const max = std::max_element(data.begin(), data.end()) - data.begin();
+        std::size_t const maxabs =
+            std::max_element(data.begin(), data.end(), abs_less) - data.begin();
+
+        for (auto level : supported_levels()) {
+            auto const e = AttributeReducer::extrema(data.data(), n, level);
+            EXPECT_EQ(e.min_index,    min)    << "n = " << n;
+            EXPECT_EQ(e.max_index,    max)    << "n = " << n;
+            EXPECT_EQ(e.maxabs_index, maxabs) << "n = " << n;
+        }
+    }
+}
+
+TEST(AttributeKernelTest, ExtremaInTheTail) {
+    std::vector< double > data(70, 1);
+    data[3]  = -4;
+    data[67] = -5;
+    data[69] = 6;
+
+    for (auto level : supported_levels()) {
+        auto const e = AttributeReducer::extrema(data.data(), data.size(), level);
+        EXPECT_EQ(e.min_index,    67);
+        EXPECT_EQ(e.max_index,    69);
+        EXPECT_EQ(e.maxabs_index, 69);
+    }
+}
+
+} // namespace
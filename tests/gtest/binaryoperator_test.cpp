@@ -0,0 +1,120 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "binaryoperator.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+const std::vector< binary_operator > operators = {
+    ADDITION, SUBTRACTION, MULTIPLICATION, DIVISION
+};
+
+/* All instruction sets supported by the running cpu */
+std::vector< SimdLevel > supported_levels() {
+    std::vector< SimdLevel > levels;
+    for (auto level : { SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512 }) {
+        if (level <= simd_level()) levels.push_back(level);
+    }
+    return levels;
+}
+
+class BinaryOperatorTest : public ::testing::Test {
+protected:
+    /* Odd size, so that all kernels have to handle a tail */
+    static constexpr std::size_t size = 1000 + 13;
+
+    std::vector< float > a;
+    std::vector< float > b;
+
+    void SetUp() override {
+        std::mt19937 gen(42);
+        std::uniform_real_distribution< float > distribution(-100, 100);
+
+        a.resize(size);
+        b.resize(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            a[i] = distribution(gen);
+            b[i] = distribution(gen);
+        }
+    }
+};
+
+TEST_F(BinaryOperatorTest, MatchesScalarKernel) {
+    for (auto binary_symbol : operators) {
+        std::vector< float > expected(size);
+        make_binary_kernel(binary_symbol, SimdLevel::SCALAR)(
+            expected.data(), a.data(), b.data(), size
+        );
+
+        for (auto level : supported_levels()) {
+            std::vector< float > result(size);
+            make_binary_kernel(binary_symbol, level)(
+                result.data(), a.data(), b.data(), size
+            );
+            EXPECT_THAT(result, testing::Pointwise(testing::FloatEq(), expected))
+                << "operator " << binary_symbol << ", level " << (int)level;
+        }
+    }
+}
+
+TEST_F(BinaryOperatorTest, InPlace) {
+    for (auto level : supported_levels()) {
+        std::vector< float > result = a;
+        make_binary_kernel(SUBTRACTION, level)(
+            result.data(), result.data(), b.data(), size
+        );
+        for (std::size_t i = 0; i < size; ++i) {
+            EXPECT_FLOAT_EQ(result[i], a[i] - b[i])
+                << "at " << i << ", level " << (int)level;
+        }
+    }
+}
+
+TEST_F(BinaryOperatorTest, ShortBuffers) {
+    for (auto level : supported_levels()) {
+        for (std::size_t n = 0; n < 40; ++n) {
+            std::vector< float > result(size, -1);
+            make_binary_kernel(ADDITION, level)(
+                result.data(), a.data(), b.data(), n
+            );
+            for (std::size_t i = 0; i < n; ++i) {
+                EXPECT_FLOAT_EQ(result[i], a[i] + b[i]);
+            }
+            /* Nothing is written past the end */
+            EXPECT_EQ(result[n], -1) << "n " << n << ", level " << (int)level;
+        }
+    }
+}
+
+TEST_F(BinaryOperatorTest, DivisionByZeroFollowsIEEE) {
+    std::vector< float > dividends = { 1, -1, 0, 2.5, -0.0f, 3 };
+    std::vector< float > divisors  = { 0, 0, 0, -0.0f, 0, 2 };
+
+    for (auto level : supported_levels()) {
+        std::vector< float > result(dividends.size());
+        make_binary_kernel(DIVISION, level)(
+            result.data(), dividends.data(), divisors.data(), result.size()
+        );
+        EXPECT_EQ(result[0],  INFINITY) << "level " << (int)level;
+        EXPECT_EQ(result[1], -INFINITY) << "level " << (int)level;
+        EXPECT_TRUE(std::isnan(result[2])) << "level " << (int)level;
+        EXPECT_EQ(result[3], -INFINITY) << "level " << (int)level;
+        EXPECT_TRUE(std::isnan(result[4])) << "level " << (int)level;
+        EXPECT_FLOAT_EQ(result[5], 1.5);
+    }
+}
+
+TEST(BinaryOperatorErrorTest, InvalidOperator) {
+    EXPECT_THAT(
+        []() { make_binary_kernel(NO_OPERATOR); },
+        testing::ThrowsMessage< std::invalid_argument >(
+            testing::HasSubstr("Unhandled binary operator")
+        )
+    );
+}
+
+} // namespace
@@ -0,0 +1,255 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "chunkcache.hpp"
+#include "cppapi.hpp"
+#include "ctypes.h"
+#include "datahandle.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+const std::string VDS = "file://well_known_default.vds";
+const std::string CREDENTIALS = "";
+
+/* Number of shards in ChunkCache */
+constexpr std::size_t nshards = 16;
+
+ChunkCache::Chunk make_chunk(std::size_t nsamples, float value) {
+    return std::make_shared< std::vector< float > const >(nsamples, value);
+}
+
+class ChunkCacheTest : public ::testing::Test {
+protected:
+    ChunkCache& cache = ChunkCache::instance();
+
+    static constexpr std::size_t chunk_samples = 256;
+    static constexpr std::size_t chunk_size = chunk_samples * sizeof(float);
+
+    void SetUp() override {
+        /* Room for two chunks in every shard */
+        cache.configure(nshards * 2 * chunk_size);
+        cache.clear();
+        cache.reset_statistics();
+    }
+
+    void TearDown() override {
+        cache.configure(0);
+        cache.reset_statistics();
+    }
+};
+
+TEST_F(ChunkCacheTest, CountsHitsAndMisses) {
+    ChunkCache::Key const key{ "vds", 0, 7 };
+
+    EXPECT_EQ(cache.get(key), nullptr);
+    cache.put(key, make_chunk(chunk_samples, 1));
+    ASSERT_NE(cache.get(key), nullptr);
+    EXPECT_EQ(cache.get(key)->front(), 1);
+
+    auto const statistics = cache.statistics();
+    EXPECT_EQ(statistics.hits,    2);
+    EXPECT_EQ(statistics.misses,  1);
+    EXPECT_EQ(statistics.entries, 1);
+    EXPECT_EQ(statistics.size,    chunk_size);
+}
+
+TEST_F(ChunkCacheTest, KeysAreDistinct) {
+    cache.put({ "vds",   0, 0 }, make_chunk(chunk_samples, 1));
+    cache.put({ "vds",   1, 0 }, make_chunk(chunk_samples, 2));
+    cache.put({ "vds",   0, 1 }, make_chunk(chunk_samples, 3));
+    cache.put({ "other", 0, 0 }, make_chunk(chunk_samples, 4));
+
+    EXPECT_EQ(cache.get({ "vds",   0, 0 })->front(), 1);
+    EXPECT_EQ(cache.get({ "vds",   1, 0 })->front(), 2);
+    EXPECT_EQ(cache.get({ "vds",   0, 1 })->front(), 3);
+    EXPECT_EQ(cache.get({ "other", 0, 0 })->front(), 4);
+}
+
+TEST_F(ChunkCacheTest, BoundedBySize) {
+    for (std::int64_t i = 0; i < 1000; ++i) {
+        cache.put({ "vds", 0, i }, make_chunk(chunk_samples, i));
+    }
+
+    auto const statistics = cache.statistics();
+    EXPECT_LE(statistics.size, nshards * 2 * chunk_size);
+    EXPECT_LE(statistics.entries, nshards * 2);
+    EXPECT_EQ(statistics.size, statistics.entries * chunk_size);
+}
+
+TEST_F(ChunkCacheTest, EvictsLeastRecentlyUsed) {
+    ChunkCache::Key const hot{ "vds", 0, -1 };
+    cache.put(hot, make_chunk(chunk_samples, 1));
+
+    for (std::int64_t i = 0; i < 1000; ++i) {
+        cache.put({ "vds", 0, i }, make_chunk(chunk_samples, i));
+        ASSERT_NE(cache.get(hot), nullptr) << "evicted after " << i;
+    }
+}
+
+TEST_F(ChunkCacheTest, ChunkOutlivesEviction) {
+    ChunkCache::Key const key{ "vds", 0, 0 };
+    cache.put(key, make_chunk(chunk_samples, 1));
+
+    auto chunk = cache.get(key);
+    cache.clear();
+    EXPECT_EQ(cache.get(key), nullptr);
+    EXPECT_EQ(chunk->front(), 1);
+}
+
+TEST_F(ChunkCacheTest, OversizedChunksAreNotCached) {
+    ChunkCache::Key const key{ "vds", 0, 0 };
+    cache.put(key, make_chunk(3 * chunk_samples, 1));
+    EXPECT_EQ(cache.get(key), nullptr);
+    EXPECT_EQ(cache.statistics().size, 0);
+}
+
+TEST_F(ChunkCacheTest, MaxChunkSizeIsShardCapacity) {
+    EXPECT_EQ(cache.capacity(), nshards * 2 * chunk_size);
+    EXPECT_EQ(cache.max_chunk_size(), 2 * chunk_size);
+
+    ChunkCache::Key const key{ "vds", 0, 0 };
+    cache.put(key, make_chunk(2 * chunk_samples, 1));
+    EXPECT_NE(cache.get(key), nullptr);
+}
+
+TEST_F(ChunkCacheTest, DisabledCacheDropsChunks) {
+    cache.put({ "vds", 0, 0 }, make_chunk(chunk_samples, 1));
+    cache.configure(0);
+
+    EXPECT_FALSE(cache.enabled());
+    EXPECT_EQ(cache.statistics().entries, 0);
+
+    cache.put({ "vds", 0, 0 }, make_chunk(chunk_samples, 1));
+    EXPECT_EQ(cache.statistics().entries, 0);
+}
+
+class ChunkCacheSliceTest : public ::testing::Test {
+protected:
+    ChunkCache& cache = ChunkCache::instance();
+
+    void TearDown() override {
+        cache.configure(0);
+        cache.clear();
+        cache.reset_statistics();
+    }
+
+    std::vector< float > slice(
+        DataHandle& datahandle,
+        axis_name axis,
+        int lineno,
+        LevelOfDetail lod = LevelOfDetail{ 0, 0 }
+    ) {
+        struct response response_data;
+        cppapi::slice(
+            datahandle,
+            Direction(axis),
+            lineno,
+            std::vector< Bound >{},
+            lod,
+            nullptr,
+            &response_data
+        );
+
+        float const* data = reinterpret_cast< float* >(response_data.data);
+        std::vector< float > samples(
+            data,
+            data + response_data.size / sizeof(float)
+        );
+        delete[] response_data.data;
+        return samples;
+    }
+};
+
+TEST_F(ChunkCacheSliceTest, SlicesMatchUncachedReads) {
+    SingleDataHandle datahandle = make_single_datahandle(
+        VDS.c_str(),
+        CREDENTIALS.c_str()
+    );
+
+    std::vector< std::vector< float > > expected;
+    for (auto axis : { axis_name::I, axis_name::J, axis_name::K }) {
+        expected.push_back(slice(datahandle, axis, 1));
+    }
+
+    cache.configure(64 * 1024 * 1024);
+    for (int pass = 0; pass < 2; ++pass) {
+        std::size_t i = 0;
+        for (auto axis : { axis_name::I, axis_name::J, axis_name::K }) {
+            EXPECT_EQ(slice(datahandle, axis, 1), expected[i++])
+                << "axis " << axis << ", pass " << pass;
+        }
+    }
+
+    auto const statistics = cache.statistics();
+    EXPECT_GT(statistics.misses, 0);
+    EXPECT_GT(statistics.hits,   0);
+    EXPECT_GT(statistics.entries, 0);
+}
+
+TEST_F(ChunkCacheSliceTest, NeighbouringSlicesShareChunks) {
+    SingleDataHandle datahandle = make_single_datahandle(
+        VDS.c_str(),
+        CREDENTIALS.c_str()
+    );
+
+    cache.configure(64 * 1024 * 1024);
+    slice(datahandle, axis_name::I, 0);
+    auto const first = cache.statistics();
+
+    slice(datahandle, axis_name::I, 1);
+    auto const second = cache.statistics();
+
+    EXPECT_EQ(second.misses, first.misses);
+    EXPECT_GT(second.hits,   first.hits);
+}
+
+TEST_F(ChunkCacheSliceTest, ReadsTooLargeForTheCacheBypassIt) {
+    SingleDataHandle datahandle = make_single_datahandle(
+        VDS.c_str(),
+        CREDENTIALS.c_str()
+    );
+
+    auto const expected = slice(datahandle, axis_name::I, 1);
+
+    /* Room for a single float per shard, too small for any chunk */
+    cache.configure(nshards * sizeof(float));
+    EXPECT_EQ(slice(datahandle, axis_name::I, 1), expected);
+
+    auto const statistics = cache.statistics();
+    EXPECT_EQ(statistics.misses,  0);
+    EXPECT_EQ(statistics.entries, 0);
+}
+
+TEST_F(ChunkCacheSliceTest, LevelsOfDetailAreCachedSeparately) {
+    SingleDataHandle datahandle = make_single_datahandle(
+        VDS.c_str(),
+        CREDENTIALS.c_str()
+    );
+    int const lod = std::min(datahandle.max_lod(), 1);
+
+    auto const expected = slice(datahandle, axis_name::K, 0, LevelOfDetail{ lod, 0 });
+
+    cache.configure(64 * 1024 * 1024);
+    slice(datahandle, axis_name::K, 0);
+    EXPECT_EQ(slice(datahandle, axis_name::K, 0, LevelOfDetail{ lod, 0 }), expected);
+}
+
+TEST_F(ChunkCacheSliceTest, DoubleDatahandle) {
+    DoubleDataHandle datahandle = make_double_datahandle(
+        VDS.c_str(), CREDENTIALS.c_str(),
+        VDS.c_str(), CREDENTIALS.c_str(),
+        binary_operator::SUBTRACTION
+    );
+
+    auto const expected = slice(datahandle, axis_name::J, 2);
+
+    cache.configure(64 * 1024 * 1024);
+    EXPECT_EQ(slice(datahandle, axis_name::J, 2), expected);
+    EXPECT_EQ(slice(datahandle, axis_name::J, 2), expected);
+}
+
+} // namespace
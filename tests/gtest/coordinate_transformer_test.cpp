@@ -1,3 +1,7 @@
+#include <random>
+#include <vector>
+
+#include "binaryoperator.hpp"
 #include "coordinate_transformer.hpp"
 #include "ctypes.h"
 #include "datahandle.hpp"
@@ -132,4 +136,208 @@ TEST(NegativeCoordinateTransformerTest, NegativeAnnotation) {
     EXPECT_EQ(as_annotation.Y, transformer.WorldToAnnotation(as_cdp).Y);
 }
 
+class HorizontalTransformTest : public ::testing::TestWithParam< std::string > {
+protected:
+    HorizontalTransformTest()
+        : datahandle(make_single_datahandle(GetParam().c_str(), CREDENTIALS.c_str()))
+    {}
+
+    SingleDataHandle datahandle;
+
+    /* Sample positions as computed point by point */
+    void expected_positions(
+        enum coordinate_system system,
+        std::vector< double > const& x,
+        std::vector< double > const& y,
+        std::vector< double >& iline_positions,
+        std::vector< double >& xline_positions
+    ) {
+        MetadataHandle const& metadata = datahandle.get_metadata();
+        CoordinateTransformer const& transformer = metadata.coordinate_transformer();
+        Axis iline = metadata.iline();
+        Axis xline = metadata.xline();
+
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            OpenVDS::DoubleVector3 annotation;
+            switch (system) {
+                case INDEX:      annotation = transformer.IJKPositionToAnnotation({x[i], y[i], 0}); break;
+                case ANNOTATION: annotation = {x[i], y[i], 0}; break;
+                case CDP:        annotation = transformer.WorldToAnnotation({x[i], y[i], 0}); break;
+            }
+            iline_positions.push_back(iline.to_sample_position(annotation[0]));
+            xline_positions.push_back(xline.to_sample_position(annotation[1]));
+        }
+    }
+
+    /* Points on, between and around the lines of the survey */
+    void points(
+        enum coordinate_system system,
+        std::vector< double >& x,
+        std::vector< double >& y
+    ) {
+        MetadataHandle const& metadata = datahandle.get_metadata();
+        CoordinateTransformer const& transformer = metadata.coordinate_transformer();
+        Axis const iline = metadata.iline();
+        Axis const xline = metadata.xline();
+
+        for (double i = -1; i <= iline.nsamples(); i += 0.25) {
+            for (double j = -1; j <= xline.nsamples(); j += 0.25) {
+                switch (system) {
+                    case INDEX: {
+                        x.push_back(i);
+                        y.push_back(j);
+                        break;
+                    }
+                    case ANNOTATION: {
+                        x.push_back(iline.min() + i * iline.stepsize());
+                        y.push_back(xline.min() + j * xline.stepsize());
+                        break;
+                    }
+                    case CDP: {
+                        auto const origin = transformer.IJKIndexToWorld({0, 0, 0});
+                        auto const di = transformer.IJKIndexToWorld({1, 0, 0});
+                        auto const dj = transformer.IJKIndexToWorld({0, 1, 0});
+                        x.push_back(origin[0] + i * (di[0] - origin[0]) + j * (dj[0] - origin[0]));
+                        y.push_back(origin[1] + i * (di[1] - origin[1]) + j * (dj[1] - origin[1]));
+                        break;
+                    }
+                }
+            }
+        }
+    }
+};
+
+TEST_P(HorizontalTransformTest, MatchesPointByPointTransform) {
+    MetadataHandle const& metadata = datahandle.get_metadata();
+
+    for (auto system : { INDEX, ANNOTATION, CDP }) {
+        std::vector< double > x, y;
+        points(system, x, y);
+
+        std::vector< double > expected_iline, expected_xline;
+        expected_positions(system, x, y, expected_iline, expected_xline);
+
+        HorizontalTransform const transform =
+            metadata.coordinate_transformer().horizontal_transform(
+                system,
+                metadata.iline(),
+                metadata.xline()
+            );
+        std::vector< double > iline(x.size()), xline(x.size());
+        transform.to_sample_positions(x.data(), y.data(), x.size(), iline.data(), xline.data());
+
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            EXPECT_NEAR(iline[i], expected_iline[i], 1e-4)
+                << "system " << system << ", point (" << x[i] << ", " << y[i] << ")";
+            EXPECT_NEAR(xline[i], expected_xline[i], 1e-4)
+                << "system " << system << ", point (" << x[i] << ", " << y[i] << ")";
+        }
+    }
+}
+
+TEST_P(HorizontalTransformTest, HalfwayBetweenLinesIsExact) {
+    MetadataHandle const& metadata = datahandle.get_metadata();
+    Axis const iline = metadata.iline();
+    Axis const xline = metadata.xline();
+
+    for (auto system : { INDEX, ANNOTATION }) {
+        HorizontalTransform const transform =
+            metadata.coordinate_transformer().horizontal_transform(system, iline, xline);
+
+        for (int line = -1; line < iline.nsamples(); ++line) {
+            double const x = system == INDEX
+                ? line + 0.5
+                : iline.min() + (line + 0.5) * iline.stepsize();
+            double const y = system == INDEX
+                ? line + 0.5
+                : xline.min() + (line + 0.5) * xline.stepsize();
+
+            double iline_position, xline_position;
+            transform.to_sample_positions(&x, &y, 1, &iline_position, &xline_position);
+            EXPECT_EQ(iline_position, line + 1) << "system " << system;
+            EXPECT_EQ(xline_position, line + 1) << "system " << system;
+        }
+    }
+}
+
+TEST_P(HorizontalTransformTest, VectorizedMatchesScalar) {
+    MetadataHandle const& metadata = datahandle.get_metadata();
+    CoordinateTransformer const& transformer = metadata.coordinate_transformer();
+    auto const origin = transformer.IJKIndexToWorld({0, 0, 0});
+
+    /* Odd size, so that all kernels have to handle a tail */
+    std::size_t const size = 1000 + 13;
+    std::mt19937 gen(42);
+    std::uniform_real_distribution< double > distribution(-100, 100);
+    std::vector< double > x(size), y(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        x[i] = origin[0] + distribution(gen);
+        y[i] = origin[1] + distribution(gen);
+    }
+
+    HorizontalTransform const transform = transformer.horizontal_transform(
+        CDP,
+        metadata.iline(),
+        metadata.xline()
+    );
+
+    std::vector< double > expected_iline(size), expected_xline(size);
+    transform.to_sample_positions(
+        x.data(), y.data(), size,
+        expected_iline.data(), expected_xline.data(),
+        SimdLevel::SCALAR
+    );
+
+    for (auto level : { SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512 }) {
+        if (level > simd_level()) continue;
+
+        std::vector< double > iline(size), xline(size);
+        transform.to_sample_positions(
+            x.data(), y.data(), size,
+            iline.data(), xline.data(),
+            level
+        );
+        EXPECT_EQ(iline, expected_iline) << "level " << int(level);
+        EXPECT_EQ(xline, expected_xline) << "level " << int(level);
+    }
+}
+
+TEST_P(HorizontalTransformTest, InrangeWithMargin) {
+    MetadataHandle const& metadata = datahandle.get_metadata();
+    Axis const iline = metadata.iline();
+    Axis const xline = metadata.xline();
+    HorizontalTransform const transform =
+        metadata.coordinate_transformer().horizontal_transform(ANNOTATION, iline, xline);
+
+    std::vector< double > x, y;
+    points(ANNOTATION, x, y);
+    std::vector< double > iline_positions(x.size()), xline_positions(x.size());
+    transform.to_sample_positions(
+        x.data(), y.data(), x.size(),
+        iline_positions.data(), xline_positions.data()
+    );
+
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        EXPECT_EQ(
+            transform.inrange_with_margin(0, iline_positions[i]),
+            iline.inrange_with_margin(x[i])
+        ) << "inline " << x[i];
+        EXPECT_EQ(
+            transform.inrange_with_margin(1, xline_positions[i]),
+            xline.inrange_with_margin(y[i])
+        ) << "crossline " << y[i];
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    HorizontalTransformTests,
+    HorizontalTransformTest,
+    ::testing::Values(
+        "file://well_known_default.vds",
+        "file://well_known_custom_inline_spacing.vds",
+        "file://well_known_custom_origin.vds",
+        "file://10_negative.vds"
+    )
+);
+
 } // namespace
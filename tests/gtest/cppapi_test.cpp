@@ -1,4 +1,9 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <stdexcept>
 
 #include "cppapi.hpp"
 #include "ctypes.h"
@@ -366,6 +371,611 @@ TEST_F(SubvolumeTest, LargestPossibleMarginRetrievedNearTraceBottomBoundary)
     delete subvolume;
 }
 
+TEST_F(SubvolumeTest, TraceReadsMatchSampleReads)
+{
+    static constexpr int nrows = 4;
+    static constexpr int ncols = 6;
+    static constexpr std::size_t size = nrows * ncols;
+
+    std::array<float, size> surface_data = {
+        24, 20, 24, 24, 24, 20,
+        20, 20, 20, 24, 20, 24,
+        20, 24, 20, 20, 24, 20,
+        24, 24, 24, 24, 20, 24
+    };
+
+    std::array<float, size> above_data = surface_data;
+    std::array<float, size> below_data = surface_data;
+    std::transform(above_data.cbegin(), above_data.cend(), above_data.begin(),
+                   [](float value) { return value - 5; });
+    std::transform(below_data.cbegin(), below_data.cend(), below_data.begin(),
+                   [](float value) { return value + 6; });
+
+    RegularSurface primary_surface =
+        RegularSurface(surface_data.data(), nrows, ncols, other_grid, fill);
+    RegularSurface top_surface =
+        RegularSurface(above_data.data(), nrows, ncols, other_grid, fill);
+    RegularSurface bottom_surface =
+        RegularSurface(below_data.data(), nrows, ncols, other_grid, fill);
+
+    for (auto interpolation : { NEAREST, LINEAR }) {
+        std::unique_ptr< SurfaceBoundedSubVolume > expected(make_subvolume(
+            datahandle.get_metadata(), primary_surface, top_surface, bottom_surface
+        ));
+        cppapi::fetch_subvolume(datahandle, *expected, interpolation, 0, size);
+
+        std::unique_ptr< SurfaceBoundedSubVolume > subvolume(make_subvolume(
+            datahandle.get_metadata(), primary_surface, top_surface, bottom_surface
+        ));
+        cppapi::configure_subvolume_trace_reads(true);
+        cppapi::fetch_subvolume(datahandle, *subvolume, interpolation, 0, size);
+        cppapi::configure_subvolume_trace_reads(false);
+
+        for (int i = 0; i < size; ++i) {
+            ASSERT_EQ(expected->is_empty(i), subvolume->is_empty(i));
+            if (subvolume->is_empty(i)) continue;
+
+            auto const expected_segment = expected->vertical_segment(i);
+            auto const segment = subvolume->vertical_segment(i);
+            ASSERT_EQ(expected_segment.size(), segment.size());
+
+            auto it = segment.begin();
+            for (auto value : expected_segment) {
+                EXPECT_NEAR(value, *it++, 1e-4)
+                    << "at position " << i << ", interpolation " << interpolation;
+            }
+        }
+    }
+}
+
+TEST_F(SubvolumeTest, TiledAttributesMatchAttributes)
+{
+    static constexpr int nrows = 4;
+    static constexpr int ncols = 6;
+    static constexpr std::size_t size = nrows * ncols;
+
+    std::array<float, size> surface_data = {
+        24, 20, 24, 24, 24, 20,
+        20, 20, 20, 24, 20, 24,
+        20, 24, 20, 20, 24, 20,
+        24, 24, 24, 24, 20, 24
+    };
+
+    std::array<float, size> above_data = surface_data;
+    std::array<float, size> below_data = surface_data;
+    std::transform(above_data.cbegin(), above_data.cend(), above_data.begin(),
+                   [](float value) { return value - 8; });
+    std::transform(below_data.cbegin(), below_data.cend(), below_data.begin(),
+                   [](float value) { return value + 4; });
+
+    RegularSurface primary_surface =
+        RegularSurface(surface_data.data(), nrows, ncols, other_grid, fill);
+    RegularSurface top_surface =
+        RegularSurface(above_data.data(), nrows, ncols, other_grid, fill);
+    RegularSurface bottom_surface =
+        RegularSurface(below_data.data(), nrows, ncols, other_grid, fill);
+
+    std::array<attribute, 4> attributes = { VALUE, MIN, MEAN, RMS };
+    static constexpr std::size_t nattributes = attributes.size();
+    ResampledSegmentBlueprint blueprint(1);
+
+    auto outs = [](std::vector<float>& buffer) {
+        std::array<void*, nattributes> outs;
+        for (std::size_t i = 0; i < nattributes; ++i) {
+            outs[i] = buffer.data() + i * size;
+        }
+        return outs;
+    };
+
+    std::vector<float> expected(size * nattributes);
+    {
+        std::unique_ptr< SurfaceBoundedSubVolume > subvolume(make_subvolume(
+            datahandle.get_metadata(), primary_surface, top_surface, bottom_surface
+        ));
+        cppapi::fetch_subvolume(datahandle, *subvolume, NEAREST, 0, size);
+        auto dst = outs(expected);
+        cppapi::attributes(
+            *subvolume, &blueprint, attributes.data(), nattributes, 0, size, dst.data()
+        );
+    }
+
+    std::unique_ptr< SurfaceBoundedSubVolume > subvolume(make_tiled_subvolume(
+        datahandle.get_metadata(), primary_surface, top_surface, bottom_surface
+    ));
+
+    /* Unlimited, a budget for a few segments, and a budget for less than one */
+    for (std::size_t budget : { 0, 64 * 1024, 1 }) {
+        for (std::size_t depth : { 0, 1, 3 }) {
+            cppapi::configure_attribute_memory(budget);
+            cppapi::configure_attribute_prefetch(depth);
+
+            std::vector<float> result(size * nattributes);
+            auto dst = outs(result);
+            cppapi::tiled_attributes(
+                datahandle,
+                *subvolume,
+                NEAREST,
+                &blueprint,
+                attributes.data(),
+                nattributes,
+                2,
+                size,
+                dst.data()
+            );
+            cppapi::tiled_attributes(
+                datahandle,
+                *subvolume,
+                NEAREST,
+                &blueprint,
+                attributes.data(),
+                nattributes,
+                0,
+                2,
+                dst.data()
+            );
+            EXPECT_EQ(result, expected)
+                << "with budget " << budget << " and prefetch depth " << depth;
+
+            std::vector<float> parallel_result(size * nattributes);
+            auto parallel_dst = outs(parallel_result);
+            cppapi::parallel_attributes(
+                datahandle,
+                *subvolume,
+                NEAREST,
+                &blueprint,
+                attributes.data(),
+                nattributes,
+                0,
+                size,
+                parallel_dst.data()
+            );
+            cppapi::configure_attribute_memory(0);
+            cppapi::configure_attribute_prefetch(0);
+
+            EXPECT_EQ(parallel_result, expected)
+                << "in parallel with budget " << budget << " and prefetch depth " << depth;
+        }
+    }
+}
+
+TEST_F(SubvolumeTest, HorizonValuesMatchAttributes)
+{
+    static constexpr int nrows = 3;
+    static constexpr int ncols = 4;
+    static constexpr std::size_t size = nrows * ncols;
+
+    /* On samples, between samples, and between samples near the trace ends */
+    std::array<float, size> surface_data = {
+        20,   24,   21,   22.5,
+        5,    39,   fill, 6.4,
+        37.2, 28.3, 24,   4.9
+    };
+
+    RegularSurface primary_surface =
+        RegularSurface(surface_data.data(), nrows, ncols, other_grid, fill);
+
+    std::array<attribute, 2> attributes = { VALUE, VALUE };
+    static constexpr std::size_t nattributes = attributes.size();
+    ResampledSegmentBlueprint blueprint(1);
+
+    for (auto interpolation : { NEAREST, LINEAR }) {
+        std::unique_ptr< SurfaceBoundedSubVolume > subvolume(make_subvolume(
+            datahandle.get_metadata(), primary_surface, primary_surface, primary_surface
+        ));
+        cppapi::fetch_subvolume(datahandle, *subvolume, interpolation, 0, size);
+
+        std::vector<float> expected(size);
+        void* expected_dst[] = { expected.data() };
+        cppapi::attributes(
+            *subvolume, &blueprint, attributes.data(), 1, 0, size, expected_dst
+        );
+
+        std::unique_ptr< SurfaceBoundedSubVolume > tiled(make_tiled_subvolume(
+            datahandle.get_metadata(), primary_surface, primary_surface, primary_surface
+        ));
+
+        std::vector<float> result(size);
+        cppapi::horizon_values(datahandle, *tiled, interpolation, &blueprint, 3, size, result.data());
+        cppapi::horizon_values(datahandle, *tiled, interpolation, &blueprint, 0, 3, result.data());
+        EXPECT_EQ(result, expected);
+        EXPECT_EQ(result[6], fill);
+
+        std::vector<float> parallel_result(size * nattributes);
+        void* parallel_dst[] = {
+            parallel_result.data(),
+            parallel_result.data() + size
+        };
+        cppapi::parallel_attributes(
+            datahandle,
+            *tiled,
+            interpolation,
+            &blueprint,
+            attributes.data(),
+            nattributes,
+            0,
+            size,
+            parallel_dst
+        );
+        for (std::size_t i = 0; i < nattributes; ++i) {
+            EXPECT_EQ(
+                std::vector<float>(
+                    parallel_result.begin() + i * size,
+                    parallel_result.begin() + (i + 1) * size
+                ),
+                result
+            );
+        }
+    }
+}
+
+TEST_F(SubvolumeTest, HorizonValuesMatchAttributesOfWindows)
+{
+    static constexpr int nrows = 3;
+    static constexpr int ncols = 2;
+    static constexpr std::size_t size = nrows * ncols;
+
+    /*
+     * References around the jumps at the ends of the traces, and the kink of
+     * the last traces, where the spline of a window differs from that of the
+     * samples closest to the reference. One reference is on a sample.
+     */
+    std::array<float, size> surface_data = {
+        12.3, 32,
+        9.7,  35.4,
+        26.2, 29.5
+    };
+
+    RegularSurface primary_surface =
+        RegularSurface(surface_data.data(), nrows, ncols, samples_10_grid, fill);
+
+    std::array<attribute, 3> attributes = { VALUE, MEAN, MAX };
+    static constexpr std::size_t nattributes = attributes.size();
+
+    for (float stepsize : { 4.0f, 1.0f, 0.7f }) {
+        for (auto window : { std::make_pair(0.0f, 0.0f), std::make_pair(2.5f, 2.0f), std::make_pair(7.0f, 5.5f) }) {
+            ResampledSegmentBlueprint blueprint(stepsize);
+
+            std::unique_ptr< SurfaceBoundedSubVolume > subvolume(make_subvolume(
+                datahandle.get_metadata(), primary_surface, window.first, window.second
+            ));
+            cppapi::fetch_subvolume(datahandle, *subvolume, LINEAR, 0, size);
+
+            std::vector<float> expected(size * nattributes);
+            void* expected_dst[] = {
+                expected.data(),
+                expected.data() + size,
+                expected.data() + 2 * size
+            };
+            cppapi::attributes(
+                *subvolume, &blueprint, attributes.data(), nattributes, 0, size, expected_dst
+            );
+
+            std::vector<float> result(size);
+            cppapi::horizon_values(
+                datahandle, *subvolume, LINEAR, &blueprint, 0, size, result.data()
+            );
+            EXPECT_EQ(result, std::vector<float>(expected.begin(), expected.begin() + size))
+                << "with stepsize " << stepsize << " and window "
+                << window.first << ", " << window.second;
+        }
+    }
+}
+
+TEST_F(SubvolumeTest, ConstantWindowMatchesSurfaces)
+{
+    static constexpr int nrows = 3;
+    static constexpr int ncols = 4;
+    static constexpr std::size_t size = nrows * ncols;
+    static constexpr float above = 6.5;
+    static constexpr float below = 9;
+
+    std::array<float, size> surface_data = {
+        20,   24,   21,   22.5,
+        12,   29,   fill, 16.4,
+        27.2, 28.3, 24,   14.9
+    };
+
+    std::array<float, size> above_data = surface_data;
+    std::array<float, size> below_data = surface_data;
+    for (std::size_t i = 0; i < size; ++i) {
+        if (surface_data[i] == fill) continue;
+        above_data[i] -= above;
+        below_data[i] += below;
+    }
+
+    RegularSurface primary_surface =
+        RegularSurface(surface_data.data(), nrows, ncols, other_grid, fill);
+    RegularSurface top_surface =
+        RegularSurface(above_data.data(), nrows, ncols, other_grid, fill);
+    RegularSurface bottom_surface =
+        RegularSurface(below_data.data(), nrows, ncols, other_grid, fill);
+
+    std::unique_ptr< SurfaceBoundedSubVolume > expected(make_subvolume(
+        datahandle.get_metadata(), primary_surface, top_surface, bottom_surface
+    ));
+    cppapi::fetch_subvolume(datahandle, *expected, NEAREST, 0, size);
+    EXPECT_EQ(expected->stride(), 0);
+
+    std::unique_ptr< SurfaceBoundedSubVolume > subvolume(make_subvolume(
+        datahandle.get_metadata(), primary_surface, above, below
+    ));
+    cppapi::fetch_subvolume(datahandle, *subvolume, NEAREST, 0, size);
+
+    /* The window spans 3 or 4 samples, plus 2 margin samples at either end */
+    std::size_t const stride = subvolume->stride();
+    ASSERT_EQ(stride, 8);
+    EXPECT_EQ(subvolume->nsamples(0, size), size * stride);
+    EXPECT_EQ(subvolume->nsamples(3, 5), 2 * stride);
+
+    /*
+     * Segments are stored extended, so that they all have the same size, but
+     * are the same as the packed ones
+     */
+    for (std::size_t i = 0; i < size; ++i) {
+        ASSERT_EQ(subvolume->is_empty(i), expected->is_empty(i)) << "at " << i;
+        if (expected->is_empty(i)) continue;
+
+        auto const stored = subvolume->stored_segment(i);
+        ASSERT_EQ(stored.size(), stride) << "at " << i;
+        EXPECT_EQ(&*stored.begin(), subvolume->data(0) + i * stride) << "at " << i;
+
+        auto const segment = subvolume->vertical_segment(i);
+        auto const expected_segment = expected->vertical_segment(i);
+        ASSERT_EQ(segment.size(), expected_segment.size()) << "at " << i;
+        EXPECT_EQ(
+            segment.top_sample_position(),
+            expected_segment.top_sample_position()
+        ) << "at " << i;
+        ASSERT_GE(segment.begin(), stored.begin()) << "at " << i;
+        ASSERT_LE(segment.end(), stored.end()) << "at " << i;
+        EXPECT_TRUE(std::equal(
+            expected_segment.begin(), expected_segment.end(), segment.begin()
+        )) << "at " << i;
+    }
+
+    std::array<attribute, 4> attributes = { VALUE, MIN, MEAN, RMS };
+    static constexpr std::size_t nattributes = attributes.size();
+    ResampledSegmentBlueprint blueprint(1);
+
+    std::vector<float> expected_attributes(size * nattributes);
+    std::vector<float> result(size * nattributes);
+    std::array<void*, nattributes> expected_dst;
+    std::array<void*, nattributes> dst;
+    for (std::size_t i = 0; i < nattributes; ++i) {
+        expected_dst[i] = expected_attributes.data() + i * size;
+        dst[i] = result.data() + i * size;
+    }
+    cppapi::attributes(
+        *expected, &blueprint, attributes.data(), nattributes, 0, size, expected_dst.data()
+    );
+    cppapi::attributes(
+        *subvolume, &blueprint, attributes.data(), nattributes, 0, size, dst.data()
+    );
+    EXPECT_EQ(result, expected_attributes);
+
+    /* Tiles of a subvolume with a stride */
+    std::unique_ptr< SurfaceBoundedSubVolume > tiled(make_tiled_subvolume(
+        datahandle.get_metadata(), primary_surface, above, below
+    ));
+    EXPECT_EQ(tiled->partition(1, 11, 4), std::vector<std::size_t>({ 1, 3, 6, 8, 11 }));
+
+    cppapi::configure_attribute_memory(3 * stride * sizeof(float));
+    std::vector<float> tiled_result(size * nattributes);
+    for (std::size_t i = 0; i < nattributes; ++i) {
+        dst[i] = tiled_result.data() + i * size;
+    }
+    cppapi::parallel_attributes(
+        datahandle,
+        *tiled,
+        NEAREST,
+        &blueprint,
+        attributes.data(),
+        nattributes,
+        0,
+        size,
+        dst.data()
+    );
+    cppapi::configure_attribute_memory(0);
+    EXPECT_EQ(tiled_result, result);
+}
+
+TEST_F(SubvolumeTest, ConstantWindowMatchesSurfacesOnNonLinearData)
+{
+    static constexpr int nrows = 3;
+    static constexpr int ncols = 2;
+    static constexpr std::size_t size = nrows * ncols;
+    static constexpr float above = 2.5;
+    static constexpr float below = 2;
+
+    /*
+     * Windows next to the jumps at the ends of the traces, and across the
+     * kink of the last traces, where samples beyond the margins change the
+     * spline
+     */
+    std::array<float, size> surface_data = {
+        12.3, 33.1,
+        9.7,  35.4,
+        26.2, 29.5
+    };
+
+    std::array<float, size> above_data = surface_data;
+    std::array<float, size> below_data = surface_data;
+    for (std::size_t i = 0; i < size; ++i) {
+        above_data[i] -= above;
+        below_data[i] += below;
+    }
+
+    RegularSurface primary_surface =
+        RegularSurface(surface_data.data(), nrows, ncols, samples_10_grid, fill);
+    RegularSurface top_surface =
+        RegularSurface(above_data.data(), nrows, ncols, samples_10_grid, fill);
+    RegularSurface bottom_surface =
+        RegularSurface(below_data.data(), nrows, ncols, samples_10_grid, fill);
+
+    std::unique_ptr< SurfaceBoundedSubVolume > expected(make_subvolume(
+        datahandle.get_metadata(), primary_surface, top_surface, bottom_surface
+    ));
+    cppapi::fetch_subvolume(datahandle, *expected, LINEAR, 0, size);
+
+    std::unique_ptr< SurfaceBoundedSubVolume > subvolume(make_subvolume(
+        datahandle.get_metadata(), primary_surface, above, below
+    ));
+    cppapi::fetch_subvolume(datahandle, *subvolume, LINEAR, 0, size);
+    ASSERT_NE(subvolume->stride(), 0);
+
+    /* Some segments are shorter than the stride */
+    std::size_t nshorter = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        auto const segment = subvolume->vertical_segment(i);
+        ASSERT_EQ(segment.size(), expected->vertical_segment(i).size()) << "at " << i;
+        if (segment.size() < subvolume->stride()) ++nshorter;
+    }
+    EXPECT_GT(nshorter, 0);
+
+    std::array<attribute, 6> attributes = { VALUE, MIN, MAX, MEAN, RMS, SD };
+    static constexpr std::size_t nattributes = attributes.size();
+    ResampledSegmentBlueprint blueprint(0.5);
+
+    std::vector<float> expected_attributes(size * nattributes);
+    std::vector<float> result(size * nattributes);
+    std::array<void*, nattributes> expected_dst;
+    std::array<void*, nattributes> dst;
+    for (std::size_t i = 0; i < nattributes; ++i) {
+        expected_dst[i] = expected_attributes.data() + i * size;
+        dst[i] = result.data() + i * size;
+    }
+    cppapi::attributes(
+        *expected, &blueprint, attributes.data(), nattributes, 0, size, expected_dst.data()
+    );
+    cppapi::attributes(
+        *subvolume, &blueprint, attributes.data(), nattributes, 0, size, dst.data()
+    );
+    EXPECT_EQ(result, expected_attributes);
+}
+
+TEST_F(SubvolumeTest, SpansCoverNonEmptySegments)
+{
+    static constexpr int nrows = 4;
+    static constexpr int ncols = 5;
+    static constexpr std::size_t size = nrows * ncols;
+
+    /* Holes in the surface, and positions outside the survey */
+    std::array<float, size> surface_data = {
+        fill, 20,   20,   fill, 24,
+        20,   fill, fill, 24,   20,
+        24,   24,   20,   20,   fill,
+        fill, fill, 24,   20,   24
+    };
+
+    RegularSurface primary_surface =
+        RegularSurface(surface_data.data(), nrows, ncols, larger_grid, fill);
+
+    std::unique_ptr< SurfaceBoundedSubVolume > packed(make_tiled_subvolume(
+        datahandle.get_metadata(), primary_surface, primary_surface, primary_surface
+    ));
+    std::unique_ptr< SurfaceBoundedSubVolume > strided(make_tiled_subvolume(
+        datahandle.get_metadata(), primary_surface, 4, 8
+    ));
+    ASSERT_EQ(packed->stride(), 0);
+    ASSERT_NE(strided->stride(), 0);
+
+    for (auto const* subvolume : { packed.get(), strided.get() }) {
+        for (std::size_t from = 0; from <= size; ++from) {
+            for (std::size_t to = from; to <= size; ++to) {
+                std::vector<bool> covered(size, false);
+                std::size_t previous = 0;
+                for (auto const& span : subvolume->spans(from, to)) {
+                    ASSERT_LE(from, span.first);
+                    ASSERT_LT(span.first, span.last);
+                    ASSERT_LE(span.last, to);
+                    /* Spans are ordered, and separated by empty segments */
+                    ASSERT_TRUE(previous == 0 or previous < span.first);
+                    previous = span.last;
+
+                    std::fill(covered.begin() + span.first, covered.begin() + span.last, true);
+                }
+
+                for (std::size_t i = 0; i < size; ++i) {
+                    bool const expected = from <= i and i < to and not subvolume->is_empty(i);
+                    EXPECT_EQ(covered[i], expected)
+                        << "at " << i << " in [" << from << ", " << to << ")";
+                }
+            }
+        }
+    }
+}
+
+TEST_F(SubvolumeTest, PartitionBalancesSamples)
+{
+    static constexpr int nrows = 2;
+    static constexpr int ncols = 4;
+    static constexpr std::size_t size = nrows * ncols;
+
+    /* Segments of very different lengths, and empty segments */
+    std::array<float, size> surface_data = { 20, 20, 20, 20, 20, fill, 20, 20 };
+    std::array<float, size> top_data     = { 20, 4,  20, 20, 20, 20,   20, 8  };
+    std::array<float, size> bottom_data  = { 20, 36, 20, 20, 20, 20,   20, 20 };
+    RegularSurface primary_surface =
+        RegularSurface(surface_data.data(), nrows, ncols, samples_10_grid, fill);
+    RegularSurface top_surface =
+        RegularSurface(top_data.data(), nrows, ncols, samples_10_grid, fill);
+    RegularSurface bottom_surface =
+        RegularSurface(bottom_data.data(), nrows, ncols, samples_10_grid, fill);
+
+    std::unique_ptr< SurfaceBoundedSubVolume > subvolume(make_tiled_subvolume(
+        datahandle.get_metadata(), primary_surface, top_surface, bottom_surface
+    ));
+
+    std::size_t longest = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        longest = std::max(longest, subvolume->nsamples(i, i + 1));
+    }
+
+    for (std::size_t nparts : { 1, 2, 3, 100 }) {
+        auto const boundaries = subvolume->partition(1, size, nparts);
+        ASSERT_GE(boundaries.size(), 2);
+        EXPECT_LE(boundaries.size() - 1, nparts);
+        EXPECT_EQ(boundaries.front(), 1);
+        EXPECT_EQ(boundaries.back(), size);
+        EXPECT_TRUE(std::is_sorted(boundaries.begin(), boundaries.end()));
+        EXPECT_EQ(
+            std::adjacent_find(boundaries.begin(), boundaries.end()),
+            boundaries.end()
+        );
+
+        /* Parts are at most one segment larger than an even share */
+        std::size_t const share = subvolume->nsamples(1, size) / nparts;
+        for (std::size_t i = 0; i + 1 < boundaries.size(); ++i) {
+            EXPECT_LE(
+                subvolume->nsamples(boundaries[i], boundaries[i + 1]),
+                share + longest
+            ) << "part " << i << " of " << nparts;
+        }
+    }
+
+    EXPECT_THAT(subvolume->partition(3, 3, 4), ::testing::ElementsAre(3));
+}
+
+TEST_F(SubvolumeTest, TileOutOfSubvolume)
+{
+    static constexpr int nrows = 2;
+    static constexpr int ncols = 2;
+    static constexpr std::size_t size = nrows * ncols;
+
+    std::array<float, size> surface_data = { 20, 20, 20, 20 };
+    RegularSurface surface =
+        RegularSurface(surface_data.data(), nrows, ncols, samples_10_grid, fill);
+
+    std::unique_ptr< SurfaceBoundedSubVolume > subvolume(make_tiled_subvolume(
+        datahandle.get_metadata(), surface, surface, surface
+    ));
+
+    EXPECT_NO_THROW(subvolume->tile(0, size));
+    EXPECT_NO_THROW(subvolume->tile(size, size));
+    EXPECT_THROW(subvolume->tile(1, size + 1), std::invalid_argument);
+    EXPECT_THROW(subvolume->tile(2, 1), std::invalid_argument);
+}
+
 class SurfaceAlignmentTest : public ::testing::Test {
 protected:
     SurfaceAlignmentTest() : datahandle(make_single_datahandle(SAMPLES_10.c_str(), CREDENTIALS.c_str())) {}
@@ -814,7 +1424,9 @@ TEST_F(FenceFunctionTest, RequestingFenceData) {
         coordinates.data(),
         coordinate_size,
         interpolation,
+        nullptr,
         &fill,
+        nullptr,
         &response_data
     );
 
@@ -826,6 +1438,195 @@ TEST_F(FenceFunctionTest, RequestingFenceData) {
     EXPECT_EQ(nr_of_values, expected.size());
 }
 
+TEST_F(FenceFunctionTest, RequestingFenceDataSorted) {
+    /* Out of order, with repeated points and a point outside the cube */
+    const std::vector<float> fence{
+        2, 1,   0, 0,   1, 1,   2, 0,   0, 1,   5, 5,   1, 0,   2, 1,   0, 0
+    };
+    const std::size_t npoints = fence.size() / 2;
+
+    auto read = [&](DataHandle& handle) {
+        struct response response_data;
+        cppapi::fence(
+            handle,
+            c_system,
+            fence.data(),
+            npoints,
+            interpolation,
+            nullptr,
+            &fill,
+            nullptr,
+            &response_data
+        );
+        std::vector<float> values(
+            (float*)response_data.data,
+            (float*)(response_data.data + response_data.size)
+        );
+        delete[] response_data.data;
+        return values;
+    };
+
+    for (DataHandle* handle : std::vector< DataHandle* >{ &datahandle, &double_datahandle }) {
+        cppapi::configure_fence_sorting(0);
+        auto const expected_values = read(*handle);
+
+        cppapi::configure_fence_sorting(1);
+        auto const sorted_values = read(*handle);
+        cppapi::configure_fence_sorting(0);
+
+        EXPECT_EQ(sorted_values.size(), npoints * 10);
+        EXPECT_EQ(sorted_values, expected_values);
+    }
+}
+
+std::vector<float> read_fence(
+    DataHandle& handle,
+    std::vector<float> const& points,
+    enum interpolation_method interpolation,
+    Bound const* sample_window = nullptr,
+    float const* fill = nullptr
+) {
+    struct response response_data;
+    cppapi::fence(
+        handle,
+        coordinate_system::INDEX,
+        points.data(),
+        points.size() / 2,
+        interpolation,
+        sample_window,
+        fill,
+        nullptr,
+        &response_data
+    );
+    std::vector<float> values(
+        (float*)response_data.data,
+        (float*)(response_data.data + response_data.size)
+    );
+    delete[] response_data.data;
+    return values;
+}
+
+TEST_F(FenceFunctionTest, RequestingFenceDataDuplicatePoints) {
+    /* The first, second and last point are within the same voxel */
+    const std::vector<float> fence{ 1, 1,   1.2, 0.9,   2, 1,   0, 0,   1, 1 };
+
+    for (DataHandle* handle : std::vector< DataHandle* >{ &datahandle, &double_datahandle }) {
+        auto const values = read_fence(*handle, fence, NEAREST);
+        ASSERT_EQ(values.size(), 5 * 10);
+
+        for (std::size_t i = 0; i < 5; ++i) {
+            auto const expected_trace = read_fence(
+                *handle,
+                { fence[2 * i], fence[2 * i + 1] },
+                NEAREST
+            );
+            std::vector<float> const trace(
+                values.begin() + i * 10,
+                values.begin() + (i + 1) * 10
+            );
+            EXPECT_EQ(trace, expected_trace) << "Unexpected trace " << i;
+        }
+    }
+}
+
+TEST_F(FenceFunctionTest, RequestingFenceDataEpsilon) {
+    const std::vector<float> fence{ 1, 1,   1.05, 1 };
+
+    cppapi::configure_fence_deduplication(0.5);
+    auto const values = read_fence(datahandle, fence, LINEAR);
+    cppapi::configure_fence_deduplication(0);
+
+    ASSERT_EQ(values.size(), 2 * 10);
+    EXPECT_TRUE(std::equal(values.begin(), values.begin() + 10, values.begin() + 10));
+
+    auto const expected_values = read_fence(datahandle, { 1, 1 }, LINEAR);
+    EXPECT_TRUE(std::equal(values.begin(), values.begin() + 10, expected_values.begin()));
+
+    EXPECT_THROW(cppapi::configure_fence_deduplication(-1), std::invalid_argument);
+}
+
+TEST_F(FenceFunctionTest, RequestingFenceDataSampleWindow) {
+    /* The last point is outside the cube */
+    const std::vector<float> fence{ 1, 1,   2, 1,   0, 0,   5, 5 };
+    const std::size_t npoints = fence.size() / 2;
+    const Bound window{ 2, 5, axis_name::K };
+
+    for (DataHandle* handle : std::vector< DataHandle* >{ &datahandle, &double_datahandle }) {
+        for (auto method : { NEAREST, LINEAR }) {
+            auto const traces = read_fence(*handle, fence, method, nullptr, &fill);
+            auto const values = read_fence(*handle, fence, method, &window, &fill);
+            ASSERT_EQ(values.size(), npoints * 4);
+
+            for (std::size_t i = 0; i < npoints; ++i) {
+                std::vector<float> const expected_window(
+                    traces.begin() + i * 10 + 2,
+                    traces.begin() + i * 10 + 6
+                );
+                std::vector<float> const sample_window(
+                    values.begin() + i * 4,
+                    values.begin() + (i + 1) * 4
+                );
+                EXPECT_EQ(sample_window, expected_window)
+                    << "Unexpected window " << i << ", interpolation " << method;
+            }
+        }
+    }
+}
+
+TEST_F(FenceFunctionTest, RequestingFenceDataWideSampleWindow) {
+    /* Windows covering most of the trace are cropped from whole traces */
+    const std::vector<float> fence{ 1, 1,   2, 1,   0, 0,   5, 5 };
+    const std::size_t npoints = fence.size() / 2;
+    const Bound window{ 1, 8, axis_name::K };
+
+    for (DataHandle* handle : std::vector< DataHandle* >{ &datahandle, &double_datahandle }) {
+        for (auto method : { NEAREST, LINEAR }) {
+            auto const traces = read_fence(*handle, fence, method, nullptr, &fill);
+            auto const values = read_fence(*handle, fence, method, &window, &fill);
+            ASSERT_EQ(values.size(), npoints * 8);
+
+            for (std::size_t i = 0; i < npoints; ++i) {
+                std::vector<float> const expected_window(
+                    traces.begin() + i * 10 + 1,
+                    traces.begin() + i * 10 + 9
+                );
+                std::vector<float> const sample_window(
+                    values.begin() + i * 8,
+                    values.begin() + (i + 1) * 8
+                );
+                EXPECT_EQ(sample_window, expected_window)
+                    << "Unexpected window " << i << ", interpolation " << method;
+            }
+        }
+    }
+}
+
+TEST_F(FenceFunctionTest, RequestingFenceDataSingleSampleWindow) {
+    const Bound window{ 9, 9, axis_name::K };
+    auto const values = read_fence(datahandle, coordinates, NEAREST, &window);
+    EXPECT_EQ(values, std::vector<float>({ expected[9], expected[19] }));
+}
+
+TEST_F(FenceFunctionTest, RequestingFenceDataInvalidSampleWindow) {
+    const Bound iline{ 0, 1, axis_name::I };
+    EXPECT_THAT(
+        [&]() { read_fence(datahandle, coordinates, NEAREST, &iline); },
+        testing::ThrowsMessage<std::runtime_error>(
+            testing::HasSubstr("Invalid sample window direction")));
+
+    const Bound reversed{ 5, 2, axis_name::K };
+    EXPECT_THAT(
+        [&]() { read_fence(datahandle, coordinates, NEAREST, &reversed); },
+        testing::ThrowsMessage<std::runtime_error>(
+            testing::HasSubstr("upper must be greater or equal to lower")));
+
+    const Bound outside{ 0, 10, axis_name::K };
+    EXPECT_THAT(
+        [&]() { read_fence(datahandle, coordinates, NEAREST, &outside); },
+        testing::ThrowsMessage<std::runtime_error>(
+            testing::HasSubstr("Invalid lineno: 10")));
+}
+
 TEST_F(FenceFunctionTest, RequestingFenceDataSubtract) {
 
     struct response response_data;
@@ -836,7 +1637,9 @@ TEST_F(FenceFunctionTest, RequestingFenceDataSubtract) {
         coordinates.data(),
         coordinate_size,
         interpolation,
+        nullptr,
         &fill,
+        nullptr,
         &response_data
     );
 
@@ -879,6 +1682,8 @@ TEST_F(SliceFunctionTest, RequestingSliceData) {
         direction,
         lineno,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -900,6 +1705,8 @@ TEST_F(SliceFunctionTest, RequestingSliceDataSubtraction) {
         direction,
         lineno,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -911,4 +1718,211 @@ TEST_F(SliceFunctionTest, RequestingSliceDataSubtraction) {
     EXPECT_EQ(nr_of_values, expected.size());
 }
 
+TEST_F(SliceFunctionTest, RequestingSliceDataInt16) {
+    const Direction direction(axis_name::K);
+    slice_bounds.push_back(Bound{0, 2, axis_name::I});
+    struct response response_data;
+    SampleEncoding encoding{ INT16, 0, 0 };
+
+    cppapi::slice(
+        datahandle,
+        direction,
+        lineno,
+        slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        &encoding,
+        &response_data
+    );
+
+    EXPECT_FLOAT_EQ(encoding.offset, (16.5 + -16.5) / 2);
+    EXPECT_FLOAT_EQ(encoding.scale, 33.0 / (2 * 32767));
+
+    std::size_t nr_of_values = (std::size_t)(response_data.size / sizeof(std::int16_t));
+    for (int i = 0; i < nr_of_values; ++i) {
+        float value = encoding.offset + encoding.scale * *(std::int16_t*)&response_data.data[i * sizeof(std::int16_t)];
+        EXPECT_NEAR(value, expected[i], encoding.scale) << "Unexpected value at index " << i;
+    }
+
+    EXPECT_EQ(nr_of_values, expected.size());
+}
+
+std::vector< char > to_vector(response& response_data) {
+    std::vector< char > data(
+        response_data.data,
+        response_data.data + response_data.size
+    );
+    delete[] response_data.data;
+    return data;
+}
+
+TEST_F(SliceFunctionTest, RequestingSliceBatch) {
+    slice_bounds.push_back(Bound{0, 2, axis_name::I});
+    const std::vector< SliceLine > slices{
+        { axis_name::K, 4 },
+        { axis_name::K, 2 },
+        { axis_name::I, 1 },
+        { axis_name::K, 7 },
+        { axis_name::J, 0 },
+        { axis_name::K, 4 },
+    };
+
+    for (DataHandle* handle : std::vector< DataHandle* >{ &datahandle, &double_datahandle }) {
+        struct response response_data;
+        std::vector< std::size_t > offsets(slices.size() + 1);
+
+        cppapi::slice_batch(
+            *handle,
+            slices,
+            slice_bounds,
+            LevelOfDetail{ 0, 0 },
+            nullptr,
+            offsets.data(),
+            &response_data
+        );
+        auto const batch = to_vector(response_data);
+        EXPECT_EQ(offsets.back(), batch.size());
+
+        for (std::size_t i = 0; i < slices.size(); ++i) {
+            struct response expected_data;
+            cppapi::slice(
+                *handle,
+                Direction(slices[i].direction),
+                slices[i].lineno,
+                slice_bounds,
+                LevelOfDetail{ 0, 0 },
+                nullptr,
+                &expected_data
+            );
+            auto const expected_slice = to_vector(expected_data);
+
+            std::vector< char > const slice(
+                batch.begin() + offsets[i],
+                batch.begin() + offsets[i + 1]
+            );
+            EXPECT_EQ(slice, expected_slice) << "Unexpected slice " << i;
+        }
+    }
+}
+
+TEST_F(SliceFunctionTest, RequestingSparseSliceBatch) {
+    /* 0 and 1 share a slab, 7 is too far from them and is read on its own */
+    const std::vector< SliceLine > slices{
+        { axis_name::K, 7 },
+        { axis_name::K, 0 },
+        { axis_name::K, 1 },
+    };
+
+    struct response response_data;
+    std::vector< std::size_t > offsets(slices.size() + 1);
+    cppapi::slice_batch(
+        datahandle,
+        slices,
+        slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
+        offsets.data(),
+        &response_data
+    );
+    auto const batch = to_vector(response_data);
+
+    for (std::size_t i = 0; i < slices.size(); ++i) {
+        struct response expected_data;
+        cppapi::slice(
+            datahandle,
+            Direction(slices[i].direction),
+            slices[i].lineno,
+            slice_bounds,
+            LevelOfDetail{ 0, 0 },
+            nullptr,
+            &expected_data
+        );
+        auto const expected_slice = to_vector(expected_data);
+
+        std::vector< char > const slice(
+            batch.begin() + offsets[i],
+            batch.begin() + offsets[i + 1]
+        );
+        EXPECT_EQ(slice, expected_slice) << "Unexpected slice " << i;
+    }
+}
+
+TEST_F(SliceFunctionTest, RequestingSliceBatchInt16) {
+    const std::vector< SliceLine > slices{
+        { axis_name::K, 4 },
+        { axis_name::K, 5 },
+    };
+    std::vector< SampleEncoding > encodings{ { INT16, 0, 0 }, { INT16, 0, 0 } };
+
+    struct response response_data;
+    std::vector< std::size_t > offsets(slices.size() + 1);
+    cppapi::slice_batch(
+        datahandle,
+        slices,
+        slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        encodings.data(),
+        offsets.data(),
+        &response_data
+    );
+    auto const batch = to_vector(response_data);
+
+    for (std::size_t i = 0; i < slices.size(); ++i) {
+        struct response expected_data;
+        SampleEncoding encoding{ INT16, 0, 0 };
+        cppapi::slice(
+            datahandle,
+            Direction(slices[i].direction),
+            slices[i].lineno,
+            slice_bounds,
+            LevelOfDetail{ 0, 0 },
+            &encoding,
+            &expected_data
+        );
+        auto const expected_slice = to_vector(expected_data);
+
+        std::vector< char > const slice(
+            batch.begin() + offsets[i],
+            batch.begin() + offsets[i + 1]
+        );
+        EXPECT_EQ(slice, expected_slice) << "Unexpected slice " << i;
+        EXPECT_EQ(encodings[i].scale,  encoding.scale);
+        EXPECT_EQ(encodings[i].offset, encoding.offset);
+    }
+}
+
+float from_half(std::uint16_t half) {
+    int const exponent = (half >> 10) & 0x1F;
+    int const mantissa = half & 0x3FF;
+    float const value = exponent == 0
+        ? std::ldexp(float(mantissa), -24)
+        : std::ldexp(float(mantissa + 1024), exponent - 25);
+    return (half & 0x8000) ? -value : value;
+}
+
+TEST_F(FenceFunctionTest, RequestingFenceDataFloat16) {
+    struct response response_data;
+    SampleEncoding encoding{ FLOAT16, 0, 0 };
+
+    cppapi::fence(
+        datahandle,
+        c_system,
+        coordinates.data(),
+        coordinate_size,
+        interpolation,
+        nullptr,
+        &fill,
+        &encoding,
+        &response_data
+    );
+
+    /* All expected values are exactly representable as half floats */
+    std::size_t nr_of_values = (std::size_t)(response_data.size / sizeof(std::uint16_t));
+    for (int i = 0; i < nr_of_values; ++i) {
+        std::uint16_t half = *(std::uint16_t*)&response_data.data[i * sizeof(std::uint16_t)];
+        EXPECT_EQ(from_half(half), expected[i]) << "Unexpected value at index " << i;
+    }
+
+    EXPECT_EQ(nr_of_values, expected.size());
+}
+
 } // namespace
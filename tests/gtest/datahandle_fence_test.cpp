@@ -22,6 +22,8 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_INDEX_Single) {
         int(coordinates.size() / 2),
         NEAREST,
         nullptr,
+        nullptr,
+        nullptr,
         &response_data
     );
 
@@ -43,6 +45,8 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_INDEX_Double) {
         int(coordinates.size() / 2),
         NEAREST,
         nullptr,
+        nullptr,
+        nullptr,
         &response_data
     );
 
@@ -51,6 +55,40 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_INDEX_Double) {
     check_fence(response_data, check_coordinates, low, high, 2, false);
 }
 
+TEST_F(DatahandleCubeIntersectionTest, Fence_INDEX_Repeated_Double) {
+    /* Later fences reuse the scratch buffers of earlier ones */
+    const std::vector<std::vector<float>> fences{
+        {0, 0, 1, 1, 2, 2, 3, 3},
+        {3, 3},
+        {1, 1, 2, 2, 3, 3},
+    };
+    const std::vector<std::vector<float>> check_coordinates{
+        {15, 10, 18, 12, 21, 14, 24, 16},
+        {24, 16},
+        {18, 12, 21, 14, 24, 16},
+    };
+
+    for (std::size_t i = 0; i < fences.size(); ++i) {
+        struct response response_data;
+        cppapi::fence(
+            double_datahandle,
+            coordinate_system::INDEX,
+            fences[i].data(),
+            int(fences[i].size() / 2),
+            NEAREST,
+            nullptr,
+            nullptr,
+            nullptr,
+            &response_data
+        );
+
+        int low = 20;
+        int high = 128;
+        check_fence(response_data, check_coordinates[i], low, high, 2, false);
+        delete[] response_data.data;
+    }
+}
+
 TEST_F(DatahandleCubeIntersectionTest, Fence_INDEX_Fill_Single) {
 
     struct response response_data;
@@ -63,7 +101,9 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_INDEX_Fill_Single) {
         coordinates.data(),
         int(coordinates.size() / 2),
         NEAREST,
+        nullptr,
         &fill,
+        nullptr,
         &response_data
     );
 
@@ -84,7 +124,9 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_INDEX_Fill_Double) {
         coordinates.data(),
         int(coordinates.size() / 2),
         NEAREST,
+        nullptr,
         &fill,
+        nullptr,
         &response_data
     );
 
@@ -106,6 +148,8 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_INDEX_out_Of_Bounds_Single) {
             int(coordinates.size() / 2),
             NEAREST,
             nullptr,
+            nullptr,
+            nullptr,
             &response_data
         );
     },
@@ -125,6 +169,8 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_INDEX_out_Of_Bounds_Double) {
             int(coordinates.size() / 2),
             NEAREST,
             nullptr,
+            nullptr,
+            nullptr,
             &response_data
         );
     },
@@ -146,6 +192,8 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_ANNOTATION_Single) {
         int(coordinates.size() / 2),
         NEAREST,
         nullptr,
+        nullptr,
+        nullptr,
         &response_data
     );
 
@@ -167,6 +215,8 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_ANNOTATION_Double) {
         int(coordinates.size() / 2),
         NEAREST,
         nullptr,
+        nullptr,
+        nullptr,
         &response_data
     );
 
@@ -187,7 +237,9 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_ANNOTATION_Fill_Single) {
         coordinates.data(),
         int(coordinates.size() / 2),
         NEAREST,
+        nullptr,
         &fill,
+        nullptr,
         &response_data
     );
 
@@ -208,7 +260,9 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_ANNOTATION_Fill_Double) {
         coordinates.data(),
         int(coordinates.size() / 2),
         NEAREST,
+        nullptr,
         &fill,
+        nullptr,
         &response_data
     );
 
@@ -230,6 +284,8 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_ANNOTATION_out_Of_Bounds_Single) {
             int(coordinates.size() / 2),
             NEAREST,
             nullptr,
+            nullptr,
+            nullptr,
             &response_data
         );
     },
@@ -249,6 +305,8 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_ANNOTATION_out_Of_Bounds_Double) {
             int(coordinates.size() / 2),
             NEAREST,
             nullptr,
+            nullptr,
+            nullptr,
             &response_data
         );
     },
@@ -270,6 +328,8 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_CDP_Single) {
         int(coordinates.size() / 2),
         NEAREST,
         nullptr,
+        nullptr,
+        nullptr,
         &response_data
     );
 
@@ -291,6 +351,8 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_CDP_Double) {
         int(coordinates.size() / 2),
         NEAREST,
         nullptr,
+        nullptr,
+        nullptr,
         &response_data
     );
 
@@ -311,7 +373,9 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_CDP_Fill_Single) {
         coordinates.data(),
         int(coordinates.size() / 2),
         NEAREST,
+        nullptr,
         &fill,
+        nullptr,
         &response_data
     );
 
@@ -332,7 +396,9 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_CDP_Fill_Double) {
         coordinates.data(),
         int(coordinates.size() / 2),
         NEAREST,
+        nullptr,
         &fill,
+        nullptr,
         &response_data
     );
 
@@ -354,6 +420,8 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_CDP_out_Of_Bounds_Single) {
             int(coordinates.size() / 2),
             NEAREST,
             nullptr,
+            nullptr,
+            nullptr,
             &response_data
         );
     },
@@ -373,6 +441,8 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_CDP_out_Of_Bounds_Double) {
             int(coordinates.size() / 2),
             NEAREST,
             nullptr,
+            nullptr,
+            nullptr,
             &response_data
         );
     },
@@ -395,6 +465,8 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_INDEX_Reverse_Double) {
         int(coordinates.size() / 2),
         NEAREST,
         nullptr,
+        nullptr,
+        nullptr,
         &response_data
     );
 
@@ -416,6 +488,8 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_INDEX_Different_Size_Double) {
         int(coordinates.size() / 2),
         NEAREST,
         nullptr,
+        nullptr,
+        nullptr,
         &response_data
     );
 
@@ -450,6 +524,8 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_Different_Number_Of_Samples_To_Bord
         int(coordinates.size() / 2),
         NEAREST,
         nullptr,
+        nullptr,
+        nullptr,
         &response_data
     );
 
@@ -470,6 +546,8 @@ TEST_F(DatahandleCubeIntersectionTest, Fence_Different_Number_Of_Samples_To_Bord
         int(coordinates.size() / 2),
         NEAREST,
         nullptr,
+        nullptr,
+        nullptr,
         &response_data_reverse
     );
 
@@ -499,6 +577,8 @@ TEST_F(Datahandle10SamplesTest, Fence_Single_Negative) {
         int(coordinates.size() / 2),
         NEAREST,
         nullptr,
+        nullptr,
+        nullptr,
         &response_data
     );
 
@@ -114,6 +114,8 @@ TEST_F(DatahandleMetadataTest, Metadata_Single_Slice) {
         Direction(axis_name::I),
         2,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
     nlohmann::json metadata = nlohmann::json::parse(response_data.data, response_data.data + response_data.size);
@@ -125,6 +127,36 @@ TEST_F(DatahandleMetadataTest, Metadata_Single_Slice) {
     EXPECT_EQ(metadata["geospatial"], expected["geospatial"]);
 }
 
+TEST_F(DatahandleMetadataTest, Metadata_Single_Slice_Lineno) {
+    int const lod = std::min(single_datahandle.max_lod(), 1);
+    int const voxelline = (3 >> lod) << lod;
+    Axis const& inline_axis = single_datahandle.get_metadata().iline();
+    float const annotation = inline_axis.min() + inline_axis.stepsize() * 3;
+
+    auto lineno = [&](Direction const direction, int line) {
+        struct response response_data;
+        cppapi::slice_metadata(
+            single_datahandle,
+            direction,
+            line,
+            {},
+            LevelOfDetail{ lod, 0 },
+            nullptr,
+            &response_data
+        );
+        nlohmann::json metadata = nlohmann::json::parse(response_data.data, response_data.data + response_data.size);
+        delete[] response_data.data;
+        return metadata["lineno"].get< float >();
+    };
+
+    /* Lines off the level of detail grid report the line that is returned */
+    EXPECT_EQ(lineno(Direction(axis_name::I), 3), voxelline);
+    EXPECT_EQ(
+        lineno(Direction(axis_name::INLINE), annotation),
+        inline_axis.min() + inline_axis.stepsize() * voxelline
+    );
+}
+
 TEST_F(DatahandleMetadataTest, Metadata_Single_Fence) {
     nlohmann::json expected;
     expected["format"] = "<f4";
@@ -134,6 +166,8 @@ TEST_F(DatahandleMetadataTest, Metadata_Single_Fence) {
     cppapi::fence_metadata(
         single_datahandle,
         5,
+        nullptr,
+        nullptr,
         &response_data
     );
     nlohmann::json metadata = nlohmann::json::parse(response_data.data, response_data.data + response_data.size);
@@ -142,6 +176,52 @@ TEST_F(DatahandleMetadataTest, Metadata_Single_Fence) {
     EXPECT_EQ(metadata["shape"], expected["shape"]);
 }
 
+TEST_F(DatahandleMetadataTest, Metadata_Single_Fence_SampleWindow) {
+    const Bound window{ 4, 11, axis_name::K };
+
+    struct response response_data;
+    cppapi::fence_metadata(
+        single_datahandle,
+        5,
+        &window,
+        nullptr,
+        &response_data
+    );
+    nlohmann::json metadata = nlohmann::json::parse(response_data.data, response_data.data + response_data.size);
+
+    EXPECT_EQ(metadata["shape"], nlohmann::json::array({5, 8}));
+}
+
+TEST_F(DatahandleMetadataTest, Metadata_Single_Fence_Encoded) {
+    std::vector< std::pair< SampleEncoding, std::string > > encodings = {
+        { SampleEncoding{ FLOAT32, 1,    0    }, "<f4" },
+        { SampleEncoding{ FLOAT16, 1,    0    }, "<f2" },
+        { SampleEncoding{ INT16,   0.5f, 2.0f }, "<i2" },
+        { SampleEncoding{ INT8,    0.5f, 2.0f }, "|i1" },
+    };
+
+    for (auto const& encoding : encodings) {
+        struct response response_data;
+        cppapi::fence_metadata(
+            single_datahandle,
+            5,
+            nullptr,
+            &encoding.first,
+            &response_data
+        );
+        nlohmann::json metadata = nlohmann::json::parse(response_data.data, response_data.data + response_data.size);
+
+        EXPECT_EQ(metadata["format"], encoding.second);
+        if (encoding.first.format == INT16 or encoding.first.format == INT8) {
+            EXPECT_EQ(metadata["scale"], 0.5f);
+            EXPECT_EQ(metadata["offset"], 2.0f);
+        } else {
+            EXPECT_EQ(metadata.count("scale"), 0);
+            EXPECT_EQ(metadata.count("offset"), 0);
+        }
+    }
+}
+
 TEST_F(DatahandleMetadataTest, Metadata_Attribute) {
     int nrows = 7;
     int ncols = 6;
@@ -199,6 +279,8 @@ TEST_F(DatahandleMetadataTest, Metadata_Double_Slice) {
         Direction(axis_name::I),
         2,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
     nlohmann::json metadata = nlohmann::json::parse(response_data.data, response_data.data + response_data.size);
@@ -219,6 +301,8 @@ TEST_F(DatahandleMetadataTest, Metadata_Double_Fence) {
     cppapi::fence_metadata(
         double_datahandle,
         5,
+        nullptr,
+        nullptr,
         &response_data
     );
     nlohmann::json metadata = nlohmann::json::parse(response_data.data, response_data.data + response_data.size);
@@ -20,6 +20,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_I_Single) {
         Direction(axis_name::I),
         line_index,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -39,6 +41,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_I_Double) {
         Direction(axis_name::I),
         line_index,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -58,6 +62,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_J_Single) {
         Direction(axis_name::J),
         line_index,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -77,6 +83,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_J_Double) {
         Direction(axis_name::J),
         line_index,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -96,6 +104,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_K_Single) {
         Direction(axis_name::K),
         line_index,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -115,6 +125,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_K_Double) {
         Direction(axis_name::K),
         line_index,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -131,6 +143,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_INLINE_Single) {
         Direction(axis_name::INLINE),
         21,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -147,6 +161,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_INLINE_Double) {
         Direction(axis_name::INLINE),
         21,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -163,6 +179,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_CROSSLINE_Single) {
         Direction(axis_name::CROSSLINE),
         14,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -179,6 +197,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_CROSSLINE_Double) {
         Direction(axis_name::CROSSLINE),
         14,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -195,6 +215,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_SAMPLE_Single) {
         Direction(axis_name::SAMPLE),
         40,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -211,6 +233,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_SAMPLE_Double) {
         Direction(axis_name::SAMPLE),
         40,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -227,6 +251,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_TIME_Single) {
         Direction(axis_name::TIME),
         40,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -243,6 +269,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_TIME_Double) {
         Direction(axis_name::TIME),
         40,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -261,6 +289,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_DEPTH_Single) {
             Direction(axis_name::DEPTH),
             40,
             slice_bounds,
+            LevelOfDetail{ 0, 0 },
+            nullptr,
             &response_data
         );
     },
@@ -277,6 +307,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_DEPTH_Double) {
             Direction(axis_name::DEPTH),
             40,
             slice_bounds,
+            LevelOfDetail{ 0, 0 },
+            nullptr,
             &response_data
         );
     },
@@ -294,6 +326,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_TIME_Invalid_Single) {
             direction,
             0,
             slice_bounds,
+            LevelOfDetail{ 0, 0 },
+            nullptr,
             &response_data
         );
     },
@@ -305,6 +339,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_TIME_Invalid_Single) {
             direction,
             132,
             slice_bounds,
+            LevelOfDetail{ 0, 0 },
+            nullptr,
             &response_data
         );
     },
@@ -316,6 +352,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_TIME_Invalid_Single) {
             direction,
             21,
             slice_bounds,
+            LevelOfDetail{ 0, 0 },
+            nullptr,
             &response_data
         );
     },
@@ -333,6 +371,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_TIME_Invalid_Double) {
             direction,
             16,
             slice_bounds,
+            LevelOfDetail{ 0, 0 },
+            nullptr,
             &response_data
         );
     },
@@ -344,6 +384,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_TIME_Invalid_Double) {
             direction,
             132,
             slice_bounds,
+            LevelOfDetail{ 0, 0 },
+            nullptr,
             &response_data
         );
     },
@@ -355,6 +397,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_TIME_Invalid_Double) {
             direction,
             21,
             slice_bounds,
+            LevelOfDetail{ 0, 0 },
+            nullptr,
             &response_data
         );
     },
@@ -369,6 +413,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Axis_TIME_Reverse_Double) {
         Direction(axis_name::TIME),
         40,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -385,6 +431,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Different_Size_Double) {
         Direction(axis_name::INLINE),
         30,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -410,6 +458,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Different_Number_Of_Samples_To_Bord
         Direction(axis_name::CROSSLINE),
         14,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -434,6 +484,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Minimum_Single) {
         Direction(axis_name::TIME),
         8,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -465,6 +517,8 @@ TEST_F(DatahandleCubeIntersectionTest, Slice_Minimum_Double) {
         Direction(axis_name::TIME),
         124,
         slice_bounds,
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -501,6 +555,8 @@ TEST_F(Datahandle10SamplesTest, Slice_Single_Negative) {
         Direction(axis_name::CROSSLINE),
         -11,
         std::vector<Bound>{Bound{-16, 8, axis_name::TIME}},
+        LevelOfDetail{ 0, 0 },
+        nullptr,
         &response_data
     );
 
@@ -509,4 +565,142 @@ TEST_F(Datahandle10SamplesTest, Slice_Single_Negative) {
     check_slice(response_data, metadata.coordinate_transformer(), low, high);
 }
 
+class SubCubeSplitTest : public ::testing::Test {
+protected:
+    SubCubeSplitTest() : datahandle(make_single_datahandle(
+        "file://10_samples_default.vds",
+        ""
+    )) {}
+
+    SingleDataHandle datahandle;
+
+    SubCube make_subcube(std::vector<int> lower, std::vector<int> upper) {
+        SubCube subcube(datahandle.get_metadata());
+        for (std::size_t i = 0; i < lower.size(); ++i) {
+            subcube.bounds.lower[i] = lower[i];
+            subcube.bounds.upper[i] = upper[i];
+        }
+        return subcube;
+    }
+};
+
+TEST_F(SubCubeSplitTest, SplitsSlowestDimensionAtBrickBoundaries) {
+    SubCube subcube = make_subcube({0, 1, 5}, {10, 9, 6});
+
+    auto pieces = subcube.split(2, 3);
+
+    std::vector<int> expected_lower{1, 2, 6};
+    std::vector<int> expected_upper{2, 6, 9};
+    ASSERT_EQ(pieces.size(), 3);
+    for (std::size_t i = 0; i < pieces.size(); ++i) {
+        EXPECT_EQ(pieces[i].bounds.lower[1], expected_lower[i]);
+        EXPECT_EQ(pieces[i].bounds.upper[1], expected_upper[i]);
+
+        EXPECT_EQ(pieces[i].bounds.lower[0], 0);
+        EXPECT_EQ(pieces[i].bounds.upper[0], 10);
+        EXPECT_EQ(pieces[i].bounds.lower[2], 5);
+        EXPECT_EQ(pieces[i].bounds.upper[2], 6);
+    }
+}
+
+TEST_F(SubCubeSplitTest, PiecesCoverSubcubeBufferInOrder) {
+    SubCube subcube = make_subcube({0, 0, 0}, {10, 2, 3});
+
+    auto pieces = subcube.split(1, 8);
+
+    ASSERT_EQ(pieces.size(), 3);
+    std::int64_t total = 0;
+    for (std::size_t i = 0; i < pieces.size(); ++i) {
+        EXPECT_EQ(pieces[i].bounds.lower[2], i);
+        EXPECT_EQ(pieces[i].bounds.upper[2], i + 1);
+        total += datahandle.subcube_buffer_size(pieces[i]);
+    }
+    EXPECT_EQ(total, datahandle.subcube_buffer_size(subcube));
+}
+
+TEST_F(SubCubeSplitTest, NoSplitWithinSingleBrick) {
+    SubCube subcube = make_subcube({0, 0, 0}, {10, 2, 3});
+
+    EXPECT_EQ(subcube.split(64, 4).size(), 1);
+    EXPECT_EQ(subcube.split(1, 1).size(), 1);
+}
+
+class SubCubeLodTest : public SubCubeSplitTest {};
+
+TEST_F(SubCubeLodTest, SamplesOnDecimatedGrid) {
+    SubCube subcube = make_subcube({1, 3, 5}, {10, 4, 6});
+    subcube.lod = 2;
+
+    /* Voxels 0, 4 and 8 in the decimated grid cover [1, 10) */
+    EXPECT_EQ(subcube.nsamples(0), 3);
+    EXPECT_EQ(subcube.first(0), 0);
+    EXPECT_EQ(subcube.last(0), 8);
+
+    EXPECT_EQ(subcube.nsamples(1), 1);
+    EXPECT_EQ(subcube.first(1), 0);
+    EXPECT_EQ(subcube.last(1), 0);
+
+    EXPECT_EQ(subcube.nsamples(2), 1);
+    EXPECT_EQ(subcube.first(2), 4);
+    EXPECT_EQ(subcube.last(2), 4);
+}
+
+TEST_F(SubCubeLodTest, ExplicitLevel) {
+    SubCube subcube = make_subcube({0, 0, 0}, {10, 2, 3});
+
+    subcube.set_lod(LevelOfDetail{ 1, 0 }, 3);
+    EXPECT_EQ(subcube.lod, 1);
+    EXPECT_EQ(subcube.nsamples(0), 5);
+
+    EXPECT_THAT(
+        [&]() { subcube.set_lod(LevelOfDetail{ 4, 0 }, 3); },
+        testing::ThrowsMessage<std::runtime_error>(
+            testing::HasSubstr("Invalid level of detail: 4, valid range: [0:3]")
+        )
+    );
+}
+
+TEST_F(SubCubeLodTest, AutomaticLevel) {
+    SubCube subcube = make_subcube({0, 0, 0}, {10, 2, 3});
+
+    /* Longest side is 10 samples: 5 at lod 1, 3 at lod 2, 2 at lod 3 */
+    subcube.set_lod(LevelOfDetail{ -1, 3 }, 3);
+    EXPECT_EQ(subcube.lod, 2);
+
+    subcube.set_lod(LevelOfDetail{ -1, 1 }, 3);
+    EXPECT_EQ(subcube.lod, 3);
+
+    subcube.set_lod(LevelOfDetail{ -1, 20 }, 3);
+    EXPECT_EQ(subcube.lod, 0);
+
+    /* Never coarser than what the cube provides */
+    subcube.set_lod(LevelOfDetail{ -1, 1 }, 0);
+    EXPECT_EQ(subcube.lod, 0);
+}
+
+TEST_F(Datahandle10SamplesTest, Slice_Lod_Not_In_VDS) {
+    SingleDataHandle datahandle = make_single_datahandle(
+        "file://10_samples_default.vds",
+        CREDENTIALS.c_str()
+    );
+
+    struct response response_data;
+    EXPECT_THAT(
+        [&]() {
+            cppapi::slice(
+                datahandle,
+                Direction(axis_name::I),
+                0,
+                std::vector<Bound>{},
+                LevelOfDetail{ 1, 0 },
+                nullptr,
+                &response_data
+            );
+        },
+        testing::ThrowsMessage<std::runtime_error>(
+            testing::HasSubstr("Invalid level of detail: 1, valid range: [0:0]")
+        )
+    );
+}
+
 } // namespace
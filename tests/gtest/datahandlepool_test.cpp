@@ -0,0 +1,131 @@
+#include <chrono>
+#include <thread>
+
+#include "cppapi.hpp"
+#include "datahandlepool.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+const std::string SAMPLES_10 = "file://10_samples_default.vds";
+const std::string WELL_KNOWN = "file://well_known_default.vds";
+const std::string CREDENTIALS = "";
+
+class DataHandlePoolTest : public ::testing::Test {
+protected:
+    DataHandlePool& pool = DataHandlePool::instance();
+
+    void SetUp() override {
+        pool.configure(2, std::chrono::seconds(60));
+    }
+
+    void TearDown() override {
+        pool.configure(0, std::chrono::seconds(0));
+        pool.clear();
+    }
+
+    void expect_slice(SingleDataHandle& datahandle) {
+        struct response response_data;
+        cppapi::slice(
+            datahandle,
+            Direction(axis_name::I),
+            0,
+            std::vector< Bound >{},
+            LevelOfDetail{ 0, 0 },
+            nullptr,
+            &response_data
+        );
+        EXPECT_GT(response_data.size, 0);
+        delete[] response_data.data;
+    }
+};
+
+TEST_F(DataHandlePoolTest, ReusesOpenedHandle) {
+    SingleDataHandle first = pool.checkout(SAMPLES_10, CREDENTIALS);
+    SingleDataHandle second = pool.checkout(SAMPLES_10, CREDENTIALS);
+    EXPECT_EQ(pool.size(), 1);
+
+    expect_slice(first);
+    expect_slice(second);
+
+    first.close();
+    second.close();
+    EXPECT_EQ(pool.size(), 1);
+}
+
+TEST_F(DataHandlePoolTest, ReportsPooledHandles) {
+    bool pooled = true;
+    SingleDataHandle first = pool.checkout(SAMPLES_10, CREDENTIALS, &pooled);
+    EXPECT_FALSE(pooled);
+
+    SingleDataHandle second = pool.checkout(SAMPLES_10, CREDENTIALS, &pooled);
+    EXPECT_TRUE(pooled);
+
+    pool.configure(0, std::chrono::seconds(0));
+    SingleDataHandle unpooled = pool.checkout(SAMPLES_10, CREDENTIALS, &pooled);
+    EXPECT_FALSE(pooled);
+
+    first.close();
+    second.close();
+    unpooled.close();
+}
+
+TEST_F(DataHandlePoolTest, EvictsLeastRecentlyUsed) {
+    pool.configure(1, std::chrono::seconds(60));
+
+    SingleDataHandle first = pool.checkout(SAMPLES_10, CREDENTIALS);
+    first.close();
+
+    SingleDataHandle second = pool.checkout(WELL_KNOWN, CREDENTIALS);
+    EXPECT_EQ(pool.size(), 1);
+
+    expect_slice(second);
+    second.close();
+}
+
+TEST_F(DataHandlePoolTest, HandleOutlivesEviction) {
+    SingleDataHandle datahandle = pool.checkout(SAMPLES_10, CREDENTIALS);
+    pool.clear();
+    EXPECT_EQ(pool.size(), 0);
+
+    expect_slice(datahandle);
+    datahandle.close();
+}
+
+TEST_F(DataHandlePoolTest, EvictsIdleHandles) {
+    pool.configure(2, std::chrono::seconds(0));
+
+    SingleDataHandle idle = pool.checkout(SAMPLES_10, CREDENTIALS);
+    idle.close();
+    SingleDataHandle in_use = pool.checkout(WELL_KNOWN, CREDENTIALS);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pool.evict_expired();
+    EXPECT_EQ(pool.size(), 1);
+
+    in_use.close();
+    pool.evict_expired();
+    EXPECT_EQ(pool.size(), 0);
+}
+
+TEST_F(DataHandlePoolTest, DisabledPoolOpensNewHandles) {
+    pool.configure(0, std::chrono::seconds(60));
+
+    SingleDataHandle datahandle = pool.checkout(SAMPLES_10, CREDENTIALS);
+    EXPECT_EQ(pool.size(), 0);
+
+    expect_slice(datahandle);
+    datahandle.close();
+}
+
+TEST_F(DataHandlePoolTest, FailedOpenIsNotPooled) {
+    EXPECT_THROW(
+        pool.checkout("file://does_not_exist.vds", CREDENTIALS),
+        std::runtime_error
+    );
+    EXPECT_EQ(pool.size(), 0);
+}
+
+} // namespace
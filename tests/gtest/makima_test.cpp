@@ -0,0 +1,126 @@
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/math/interpolators/makima.hpp>
+
+#include "makima.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+using boost::math::interpolators::makima;
+
+/* Interpolation of src with boost, positions in units of source samples */
+std::vector< double > boost_interpolate(
+    std::vector< float > const& src,
+    double first,
+    double step,
+    std::size_t m
+) {
+    std::vector< double > x;
+    for (std::size_t i = 0; i < src.size(); ++i) x.push_back(i);
+    std::vector< double > y(src.begin(), src.end());
+    auto spline = makima< std::vector< double > >(std::move(x), std::move(y));
+
+    std::vector< double > result;
+    for (std::size_t j = 0; j < m; ++j) {
+        result.push_back(spline(first + j * step));
+    }
+    return result;
+}
+
+void expect_matches_boost(
+    std::vector< float > const& src,
+    double first,
+    double step,
+    std::size_t m
+) {
+    std::vector< double > const expected = boost_interpolate(src, first, step, m);
+
+    Makima makima;
+    std::vector< double > result(m);
+    makima.interpolate(src.data(), src.size(), first, step, result.data(), m);
+
+    for (std::size_t j = 0; j < m; ++j) {
+        EXPECT_NEAR(expected[j], result[j], 1e-9 * std::max(1.0, std::abs(expected[j])))
+            << "at position " << first + j * step;
+    }
+}
+
+TEST(MakimaTest, MatchesBoost) {
+    std::mt19937 rng(42);
+    std::normal_distribution< float > distribution(0, 100);
+
+    for (std::size_t n : { 4, 5, 6, 7, 13, 100 }) {
+        std::vector< float > src(n);
+        for (auto& y : src) y = distribution(rng);
+
+        /* Every sample, upsampling and downsampling, on and between samples */
+        expect_matches_boost(src, 0, 1, n);
+        expect_matches_boost(src, 0, 0.1, 10 * (n - 1) + 1);
+        expect_matches_boost(src, 0.3, 0.7, (n - 1.3) / 0.7);
+        expect_matches_boost(src, 1, 2, (n - 1) / 2);
+    }
+}
+
+TEST(MakimaTest, FlatData) {
+    /* Equal neighbouring samples give the flat sections the weights exist for */
+    std::vector< float > const src = { 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 5, 5 };
+    expect_matches_boost(src, 0, 0.25, 45);
+}
+
+TEST(MakimaTest, ScratchSpaceIsReused) {
+    std::vector< float > const longer  = { 4, 1, -3, 2, 0, 7, 7, 1 };
+    std::vector< float > const shorter = { 2, 5, 1, 3, 4 };
+
+    Makima makima;
+    std::vector< double > result(8);
+    makima.interpolate(longer.data(), longer.size(), 0, 1, result.data(), 8);
+
+    std::vector< double > const expected = boost_interpolate(shorter, 0.5, 0.5, 8);
+    makima.interpolate(shorter.data(), shorter.size(), 0.5, 0.5, result.data(), 8);
+    for (std::size_t j = 0; j < expected.size(); ++j) {
+        EXPECT_NEAR(expected[j], result[j], 1e-9);
+    }
+}
+
+TEST(MakimaTest, EndsAreExact) {
+    std::vector< float > const src = { 4, 1, -3, 2, 0.5 };
+    std::vector< double > result(2);
+
+    Makima makima;
+    makima.interpolate(src.data(), src.size(), 0, 4, result.data(), 2);
+    EXPECT_THAT(result, ::testing::ElementsAre(4, 0.5));
+}
+
+TEST(MakimaTest, TooFewSamples) {
+    std::vector< float > const src = { 1, 2, 3 };
+    double result;
+
+    Makima makima;
+    EXPECT_THROW(
+        makima.interpolate(src.data(), src.size(), 0, 1, &result, 1),
+        std::domain_error
+    );
+}
+
+TEST(MakimaTest, OutsideOfSegment) {
+    std::vector< float > const src = { 1, 2, 3, 4 };
+    std::vector< double > result(4);
+
+    Makima makima;
+    EXPECT_THROW(
+        makima.interpolate(src.data(), src.size(), -0.5, 1, result.data(), 4),
+        std::domain_error
+    );
+    EXPECT_THROW(
+        makima.interpolate(src.data(), src.size(), 0.5, 1, result.data(), 4),
+        std::domain_error
+    );
+}
+
+} // namespace
@@ -168,4 +168,44 @@ TEST(RegularSurfaceSubscriptTest, DoubleVersusReference) {
     }
 }
 
+TEST(RegularSurfaceShiftTest, ShiftedValues) {
+    std::array<float, nrows *ncols> surface_data = {2, fill, 5, 7, fill, 13};
+    RegularSurface const surface =
+        RegularSurface(surface_data.data(), nrows, ncols, samples_10_grid, fill);
+
+    RegularSurface const above = surface.shifted(-1.5);
+    RegularSurface const below = surface.shifted(4).shifted(0.25);
+
+    EXPECT_EQ(above.grid(), surface.grid());
+    EXPECT_EQ(above.fillvalue(), surface.fillvalue());
+
+    for (std::size_t i = 0; i < surface_data.size(); i++) {
+        if (surface_data[i] == fill) {
+            EXPECT_EQ(above[i], fill) << "Fill value shifted at " << i;
+            EXPECT_EQ(below[i], fill) << "Fill value shifted at " << i;
+            continue;
+        }
+        EXPECT_EQ(above[i], surface_data[i] - 1.5f) << "Unexpected value";
+        EXPECT_EQ(below[i], surface_data[i] + 4.25f) << "Unexpected value";
+    }
+    EXPECT_EQ(below[as_pair(2, 1)], 17.25f) << "Unexpected value";
+
+    /* Shifted surfaces are views of the data of the surface */
+    surface_data[0] = 3;
+    EXPECT_EQ(above[0], 1.5f) << "Unexpected value after update";
+}
+
+TEST(RegularSurfaceShiftTest, ShiftedSurfaceIsReadOnly) {
+    RegularSurface const surface =
+        RegularSurface(ref_surface_data.data(), nrows, ncols, samples_10_grid, fill);
+    RegularSurface shifted = surface.shifted(1);
+
+    EXPECT_THAT([&]() { shifted[0] = 1; },
+                testing::ThrowsMessage<std::runtime_error>(
+                    testing::HasSubstr("shifted surface is read-only")));
+    EXPECT_THAT([&]() { shifted[as_pair(0, 0)] = 1; },
+                testing::ThrowsMessage<std::runtime_error>(
+                    testing::HasSubstr("shifted surface is read-only")));
+}
+
 } // namespace
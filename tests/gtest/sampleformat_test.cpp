@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "sampleformat.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+const float NaN = std::numeric_limits< float >::quiet_NaN();
+const float INF = std::numeric_limits< float >::infinity();
+
+class SampleFormatTest : public ::testing::Test {
+protected:
+    /* Odd size, so that the vectorized kernels have to handle a tail */
+    static constexpr std::size_t size = 1000 + 13;
+
+    std::vector< float > samples;
+
+    void SetUp() override {
+        std::mt19937 gen(42);
+        std::uniform_real_distribution< float > distribution(-250, 750);
+
+        samples.resize(size);
+        for (auto& sample : samples) sample = distribution(gen);
+    }
+
+    std::vector< char > encode(
+        std::vector< float > const& src,
+        SampleEncoding* encoding,
+        bool vectorize = true
+    ) {
+        std::vector< char > dst(src.size() * sample_size(encoding->format));
+        encode_samples(src.data(), src.size(), encoding, dst.data(), vectorize);
+        return dst;
+    }
+
+    template< typename T >
+    T at(std::vector< char > const& buffer, std::size_t i) {
+        T value;
+        std::memcpy(&value, buffer.data() + i * sizeof(T), sizeof(T));
+        return value;
+    }
+};
+
+TEST_F(SampleFormatTest, Float32IsUnchanged) {
+    SampleEncoding encoding{ FLOAT32, 0, 0 };
+    auto const encoded = encode(samples, &encoding);
+
+    ASSERT_EQ(encoded.size(), samples.size() * sizeof(float));
+    EXPECT_EQ(std::memcmp(encoded.data(), samples.data(), encoded.size()), 0);
+}
+
+TEST_F(SampleFormatTest, Float16KnownValues) {
+    std::vector< float > values = {
+        0.0f, -0.0f, 1.0f, -2.0f, 0.5f, 65504.0f, 1e6f, -INF, NaN,
+        /* Rounds to even, 1 + 2^-11 is halfway between 1 and 1 + 2^-10 */
+        1.00048828125f,
+        /* Smallest subnormal half */
+        5.9604645e-8f,
+    };
+    std::vector< std::uint16_t > expected = {
+        0x0000, 0x8000, 0x3C00, 0xC000, 0x3800, 0x7BFF, 0x7C00, 0xFC00, 0x7E00,
+        0x3C00,
+        0x0001,
+    };
+
+    for (bool vectorize : { false, true }) {
+        SampleEncoding encoding{ FLOAT16, 0, 0 };
+        auto const encoded = encode(values, &encoding, vectorize);
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            EXPECT_EQ(at< std::uint16_t >(encoded, i), expected[i])
+                << "at " << i << ", vectorize " << vectorize;
+        }
+    }
+}
+
+TEST_F(SampleFormatTest, VectorizedMatchesScalar) {
+    samples[3]   = NaN;
+    samples[17]  = INF;
+    samples[500] = -INF;
+
+    for (auto format : { FLOAT16, INT16, INT8 }) {
+        SampleEncoding scalar{ format, 0, 0 };
+        SampleEncoding vector{ format, 0, 0 };
+        EXPECT_EQ(encode(samples, &scalar, false), encode(samples, &vector, true))
+            << "format " << format;
+        EXPECT_EQ(scalar.scale,  vector.scale);
+        EXPECT_EQ(scalar.offset, vector.offset);
+    }
+}
+
+TEST_F(SampleFormatTest, ScaledIntegersRoundTrip) {
+    auto check = [&](auto type, enum sample_format format) {
+        using T = decltype(type);
+        SampleEncoding encoding{ format, 0, 0 };
+        auto const encoded = encode(samples, &encoding);
+
+        for (std::size_t i = 0; i < samples.size(); ++i) {
+            float const decoded =
+                encoding.offset + encoding.scale * at< T >(encoded, i);
+            EXPECT_NEAR(decoded, samples[i], encoding.scale * 0.51)
+                << "at " << i << ", format " << format;
+        }
+
+        /* The full range of the type is used */
+        auto const minmax = std::minmax_element(samples.begin(), samples.end());
+        std::size_t const lowest  = minmax.first  - samples.begin();
+        std::size_t const highest = minmax.second - samples.begin();
+        EXPECT_EQ(at< T >(encoded, lowest),  -std::numeric_limits< T >::max());
+        EXPECT_EQ(at< T >(encoded, highest),  std::numeric_limits< T >::max());
+    };
+
+    check(std::int16_t(), INT16);
+    check(std::int8_t(),  INT8);
+}
+
+TEST_F(SampleFormatTest, ScaledIntegersNoValue) {
+    std::vector< float > values = { 1, NaN, 3, INF, -INF, 2 };
+
+    SampleEncoding encoding{ INT16, 0, 0 };
+    auto const encoded = encode(values, &encoding);
+
+    EXPECT_FLOAT_EQ(encoding.offset, 2);
+    EXPECT_EQ(at< std::int16_t >(encoded, 0), -32767);
+    EXPECT_EQ(at< std::int16_t >(encoded, 1), -32768);
+    EXPECT_EQ(at< std::int16_t >(encoded, 2),  32767);
+    EXPECT_EQ(at< std::int16_t >(encoded, 3), -32768);
+    EXPECT_EQ(at< std::int16_t >(encoded, 4), -32768);
+    EXPECT_EQ(at< std::int16_t >(encoded, 5),  0);
+}
+
+TEST_F(SampleFormatTest, ScaledIntegersConstantData) {
+    std::vector< float > values(20, 4.5f);
+
+    SampleEncoding encoding{ INT8, 0, 0 };
+    auto const encoded = encode(values, &encoding);
+
+    EXPECT_EQ(encoding.scale,  1);
+    EXPECT_EQ(encoding.offset, 4.5f);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        EXPECT_EQ(at< std::int8_t >(encoded, i), 0);
+    }
+}
+
+TEST_F(SampleFormatTest, ScaledIntegersFullFloatRange) {
+    float const max = std::numeric_limits< float >::max();
+    std::vector< float > values = { -max, -1, 0, 1, max };
+
+    auto check = [&](auto type, enum sample_format format) {
+        using T = decltype(type);
+        for (bool vectorize : { false, true }) {
+            SampleEncoding encoding{ format, 0, 0 };
+            auto const encoded = encode(values, &encoding, vectorize);
+
+            EXPECT_EQ(encoding.offset, 0);
+            EXPECT_TRUE(std::isfinite(encoding.scale));
+            EXPECT_GT(encoding.scale, 0);
+
+            T const top = std::numeric_limits< T >::max();
+            std::vector< T > const expected = { T(-top), 0, 0, 0, top };
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                EXPECT_EQ(at< T >(encoded, i), expected[i])
+                    << "at " << i << ", format " << format
+                    << ", vectorize " << vectorize;
+            }
+        }
+    };
+
+    check(std::int16_t(), INT16);
+    check(std::int8_t(),  INT8);
+}
+
+TEST_F(SampleFormatTest, InPlace) {
+    for (auto format : { FLOAT16, INT16, INT8 }) {
+        SampleEncoding expected_encoding{ format, 0, 0 };
+        auto const expected = encode(samples, &expected_encoding);
+
+        std::vector< float > buffer = samples;
+        SampleEncoding encoding{ format, 0, 0 };
+        char* dst = reinterpret_cast< char* >(buffer.data());
+        encode_samples(buffer.data(), buffer.size(), &encoding, dst);
+
+        EXPECT_EQ(std::memcmp(dst, expected.data(), expected.size()), 0)
+            << "format " << format;
+    }
+}
+
+} // namespace
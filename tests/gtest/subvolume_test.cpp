@@ -333,4 +333,54 @@ TEST(SegmentBlueprintTest, NegativeAxis) {
     EXPECT_EQ(6, resampled.size(reference, top_boundary, bottom_boundary));
 }
 
+/*
+ * 0 2   6   10  14  18  22  26  30  34
+ * --*---*---*---*---*---*---*---*---*---
+ *           |       |       |
+ *          top  reference bottom
+ */
+TEST(ResampleTest, SamplesOnTheSourceGridAreCopied) {
+    RawSegmentBlueprint raw = RawSegmentBlueprint(4, 2);
+    ResampledSegmentBlueprint resampled = ResampledSegmentBlueprint(4);
+    std::uint8_t margin = raw.preferred_margin();
+
+    std::vector< float > const data = { 3, -1, 4, 1, -5, 9, 2, -6, 5 };
+    RawSegment src(18, 10, 26, margin, data.begin(), data.end(), &raw);
+    ResampledSegment dst(18, 10, 26, &resampled);
+
+    resample(src, dst);
+    EXPECT_THAT(
+        std::vector< double >(dst.begin(), dst.end()),
+        ::testing::ElementsAre(4, 1, -5, 9, 2)
+    );
+}
+
+TEST(ResampleTest, SamplesOffTheSourceGridAreInterpolated) {
+    RawSegmentBlueprint raw = RawSegmentBlueprint(4, 2);
+    std::uint8_t margin = raw.preferred_margin();
+
+    /* Linear data, which makima reproduces, with the positions as values */
+    std::vector< float > const data = { 2, 6, 10, 14, 18, 22, 26, 30, 34 };
+    RawSegment src(18, 10, 26, margin, data.begin(), data.end(), &raw);
+
+    ResampledSegmentBlueprint unaligned = ResampledSegmentBlueprint(4);
+    ResampledSegment shifted(19, 10, 26, &unaligned);
+    resample(src, shifted);
+    EXPECT_THAT(
+        std::vector< double >(shifted.begin(), shifted.end()),
+        ::testing::Pointwise(::testing::DoubleNear(1e-9), { 11.0, 15.0, 19.0, 23.0 })
+    );
+
+    ResampledSegmentBlueprint finer = ResampledSegmentBlueprint(2);
+    ResampledSegment supersampled(18, 10, 26, &finer);
+    resample(src, supersampled);
+    EXPECT_THAT(
+        std::vector< double >(supersampled.begin(), supersampled.end()),
+        ::testing::Pointwise(
+            ::testing::DoubleNear(1e-9),
+            { 10.0, 12.0, 14.0, 16.0, 18.0, 20.0, 22.0, 24.0, 26.0 }
+        )
+    );
+}
+
 } // namespace
@@ -0,0 +1,89 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "threadpool.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(ThreadPoolTest, RunsEveryTaskOnce) {
+    ThreadPool pool(4);
+
+    std::vector< std::atomic< int > > runs(1000);
+    pool.parallel_for(runs.size(), [&](std::size_t i) {
+        ++runs[i];
+        /* Uneven tasks, so that workers have to steal */
+        if (i % 97 == 0) std::this_thread::sleep_for(std::chrono::microseconds(100));
+    });
+
+    for (std::size_t i = 0; i < runs.size(); ++i) {
+        EXPECT_EQ(runs[i], 1) << "task " << i;
+    }
+}
+
+TEST(ThreadPoolTest, NoTasks) {
+    ThreadPool pool(2);
+    bool called = false;
+    pool.parallel_for(0, [&](std::size_t) { called = true; });
+    EXPECT_FALSE(called);
+}
+
+TEST(ThreadPoolTest, NestedAndConcurrentCalls) {
+    ThreadPool pool(2);
+
+    std::atomic< int > count{ 0 };
+    std::vector< std::thread > callers;
+    for (int i = 0; i < 4; ++i) {
+        callers.emplace_back([&] {
+            pool.parallel_for(10, [&](std::size_t) {
+                pool.parallel_for(5, [&](std::size_t) { ++count; });
+            });
+        });
+    }
+    for (auto& caller : callers) caller.join();
+
+    EXPECT_EQ(count, 4 * 10 * 5);
+}
+
+TEST(ThreadPoolTest, RethrowsAfterAllTasksComplete) {
+    ThreadPool pool(4);
+
+    std::atomic< int > count{ 0 };
+    EXPECT_THROW(
+        pool.parallel_for(100, [&](std::size_t i) {
+            ++count;
+            if (i == 3) throw std::runtime_error("task failed");
+        }),
+        std::runtime_error
+    );
+    EXPECT_EQ(count, 100);
+}
+
+TEST(ThreadPoolTest, SubmittedTasksCompleteWithoutWaiting) {
+    ThreadPool pool(2);
+
+    std::atomic< int > count{ 0 };
+    std::vector< std::future< void > > results;
+    for (int i = 0; i < 20; ++i) {
+        results.push_back(pool.submit([&] { ++count; }));
+    }
+    for (auto& result : results) result.get();
+    EXPECT_EQ(count, 20);
+
+    auto failed = pool.submit([] { throw std::runtime_error("task failed"); });
+    EXPECT_THROW(failed.get(), std::runtime_error);
+}
+
+TEST(ThreadPoolTest, AvailableCpus) {
+    std::size_t const cpus = available_cpus();
+    EXPECT_GE(cpus, 1);
+    EXPECT_LE(cpus, std::max(1u, std::thread::hardware_concurrency()));
+}
+
+} // namespace